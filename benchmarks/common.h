@@ -0,0 +1,115 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _4e1b8a2c_7d3f_4c6e_9a51_0f2d6b8e3c71
+#define _4e1b8a2c_7d3f_4c6e_9a51_0f2d6b8e3c71
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <odil/Element.h>
+#include <odil/ElementsDictionary.h>
+#include <odil/Exception.h>
+#include <odil/registry.h>
+#include <odil/Tag.h>
+#include <odil/VR.h>
+
+/*
+ * Helpers shared by the benchmarks.
+ */
+
+typedef std::vector<std::pair<odil::Tag, odil::Element>> Elements;
+
+/// @brief Elements of the usual header modules, in ascending tag order.
+inline Elements get_header()
+{
+    Elements elements;
+    for(auto const & entry: odil::registry::public_dictionary)
+    {
+        if(entry.first.get_type() != odil::ElementsDictionaryKey::Type::Tag)
+        {
+            continue;
+        }
+        auto const & tag = entry.first.get_tag();
+        auto const & vr_name = entry.second.vr;
+        if(
+            (tag.group != 0x0008 && tag.group != 0x0010 && tag.group != 0x0018
+                && tag.group != 0x0020 && tag.group != 0x0028)
+            || tag.element == 0 || vr_name.size() != 2 || vr_name == "SQ")
+        {
+            continue;
+        }
+
+        odil::VR vr;
+        try
+        {
+            vr = odil::as_vr(vr_name);
+        }
+        catch(odil::Exception const &)
+        {
+            // VR not known by this version
+            continue;
+        }
+
+        odil::Element element(vr);
+        if(element.is_int())
+        {
+            element.as_int().push_back(1);
+        }
+        else if(element.is_real())
+        {
+            element.as_real().push_back(1.5);
+        }
+        else if(element.is_string())
+        {
+            element.as_string().push_back(
+                (vr == odil::VR::AT)?"00100010":"value");
+        }
+        else if(element.is_binary())
+        {
+            element.as_binary().push_back({0x01, 0x02});
+        }
+        elements.emplace_back(tag, element);
+    }
+
+    // Keep the size of a typical header.
+    Elements header;
+    auto const step = std::max<std::size_t>(1, elements.size()/200);
+    for(std::size_t i=0; i<elements.size(); i+=step)
+    {
+        header.push_back(elements[i]);
+    }
+    return header;
+}
+
+template<typename TFunction>
+void run(
+    std::string const & name, std::size_t operations, TFunction function,
+    unsigned int repetitions=1000)
+{
+    auto const begin = std::chrono::steady_clock::now();
+    for(unsigned int i=0; i<repetitions; ++i)
+    {
+        function();
+    }
+    auto const end = std::chrono::steady_clock::now();
+
+    auto const duration = std::chrono::duration<double, std::nano>(end-begin);
+    std::cout
+        << std::setw(40) << std::left << name << " "
+        << std::setw(10) << std::right << std::fixed << std::setprecision(1)
+        << duration.count()/(repetitions*operations) << " ns/op\n";
+}
+
+#endif // _4e1b8a2c_7d3f_4c6e_9a51_0f2d6b8e3c71
@@ -0,0 +1,115 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+/*
+ * Write and read the contours of an RT Structure Set: contour data (DS) of
+ * planar contours on 3 mm slices, with coordinates rounded to 0.01 mm as
+ * exported by most treatment planning systems.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <odil/DataSet.h>
+#include <odil/Reader.h>
+#include <odil/registry.h>
+#include <odil/Value.h>
+#include <odil/Writer.h>
+
+#include "common.h"
+
+/// @brief Build an RT Structure Set with the given number of ROIs.
+std::shared_ptr<odil::DataSet> get_structure_set(
+    unsigned int rois_count, unsigned int contours_count,
+    unsigned int points_count, std::size_t & values_count)
+{
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> noise(-1.5, 1.5);
+
+    values_count = 0;
+
+    auto structure_set = std::make_shared<odil::DataSet>();
+    structure_set->add(
+        odil::registry::SOPClassUID,
+        {odil::registry::RTStructureSetStorage});
+
+    odil::Value::DataSets roi_contours;
+    for(unsigned int roi=0; roi<rois_count; ++roi)
+    {
+        odil::Value::DataSets contours;
+        for(unsigned int contour=0; contour<contours_count; ++contour)
+        {
+            double const z = -150.+3.*contour;
+            double const radius = 20.+2.*roi;
+            odil::Value::Reals data;
+            data.reserve(3*points_count);
+            for(unsigned int point=0; point<points_count; ++point)
+            {
+                double const angle = 2.*M_PI*point/points_count;
+                double const r = radius+noise(generator);
+                data.push_back(std::round(100.*r*std::cos(angle))/100.);
+                data.push_back(std::round(100.*r*std::sin(angle))/100.);
+                data.push_back(z);
+            }
+            values_count += data.size();
+
+            auto item = std::make_shared<odil::DataSet>();
+            item->add(odil::registry::ContourGeometricType, {"CLOSED_PLANAR"});
+            item->add(
+                odil::registry::NumberOfContourPoints,
+                {odil::Value::Integer(points_count)});
+            item->add(odil::registry::ContourData, data);
+            contours.push_back(item);
+        }
+
+        auto item = std::make_shared<odil::DataSet>();
+        item->add(
+            odil::registry::ReferencedROINumber, {odil::Value::Integer(roi+1)});
+        item->add(odil::registry::ContourSequence, contours);
+        roi_contours.push_back(item);
+    }
+    structure_set->add(odil::registry::ROIContourSequence, roi_contours);
+
+    return structure_set;
+}
+
+int main()
+{
+    std::size_t values_count = 0;
+    auto const structure_set = get_structure_set(10, 50, 200, values_count);
+
+    std::ostringstream output;
+    odil::Writer(output, odil::registry::ExplicitVRLittleEndian)
+        .write_data_set(structure_set);
+    auto const data = output.str();
+
+    std::cout
+        << values_count << " DS values, " << data.size() << " bytes\n";
+
+    std::size_t sink = 0;
+
+    run("Write", values_count, [&]() {
+        std::ostringstream stream;
+        odil::Writer(stream, odil::registry::ExplicitVRLittleEndian)
+            .write_data_set(structure_set);
+        sink += stream.tellp();
+    }, 10);
+
+    run("Read", values_count, [&]() {
+        std::istringstream stream(data);
+        odil::Reader reader(stream, odil::registry::ExplicitVRLittleEndian);
+        sink += reader.read_data_set()->size();
+    }, 10);
+
+    return (sink == 0)?1:0;
+}
@@ -0,0 +1,115 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+/*
+ * Compare the element storage of odil::DataSet with a std::map<Tag, Element>
+ * on a header-sized data set: building (in ascending and random tag order),
+ * lookups and iteration.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <odil/DataSet.h>
+#include <odil/Element.h>
+#include <odil/Tag.h>
+#include <odil/VR.h>
+
+#include "common.h"
+
+int main()
+{
+    auto const header = get_header();
+    auto shuffled = header;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(0));
+
+    std::vector<odil::Tag> lookups;
+    for(auto const & item: shuffled)
+    {
+        lookups.push_back(item.first);
+    }
+
+    std::cout << header.size() << " elements\n";
+
+    // Keep the results alive so that the compiler does not remove the loops.
+    std::size_t sink = 0;
+
+    run("DataSet: build (ascending)", header.size(), [&]() {
+        odil::DataSet data_set;
+        for(auto const & item: header)
+        {
+            data_set.add(item.first, item.second);
+        }
+        sink += data_set.size();
+    });
+    run("std::map: build (ascending)", header.size(), [&]() {
+        std::map<odil::Tag, odil::Element> map;
+        for(auto const & item: header)
+        {
+            map.insert(item);
+        }
+        sink += map.size();
+    });
+
+    run("DataSet: build (random)", header.size(), [&]() {
+        odil::DataSet data_set;
+        for(auto const & item: shuffled)
+        {
+            data_set.add(item.first, item.second);
+        }
+        sink += data_set.size();
+    });
+    run("std::map: build (random)", header.size(), [&]() {
+        std::map<odil::Tag, odil::Element> map;
+        for(auto const & item: shuffled)
+        {
+            map.insert(item);
+        }
+        sink += map.size();
+    });
+
+    odil::DataSet data_set;
+    std::map<odil::Tag, odil::Element> map;
+    for(auto const & item: header)
+    {
+        data_set.add(item.first, item.second);
+        map.insert(item);
+    }
+
+    run("DataSet: lookup", lookups.size(), [&]() {
+        for(auto const & tag: lookups)
+        {
+            sink += data_set[tag].vr == odil::VR::CS;
+        }
+    });
+    run("std::map: lookup", lookups.size(), [&]() {
+        for(auto const & tag: lookups)
+        {
+            sink += map.find(tag)->second.vr == odil::VR::CS;
+        }
+    });
+
+    run("DataSet: iteration", data_set.size(), [&]() {
+        for(auto const & item: data_set)
+        {
+            sink += item.first.element;
+        }
+    });
+    run("std::map: iteration", map.size(), [&]() {
+        for(auto const & item: map)
+        {
+            sink += item.first.element;
+        }
+    });
+
+    return (sink == 0)?1:0;
+}
@@ -0,0 +1,71 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+/*
+ * Parse a header-sized data set, eagerly and lazily, from an in-memory
+ * stream (the backend of memory-mapped files) and from a std::istringstream.
+ */
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <odil/DataSet.h>
+#include <odil/Reader.h>
+#include <odil/registry.h>
+#include <odil/StringStream.h>
+#include <odil/Writer.h>
+
+#include "common.h"
+
+int main()
+{
+    auto const header = get_header();
+    auto data_set = std::make_shared<odil::DataSet>();
+    for(auto const & item: header)
+    {
+        data_set->add(item.first, item.second);
+    }
+
+    std::cout << header.size() << " elements\n";
+
+    std::size_t sink = 0;
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::ImplicitVRLittleEndian})
+    {
+        std::ostringstream output;
+        odil::Writer(output, transfer_syntax).write_data_set(data_set);
+        auto const data = output.str();
+
+        auto const name =
+            std::string(
+                transfer_syntax == odil::registry::ExplicitVRLittleEndian
+                ? "explicit" : "implicit");
+
+        for(auto const lazy: {false, true})
+        {
+            auto const suffix =
+                " ("+name+std::string(lazy?", lazy":"")+")";
+            run("IStringStream"+suffix, header.size(), [&]() {
+                odil::IStringStream stream(&data[0], data.size());
+                odil::Reader reader(stream, transfer_syntax, false, lazy);
+                sink += reader.read_data_set()->size();
+            });
+            run("std::istringstream"+suffix, header.size(), [&]() {
+                std::istringstream stream(data);
+                odil::Reader reader(stream, transfer_syntax, false, lazy);
+                sink += reader.read_data_set()->size();
+            });
+        }
+    }
+
+    return (sink == 0)?1:0;
+}
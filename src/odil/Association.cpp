@@ -9,13 +9,24 @@
 #include "Association.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <istream>
 #include <map>
+#include <memory>
+#include <ostream>
+#include <streambuf>
 #include <string>
 #include <vector>
 
+#include <boost/asio.hpp>
+
 #include "odil/AssociationParameters.h"
 #include "odil/DataSet.h"
+#include "odil/endian.h"
 #include "odil/Exception.h"
 #include "odil/uid.h"
 #include "odil/dul/StateMachine.h"
@@ -34,12 +45,555 @@
 #include "odil/pdu/UserIdentityRQ.h"
 #include "odil/pdu/UserInformation.h"
 #include "odil/Reader.h"
+#include "odil/SegmentStream.h"
 #include "odil/StringStream.h"
 #include "odil/Writer.h"
 
+namespace
+{
+
+/// @brief Sequential access to the content of segments.
+class SegmentsReader
+{
+public:
+    SegmentsReader(std::vector<odil::SegmentStream::Segment> const & segments)
+    : _segments(segments), _index(0), _offset(0)
+    {
+        // Nothing else.
+    }
+
+    /// @brief Append buffers referencing the next bytes of the content.
+    void read(
+        std::size_t size, std::vector<boost::asio::const_buffer> & buffers)
+    {
+        while(size > 0)
+        {
+            if(this->_index == this->_segments.size())
+            {
+                throw odil::Exception("Not enough data in segments");
+            }
+            auto const & segment = this->_segments[this->_index];
+            auto const count = std::min(size, segment.size-this->_offset);
+            buffers.emplace_back(segment.data+this->_offset, count);
+            size -= count;
+            this->_offset += count;
+            if(this->_offset == segment.size)
+            {
+                ++this->_index;
+                this->_offset = 0;
+            }
+        }
+    }
+
+private:
+    std::vector<odil::SegmentStream::Segment> const & _segments;
+    std::size_t _index;
+    std::size_t _offset;
+};
+
+/**
+ * @brief Encoder of P-DATA-TF PDUs (PS 3.8, 9.3.5) whose fragments reference
+ * the content of segments.
+ */
+class PDataTFEncoder
+{
+public:
+    PDataTFEncoder(uint8_t presentation_context_id)
+    : _presentation_context_id(presentation_context_id)
+    {
+        this->clear();
+    }
+
+    /// @brief Start a new PDU.
+    void clear()
+    {
+        this->_headers.clear();
+        this->_buffers.clear();
+        this->_length = 0;
+
+        // PDU-type, reserved, PDU-length: set in get_buffers
+        this->_headers.emplace_back(6, '\0');
+        this->_buffers.emplace_back(boost::asio::buffer(this->_headers.back()));
+    }
+
+    /// @brief Add a PDV with the next bytes of the reader.
+    void add_pdv(
+        SegmentsReader & reader, std::size_t size, uint8_t control_header)
+    {
+        this->_headers.emplace_back(6, '\0');
+        auto & header = this->_headers.back();
+        this->_set_length(&header[0], 2+size);
+        header[4] = this->_presentation_context_id;
+        header[5] = control_header;
+        this->_buffers.emplace_back(boost::asio::buffer(header));
+
+        reader.read(size, this->_buffers);
+
+        this->_length += 6+size;
+    }
+
+    /// @brief Return the length of the PDVs of the current PDU.
+    std::size_t get_length() const
+    {
+        return this->_length;
+    }
+
+    /// @brief Return the buffers of the encoded PDU.
+    std::vector<boost::asio::const_buffer> const & get_buffers()
+    {
+        auto & header = this->_headers.front();
+        header[0] = 0x04;
+        header[1] = 0;
+        this->_set_length(&header[2], this->_length);
+        return this->_buffers;
+    }
+
+private:
+    uint8_t _presentation_context_id;
+    std::deque<std::string> _headers;
+    std::vector<boost::asio::const_buffer> _buffers;
+    std::size_t _length;
+
+    void _set_length(char * destination, std::size_t length) const
+    {
+        uint32_t const value = odil::host_to_big_endian(uint32_t(length));
+        std::memcpy(destination, &value, sizeof(value));
+    }
+};
+
+/**
+ * @brief Sender of the P-DATA-TF PDUs of a message: the command set is sent
+ * with the first fragment of the data set if possible, and the data set is
+ * sent as it is encoded.
+ *
+ * With a write handler, the PDUs are queued on an asynchronous transport
+ * without being copied: the sender and the segments must then be valid until
+ * they are written.
+ */
+class PDataTFSender
+{
+public:
+    PDataTFSender(
+        odil::dul::StateMachine & state_machine,
+        uint8_t presentation_context_id, std::size_t maximum_length,
+        odil::dul::Transport::Handler const & write_handler=
+            odil::dul::Transport::Handler())
+    : _state_machine(state_machine),
+        _presentation_context_id(presentation_context_id),
+        _maximum_length(maximum_length), _write_handler(write_handler)
+    {
+        this->_encoders.emplace_back(presentation_context_id);
+    }
+
+    /// @brief Add the command set to the first PDU.
+    void add_command(odil::SegmentStream & stream)
+    {
+        SegmentsReader reader(stream.get_segments());
+        this->_encoders.back().add_pdv(reader, stream.size(), 3);
+    }
+
+    /**
+     * @brief Send the data set content in full PDUs. Unless this is the end
+     * of the data set, the last fragment is kept since it may not be full.
+     * Return the number of bytes sent.
+     *
+     * The write handler of the last PDU, if not empty, replaces the one of
+     * the sender, cf. flush.
+     */
+    std::size_t send_data(
+        std::vector<odil::SegmentStream::Segment> const & segments, bool last,
+        odil::dul::Transport::Handler const & last_write_handler=
+            odil::dul::Transport::Handler())
+    {
+        std::size_t size = 0;
+        for(auto const & segment: segments)
+        {
+            size += segment.size;
+        }
+
+        SegmentsReader reader(segments);
+        std::size_t sent = 0;
+        while(true)
+        {
+            auto & encoder = this->_encoders.back();
+            auto const remaining = size-sent;
+            // In case some software do not take into account the size of the
+            // header when allocating their buffer
+            int64_t const available =
+                int64_t(this->_maximum_length) - 6
+                - (
+                    encoder.get_length() > 0
+                    ? int64_t(encoder.get_length()+6) : 0);
+            if(!this->_maximum_length || int64_t(remaining) <= available)
+            {
+                if(last)
+                {
+                    encoder.add_pdv(reader, remaining, 2);
+                    sent += remaining;
+                    this->flush(last_write_handler);
+                }
+                break;
+            }
+            else if(available > 0)
+            {
+                encoder.add_pdv(reader, available, 0);
+                sent += available;
+            }
+            this->flush();
+        }
+
+        return sent;
+    }
+
+    /**
+     * @brief Release the write handler of the sender once no PDU is left to
+     * send: the queued PDUs keep a copy of it.
+     */
+    void release_write_handler()
+    {
+        this->_write_handler = odil::dul::Transport::Handler();
+    }
+
+    /**
+     * @brief Send the current PDU, if any, calling write_handler instead of
+     * the handler of the sender once it is written if not empty.
+     */
+    void flush(
+        odil::dul::Transport::Handler const & write_handler=
+            odil::dul::Transport::Handler())
+    {
+        auto & encoder = this->_encoders.back();
+        if(encoder.get_length() == 0)
+        {
+            return;
+        }
+
+        odil::dul::EventData data;
+        data.encoded_pdu = encoder.get_buffers();
+        data.write_handler =
+            write_handler ? write_handler : this->_write_handler;
+        this->_state_machine.send_pdu(data);
+
+        if(this->_write_handler)
+        {
+            // The headers of the PDU are written later: keep them.
+            this->_encoders.emplace_back(this->_presentation_context_id);
+        }
+        else
+        {
+            encoder.clear();
+        }
+    }
+
+private:
+    odil::dul::StateMachine & _state_machine;
+    uint8_t _presentation_context_id;
+    std::size_t _maximum_length;
+    odil::dul::Transport::Handler _write_handler;
+    std::deque<PDataTFEncoder> _encoders;
+};
+
+/// @brief State of an asynchronous emission of a message.
+struct MessageEmission
+{
+    std::shared_ptr<odil::message::Message const> message;
+    odil::SegmentStream command_stream;
+    odil::SegmentStream data_stream;
+    std::shared_ptr<PDataTFSender> sender;
+};
+
+/// @brief Return the exception reporting an error of asynchronous I/O.
+std::exception_ptr get_exception(boost::system::error_code const & error)
+{
+    if(!error)
+    {
+        return nullptr;
+    }
+    else if(error == boost::asio::error::timed_out)
+    {
+        return std::make_exception_ptr(odil::Exception("TCP time out"));
+    }
+    else
+    {
+        return std::make_exception_ptr(
+            odil::Exception("Operation error: "+error.message()));
+    }
+}
+
+/**
+ * @brief Stream buffer over the data set fragments of a message, receiving
+ * the P-DATA-TF PDUs on demand. The get area is the current fragment, in
+ * the receive buffer of the state machine.
+ *
+ * Short backward seeks, as used by Reader when halting, are supported
+ * across fragments by keeping the last bytes of the previous fragments.
+ */
+class DataSetBuffer: public std::streambuf
+{
+public:
+    typedef odil::pdu::PDataTF::PresentationDataValueView PDV;
+
+    DataSetBuffer(
+        std::function<void()> const & receive,
+        std::vector<PDV> const & pdv_items, std::size_t next)
+    : _receive(receive), _pdv_items(pdv_items), _next(next), _done(false),
+        _fragment_begin(nullptr), _fragment_end(nullptr),
+        _fragment_position(0), _history_size(0), _in_history(false)
+    {
+        this->setg(nullptr, nullptr, nullptr);
+    }
+
+    /// @brief Copy the remaining content to a stream.
+    void copy_to(std::ostream & stream)
+    {
+        while(!traits_type::eq_int_type(this->underflow(), traits_type::eof()))
+        {
+            stream.write(this->gptr(), this->egptr()-this->gptr());
+            if(!stream)
+            {
+                throw odil::Exception("Could not write to stream");
+            }
+            this->setg(this->eback(), this->egptr(), this->egptr());
+        }
+    }
+
+    /// @brief Skip the remaining content.
+    void skip()
+    {
+        while(!traits_type::eq_int_type(this->underflow(), traits_type::eof()))
+        {
+            this->setg(this->eback(), this->egptr(), this->egptr());
+        }
+    }
+
+protected:
+    int_type underflow() override
+    {
+        if(this->gptr() < this->egptr())
+        {
+            return traits_type::to_int_type(*this->gptr());
+        }
+
+        if(this->_in_history)
+        {
+            // Back to the current fragment
+            this->_in_history = false;
+            auto * begin = const_cast<char*>(this->_fragment_begin);
+            auto * end = const_cast<char*>(this->_fragment_end);
+            this->setg(begin, begin, end);
+            if(this->gptr() < this->egptr())
+            {
+                return traits_type::to_int_type(*this->gptr());
+            }
+        }
+
+        // The fragment is in the receive buffer, which is overwritten by the
+        // next PDU: keep its last bytes.
+        this->_save_history();
+        this->_fragment_position += this->_fragment_end-this->_fragment_begin;
+        this->_fragment_begin = this->_fragment_end = nullptr;
+        this->setg(nullptr, nullptr, nullptr);
+
+        while(this->_fragment_begin == this->_fragment_end)
+        {
+            if(this->_done)
+            {
+                return traits_type::eof();
+            }
+            if(this->_next == this->_pdv_items.size())
+            {
+                this->_receive();
+                this->_next = 0;
+            }
+
+            auto const & pdv = this->_pdv_items[this->_next];
+            ++this->_next;
+            if(pdv.is_command())
+            {
+                throw odil::Exception("Unexpected command fragment");
+            }
+            this->_done = pdv.is_last_fragment();
+            this->_fragment_begin = pdv.fragment;
+            this->_fragment_end = pdv.fragment+pdv.fragment_size;
+        }
+
+        auto * begin = const_cast<char*>(this->_fragment_begin);
+        auto * end = const_cast<char*>(this->_fragment_end);
+        this->setg(begin, begin, end);
+        return traits_type::to_int_type(*this->gptr());
+    }
+
+    pos_type seekoff(
+        off_type offset, std::ios::seekdir direction,
+        std::ios::openmode which) override
+    {
+        if(!(which & std::ios::in))
+        {
+            return pos_type(off_type(-1));
+        }
+
+        auto const history_position =
+            this->_fragment_position-off_type(this->_history_size);
+        off_type const current =
+            (this->_in_history?history_position:this->_fragment_position)
+            + (this->gptr()-this->eback());
+
+        off_type target;
+        if(direction == std::ios::cur)
+        {
+            target = current+offset;
+        }
+        else if(direction == std::ios::beg)
+        {
+            target = offset;
+        }
+        else
+        {
+            return pos_type(off_type(-1));
+        }
+
+        auto const fragment_size = this->_fragment_end-this->_fragment_begin;
+        if(
+            target >= this->_fragment_position
+            && target <= this->_fragment_position+fragment_size)
+        {
+            auto * begin = const_cast<char*>(this->_fragment_begin);
+            auto * end = const_cast<char*>(this->_fragment_end);
+            this->setg(
+                begin, begin+(target-this->_fragment_position), end);
+            this->_in_history = false;
+        }
+        else if(target >= history_position && target < this->_fragment_position)
+        {
+            this->setg(
+                this->_history, this->_history+(target-history_position),
+                this->_history+this->_history_size);
+            this->_in_history = true;
+        }
+        else
+        {
+            return pos_type(off_type(-1));
+        }
+
+        return pos_type(target);
+    }
+
+    pos_type seekpos(pos_type position, std::ios::openmode which) override
+    {
+        return this->seekoff(off_type(position), std::ios::beg, which);
+    }
+
+private:
+    static std::size_t const history_capacity = 16;
+
+    std::function<void()> _receive;
+    std::vector<PDV> const & _pdv_items;
+    std::size_t _next;
+    bool _done;
+
+    char const * _fragment_begin;
+    char const * _fragment_end;
+    off_type _fragment_position;
+
+    char _history[history_capacity];
+    std::size_t _history_size;
+    bool _in_history;
+
+    /// @brief Append the end of the current fragment to the history.
+    void _save_history()
+    {
+        std::size_t const size = this->_fragment_end-this->_fragment_begin;
+        if(size >= history_capacity)
+        {
+            std::memcpy(
+                this->_history, this->_fragment_end-history_capacity,
+                history_capacity);
+            this->_history_size = history_capacity;
+        }
+        else
+        {
+            auto const kept =
+                std::min(this->_history_size, history_capacity-size);
+            std::memmove(
+                this->_history, this->_history+this->_history_size-kept, kept);
+            std::memcpy(this->_history+kept, this->_fragment_begin, size);
+            this->_history_size = kept+size;
+        }
+    }
+};
+
+}
+
 namespace odil
 {
 
+/// @brief State of an asynchronous reception of a message.
+struct Association::MessageReception
+{
+    dul::EventData data;
+    uint8_t presentation_context_id;
+    std::string command_buffer;
+    std::shared_ptr<DataSet> command_set;
+    bool has_data_set;
+    std::string data_set_buffer;
+    bool complete;
+
+    MessageReception()
+    : presentation_context_id(0), has_data_set(false), complete(false)
+    {
+        // Nothing else.
+    }
+
+    /**
+     * @brief Copy the fragments of the received PDU, return whether the
+     * message is complete.
+     */
+    bool add_pdv_items()
+    {
+        for(auto const & pdv: this->data.pdv_items)
+        {
+            if(this->complete)
+            {
+                break;
+            }
+
+            if(!this->command_set)
+            {
+                if(!pdv.is_command())
+                {
+                    throw Exception(
+                        "Data set fragment received before command set");
+                }
+                this->presentation_context_id = pdv.presentation_context_id;
+                this->command_buffer.append(pdv.fragment, pdv.fragment_size);
+                if(pdv.is_last_fragment())
+                {
+                    IStringStream stream(
+                        &this->command_buffer[0], this->command_buffer.size());
+                    Reader reader(stream, registry::ImplicitVRLittleEndian);
+                    this->command_set = reader.read_data_set();
+                    this->has_data_set =
+                        this->command_set->as_int(
+                            registry::CommandDataSetType, 0)
+                        != message::Message::DataSetType::ABSENT;
+                    this->complete = !this->has_data_set;
+                }
+            }
+            else
+            {
+                if(pdv.is_command())
+                {
+                    throw Exception("Unexpected command fragment");
+                }
+                this->data_set_buffer.append(pdv.fragment, pdv.fragment_size);
+                this->complete = pdv.is_last_fragment();
+            }
+        }
+
+        return this->complete;
+    }
+};
+
 Association
 ::Association()
 : _state_machine(), _peer_host(""), _peer_port(104), _association_parameters(),
@@ -50,6 +604,16 @@ Association
     this->set_message_timeout(boost::posix_time::seconds(30));
 }
 
+Association
+::Association(boost::asio::io_service & service)
+: _state_machine(service), _peer_host(""), _peer_port(104),
+  _association_parameters(), _transfer_syntaxes_by_abstract_syntax(),
+  _transfer_syntaxes_by_id(), _next_message_id(1)
+{
+    this->set_tcp_timeout(boost::posix_time::pos_infin);
+    this->set_message_timeout(boost::posix_time::seconds(30));
+}
+
 Association
 ::Association(Association const & other)
 : _state_machine(), _peer_host(other._peer_host), _peer_port(other._peer_port),
@@ -223,43 +787,7 @@ Association
     this->_state_machine.send_pdu(data);
     this->_state_machine.receive_pdu(data);
 
-    if(data.pdu == nullptr)
-    {
-        throw Exception("No response received");
-    }
-    else
-    {
-        auto const acceptation = std::dynamic_pointer_cast<pdu::AAssociateAC>(data.pdu);
-        auto const rejection = std::dynamic_pointer_cast<pdu::AAssociateRJ>(data.pdu);
-        if(acceptation != nullptr)
-        {
-            this->_negotiated_parameters = AssociationParameters(
-                *acceptation, this->_association_parameters);
-
-            this->_transfer_syntaxes_by_abstract_syntax.clear();
-            this->_transfer_syntaxes_by_id.clear();
-
-            for(auto const & pc: this->_negotiated_parameters.get_presentation_contexts())
-            {
-                if(pc.result != AssociationParameters::PresentationContext::Result::Acceptance)
-                {
-                    continue;
-                }
-
-                this->_transfer_syntaxes_by_id[pc.id] = pc.transfer_syntaxes[0];
-                this->_transfer_syntaxes_by_abstract_syntax[pc.abstract_syntax] =
-                    {pc.id, pc.transfer_syntaxes[0]};
-            }
-        }
-        else if(rejection != nullptr)
-        {
-            throw Exception("Association rejected");
-        }
-        else
-        {
-            throw Exception("Invalid response");
-        }
-    }
+    this->_process_associate_response(data);
 }
 
 void
@@ -274,12 +802,42 @@ Association
     this->_state_machine.set_association_acceptor(acceptor);
 
     this->_state_machine.receive(data);
+    this->_receive_association_request(data);
+}
+
+void
+Association
+::receive_association(AssociationAcceptor acceptor)
+{
+    if(!this->_state_machine.get_transport().is_open())
+    {
+        throw Exception("Not connected");
+    }
+
+    dul::EventData data;
+
+    this->_state_machine.set_association_acceptor(acceptor);
+
+    this->_state_machine.receive(data);
+    this->_receive_association_request(data);
+}
+
+void
+Association
+::_receive_association_request(dul::EventData & data)
+{
     this->_state_machine.receive_pdu(data);
+    this->_process_association_request(data);
+}
 
+void
+Association
+::_process_association_request(dul::EventData & data)
+{
     if(data.pdu == NULL)
     {
         // We have rejected the request
-        if(!data.reject)
+        if(data.reject)
         {
             throw (*data.reject);
         }
@@ -369,90 +927,96 @@ std::shared_ptr<message::Message>
 Association
 ::receive_message()
 {
-    bool done = false;
-    int presentation_context_id;
-    bool command_set_received=false;
-    bool has_data_set=true;
-    bool data_set_received=false;
+    return this->receive_message(DataSetSink());
+}
 
-    std::shared_ptr<DataSet> command_set;
+std::shared_ptr<message::Message>
+Association
+::receive_message(DataSetSink const & sink)
+{
+    dul::EventData data;
 
+    // Receive the command set
     std::string command_buffer;
-    std::string data_buffer;
-
-    while(!done)
+    uint8_t presentation_context_id = 0;
+    bool command_set_received = false;
+    std::size_t next_pdv = 0;
+    while(!command_set_received)
     {
-        dul::EventData data;
-        data.pdu = nullptr;
-        this->_state_machine.receive_pdu(data);
-
-        auto const a_release_rq = std::dynamic_pointer_cast<pdu::AReleaseRQ>(data.pdu);
-        if(a_release_rq != nullptr)
+        this->_receive_p_data_tf(data);
+        next_pdv = 0;
+        while(!command_set_received && next_pdv < data.pdv_items.size())
         {
-            data.pdu = std::make_shared<pdu::AReleaseRP>();
-            this->_state_machine.send_pdu(data);
-            throw AssociationReleased();
-        }
-
-        auto const a_abort = std::dynamic_pointer_cast<pdu::AAbort>(data.pdu);
-        if(a_abort != nullptr)
-        {
-            throw AssociationAborted(a_abort->get_source(), a_abort->get_reason());
-        }
-
-        auto const p_data_tf = std::dynamic_pointer_cast<pdu::PDataTF>(data.pdu);
-
-        if(p_data_tf == nullptr)
-        {
-            throw Exception("Invalid PDU received");
-        }
-
-        for(auto const & pdv: p_data_tf->get_pdv_items())
-        {
-            presentation_context_id = pdv.get_presentation_context_id();
-
-            // Check if this is the last command or data PDV
-            auto & received =
-                pdv.is_command()?command_set_received:data_set_received;
-            received |= pdv.is_last_fragment();
-
-            // Accumulate incoming PDVs in command or data buffer
-            auto & buffer = (pdv.is_command()?command_buffer:data_buffer);
-            buffer.append(pdv.get_fragment());
-
-            if(command_set_received && !command_set)
+            auto const & pdv = data.pdv_items[next_pdv];
+            ++next_pdv;
+            if(!pdv.is_command())
             {
-                IStringStream istream(&command_buffer[0], command_buffer.size());
-                Reader reader(istream, registry::ImplicitVRLittleEndian);
-                command_set = reader.read_data_set();
-                auto const value =
-                    command_set->as_int(registry::CommandDataSetType, 0);
-
-                if(value == message::Message::DataSetType::ABSENT)
-                {
-                    has_data_set = false;
-                }
+                throw Exception("Data set fragment received before command set");
             }
+            presentation_context_id = pdv.presentation_context_id;
+            command_buffer.append(pdv.fragment, pdv.fragment_size);
+            command_set_received = pdv.is_last_fragment();
         }
-
-        done = command_set_received && (!has_data_set || data_set_received);
     }
 
+    IStringStream command_stream(&command_buffer[0], command_buffer.size());
+    Reader command_reader(command_stream, registry::ImplicitVRLittleEndian);
+    auto const command_set = command_reader.read_data_set();
+
     std::shared_ptr<DataSet> data_set;
-    if(has_data_set)
+    bool streamed = false;
+    if(
+        command_set->as_int(registry::CommandDataSetType, 0)
+        != message::Message::DataSetType::ABSENT)
     {
-        auto const transfer_syntax_it =
-            this->_transfer_syntaxes_by_id.find(presentation_context_id);
-        if(transfer_syntax_it == this->_transfer_syntaxes_by_id.end())
+        auto const & transfer_syntax =
+            this->_get_transfer_syntax(presentation_context_id);
+
+        // Decode or copy the data set as its fragments are received, holding
+        // a single PDU in memory.
+        DataSetBuffer buffer(
+            [this, &data]() { this->_receive_p_data_tf(data); },
+            data.pdv_items, next_pdv);
+
+        std::ostream * const output =
+            sink?sink(command_set, transfer_syntax):nullptr;
+        if(output != nullptr)
         {
-            throw Exception("No such Presentation Context ID");
+            buffer.copy_to(*output);
+            data_set = std::make_shared<DataSet>(transfer_syntax);
+            streamed = true;
+        }
+        else
+        {
+            std::istream stream(&buffer);
+            // Report the errors of the association, not a bad stream.
+            stream.exceptions(std::ios::badbit);
+            try
+            {
+                Reader reader(stream, transfer_syntax);
+                data_set = reader.read_data_set();
+            }
+            catch(AssociationReleased const &)
+            {
+                throw;
+            }
+            catch(AssociationAborted const &)
+            {
+                throw;
+            }
+            catch(Exception const &)
+            {
+                // Keep the association usable for the next message.
+                buffer.skip();
+                throw;
+            }
+            buffer.skip();
         }
-
-        IStringStream istream(&data_buffer[0], data_buffer.size());
-        Reader reader(istream, transfer_syntax_it->second);
-        data_set = reader.read_data_set();
     }
-    return std::make_shared<message::Message>(command_set, data_set);
+    auto const message =
+        std::make_shared<message::Message>(command_set, data_set);
+    message->set_data_set_streamed(streamed);
+    return message;
 }
 
 void
@@ -473,84 +1037,468 @@ Association
         throw Exception("No transfer syntax for "+abstract_syntax);
     }
 
-    auto const & transfer_syntax = transfer_syntax_it->second.second;
-    auto const & id = transfer_syntax_it->second.first;
+    this->_send_message(
+        message, transfer_syntax_it->second.first,
+        transfer_syntax_it->second.second);
+}
 
-    std::vector<pdu::PDataTF::PresentationDataValueItem> pdv_items;
+void
+Association
+::send_message(
+    std::shared_ptr<message::Message const> message,
+    std::string const & abstract_syntax, std::string const & transfer_syntax)
+{
+    if(!this->is_associated())
+    {
+        throw Exception("Not associated");
+    }
 
-    std::string command_buffer;
-    OStringStream command_stream(command_buffer);
+    for(auto const & pc: this->_negotiated_parameters.get_presentation_contexts())
+    {
+        if(
+            pc.result == AssociationParameters::PresentationContext::Result::Acceptance
+            && pc.abstract_syntax == abstract_syntax
+            && pc.transfer_syntaxes[0] == transfer_syntax)
+        {
+            this->_send_message(message, pc.id, transfer_syntax);
+            return;
+        }
+    }
+
+    throw Exception(
+        "No presentation context for "+abstract_syntax+" with "
+        +transfer_syntax);
+}
+
+void
+Association
+::_send_message(
+    std::shared_ptr<message::Message const> message, uint8_t id,
+    std::string const & transfer_syntax)
+{
+    std::size_t const maximum_length =
+        this->_negotiated_parameters.get_maximum_length();
+    PDataTFSender sender(this->_state_machine, id, maximum_length);
+
+    // Large values of the data set (e.g. pixel data) are referenced by the
+    // encoded PDUs and sent with vectored I/O, without intermediate copies.
+    SegmentStream command_stream;
     Writer command_writer(
         command_stream, registry::ImplicitVRLittleEndian, // implicit vr for command
         Writer::ItemEncoding::ExplicitLength, true); // true for Command
     command_writer.write_data_set(message->get_command_set());
-    command_stream.flush();
-    pdv_items.emplace_back(id, 3, command_buffer);
+    sender.add_command(command_stream);
 
-    if (message->has_data_set())
+    if(message->has_data_set())
     {
-        std::string data_buffer;
-        OStringStream data_stream(data_buffer);
+        // Full PDUs are sent while the data set is encoded: only the last
+        // PDU is buffered, and large values are not buffered at all.
+        auto const consumer =
+            [&sender](std::vector<SegmentStream::Segment> const & segments) {
+                return sender.send_data(segments, false); };
+        SegmentStream data_stream(
+            maximum_length,
+            maximum_length ? consumer : SegmentStream::Consumer());
+
         Writer data_writer(
             data_stream, transfer_syntax,
             Writer::ItemEncoding::ExplicitLength, false);
         data_writer.write_data_set(message->get_data_set());
-        data_stream.flush();
+        sender.send_data(data_stream.get_segments(), true);
+    }
+    else
+    {
+        sender.flush();
+    }
+}
+
+uint16_t
+Association
+::next_message_id()
+{
+    return ++this->_next_message_id;
+}
+
+void
+Association
+::async_associate(Handler const & handler)
+{
+    auto & transport = this->_state_machine.get_transport();
+    transport.get_strand().dispatch([this, &transport, handler]() {
+        auto const resolver = std::make_shared<boost::asio::ip::tcp::resolver>(
+            transport.get_service());
+        boost::asio::ip::tcp::resolver::query const query(this->_peer_host, "");
+        resolver->async_resolve(
+            query,
+            transport.get_strand().wrap(
+                [this, &transport, resolver, handler](
+                    boost::system::error_code const & error,
+                    boost::asio::ip::tcp::resolver::iterator endpoint_it)
+                {
+                    if(error)
+                    {
+                        handler(get_exception(error));
+                        return;
+                    }
+
+                    auto const data = std::make_shared<dul::EventData>();
+                    data->peer_endpoint = *endpoint_it;
+                    data->peer_endpoint.port(this->_peer_port);
+
+                    transport.async_connect(
+                        data->peer_endpoint,
+                        [this, data, handler](
+                            boost::system::error_code const & error)
+                        {
+                            this->_async_associate(data, error, handler);
+                        });
+                }));
+    });
+}
 
-        auto const max_length = this->_negotiated_parameters.get_maximum_length();
-        auto current_length = command_buffer.size() + 12; // 12 is the size of all that is added on top of the fragment
-        if (!max_length 
-            || (current_length + data_buffer.size() + 6 < max_length))
-        {   // Can send all the buffer in one go
-            pdv_items.emplace_back(transfer_syntax_it->second.first, 2, data_buffer);
+void
+Association
+::async_receive_association(
+    AssociationAcceptor acceptor, Handler const & handler)
+{
+    auto & transport = this->_state_machine.get_transport();
+    transport.get_strand().dispatch([this, &transport, acceptor, handler]() {
+        auto const data = std::make_shared<dul::EventData>();
+        try
+        {
+            if(!transport.is_open())
+            {
+                throw Exception("Not connected");
+            }
+            this->_state_machine.set_association_acceptor(acceptor);
+            this->_state_machine.receive(*data);
+        }
+        catch(...)
+        {
+            handler(std::current_exception());
+            return;
+        }
+
+        this->_state_machine.async_receive_pdu(
+            *data, [this, data, handler](std::exception_ptr error)
+            {
+                if(!error)
+                {
+                    try
+                    {
+                        this->_process_association_request(*data);
+                    }
+                    catch(...)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+                handler(error);
+            });
+    });
+}
 
-            dul::EventData data;
-            data.pdu = std::make_shared<pdu::PDataTF>(pdv_items);
-            this->_state_machine.send_pdu(data);
+void
+Association
+::async_release(Handler const & handler)
+{
+    auto & transport = this->_state_machine.get_transport();
+    transport.get_strand().dispatch([this, handler]() {
+        auto const data = std::make_shared<dul::EventData>();
+        try
+        {
+            if(!this->is_associated())
+            {
+                throw Exception("Not associated");
+            }
+            data->pdu = std::make_shared<pdu::AReleaseRQ>();
+            this->_state_machine.send_pdu(*data);
         }
-        else // We have to fragment into multiple PDUs
+        catch(...)
+        {
+            handler(std::current_exception());
+            return;
+        }
+
+        // Invalid responses are accepted, as in release.
+        this->_state_machine.async_receive_pdu(
+            *data, [data, handler](std::exception_ptr error) {
+                handler(error); });
+    });
+}
+
+void
+Association
+::async_receive_message(MessageHandler const & handler)
+{
+    auto const reception = std::make_shared<MessageReception>();
+    auto & transport = this->_state_machine.get_transport();
+    transport.get_strand().dispatch([this, reception, handler]() {
+        this->_async_receive_pdus(reception, handler); });
+}
+
+void
+Association
+::async_send_message(
+    std::shared_ptr<message::Message const> message,
+    std::string const & abstract_syntax, Handler const & handler)
+{
+    auto & transport = this->_state_machine.get_transport();
+    transport.get_strand().dispatch(
+        [this, message, abstract_syntax, handler]()
         {
-            auto available = max_length - 6 - current_length; // Need at least 6 bytes for the headers
-            int64_t remaining = data_buffer.size();
-            std::size_t offset = 0;
+            // The PDUs reference the encoded message, kept until they are
+            // written.
+            auto const emission = std::make_shared<MessageEmission>();
+            emission->message = message;
+            try
+            {
+                if(!this->is_associated())
+                {
+                    throw Exception("Not associated");
+                }
 
-            if (available > 0) // Send some data with the command set
+                auto const transfer_syntax_it =
+                    this->_transfer_syntaxes_by_abstract_syntax.find(
+                        abstract_syntax);
+                if(
+                    transfer_syntax_it
+                    == this->_transfer_syntaxes_by_abstract_syntax.end())
+                {
+                    throw Exception("No transfer syntax for "+abstract_syntax);
+                }
+                auto const & transfer_syntax = transfer_syntax_it->second.second;
+                auto const & id = transfer_syntax_it->second.first;
+
+                // Errors are reported to the handler of the last PDU, which
+                // completes the emission. Every PDU keeps the emission, and
+                // the buffers it references, until it is written.
+                emission->sender = std::make_shared<PDataTFSender>(
+                    this->_state_machine, id,
+                    this->_negotiated_parameters.get_maximum_length(),
+                    [emission](boost::system::error_code const &) {});
+                auto const last_write_handler =
+                    [emission, handler](boost::system::error_code const & e) {
+                        handler(get_exception(e)); };
+
+                Writer command_writer(
+                    emission->command_stream, registry::ImplicitVRLittleEndian,
+                    Writer::ItemEncoding::ExplicitLength, true);
+                command_writer.write_data_set(message->get_command_set());
+                emission->sender->add_command(emission->command_stream);
+
+                if(message->has_data_set())
+                {
+                    Writer data_writer(
+                        emission->data_stream, transfer_syntax,
+                        Writer::ItemEncoding::ExplicitLength, false);
+                    data_writer.write_data_set(message->get_data_set());
+                    emission->sender->send_data(
+                        emission->data_stream.get_segments(), true,
+                        last_write_handler);
+                }
+                else
+                {
+                    emission->sender->flush(last_write_handler);
+                }
+            }
+            catch(...)
             {
-                remaining -= available;
-                pdv_items.emplace_back(transfer_syntax_it->second.first, (remaining > 0 ? 0 : 2), data_buffer.substr(0, available));
-                offset += available;
+                handler(std::current_exception());
             }
 
-            auto pdu = std::make_shared<pdu::PDataTF>(pdv_items);
-            dul::EventData data;
-            data.pdu = pdu;
-            this->_state_machine.send_pdu(data);
+            // Break the cycle between the emission and the handler of its
+            // sender.
+            if(emission->sender)
+            {
+                emission->sender->release_write_handler();
+            }
+        });
+}
 
-            available = max_length - 6; // In case some software do not take into account the size of the header when allocating their buffer
-            while (remaining > 0)
+void
+Association
+::_receive_p_data_tf(dul::EventData & data)
+{
+    data.pdu = nullptr;
+    this->_state_machine.receive_pdu(data);
+    this->_check_p_data_tf(data);
+}
+
+void
+Association
+::_check_p_data_tf(dul::EventData & data)
+{
+    auto const a_release_rq = std::dynamic_pointer_cast<pdu::AReleaseRQ>(data.pdu);
+    if(a_release_rq != nullptr)
+    {
+        data.pdu = std::make_shared<pdu::AReleaseRP>();
+        this->_state_machine.send_pdu(data);
+        throw AssociationReleased();
+    }
+
+    auto const a_abort = std::dynamic_pointer_cast<pdu::AAbort>(data.pdu);
+    if(a_abort != nullptr)
+    {
+        throw AssociationAborted(a_abort->get_source(), a_abort->get_reason());
+    }
+
+    // P-DATA-TF PDUs are received as PDV items referencing the PDU.
+    if(data.pdu != nullptr || data.pdv_items.empty())
+    {
+        throw Exception("Invalid PDU received");
+    }
+}
+
+void
+Association
+::_async_associate(
+    std::shared_ptr<dul::EventData> data,
+    boost::system::error_code const & error, Handler const & handler)
+{
+    if(error)
+    {
+        handler(get_exception(error));
+        return;
+    }
+
+    try
+    {
+        data->pdu = std::make_shared<pdu::AAssociateRQ>(
+            this->_association_parameters.as_a_associate_rq());
+        this->_state_machine.send_pdu(*data);
+    }
+    catch(...)
+    {
+        handler(std::current_exception());
+        return;
+    }
+
+    this->_state_machine.async_receive_pdu(
+        *data, [this, data, handler](std::exception_ptr error)
+        {
+            if(!error)
             {
-                remaining -= available;
-                pdv_items.clear();
-                pdv_items.emplace_back(transfer_syntax_it->second.first, (remaining > 0 ? 0 : 2), data_buffer.substr(offset, available));
-                offset += available;
-                pdu->set_pdv_items(pdv_items);
-                this->_state_machine.send_pdu(data);
+                try
+                {
+                    this->_process_associate_response(*data);
+                }
+                catch(...)
+                {
+                    error = std::current_exception();
+                }
             }
-        }
+            handler(error);
+        });
+}
+
+void
+Association
+::_async_receive_pdus(
+    std::shared_ptr<MessageReception> reception,
+    MessageHandler const & handler)
+{
+    reception->data.pdu = nullptr;
+    this->_state_machine.async_receive_pdu(
+        reception->data,
+        [this, reception, handler](std::exception_ptr error)
+        {
+            std::shared_ptr<message::Message> message;
+            if(!error)
+            {
+                try
+                {
+                    this->_check_p_data_tf(reception->data);
+                    if(reception->add_pdv_items())
+                    {
+                        std::shared_ptr<DataSet> data_set;
+                        if(reception->has_data_set)
+                        {
+                            auto const & buffer = reception->data_set_buffer;
+                            IStringStream stream(&buffer[0], buffer.size());
+                            Reader reader(
+                                stream,
+                                this->_get_transfer_syntax(
+                                    reception->presentation_context_id));
+                            data_set = reader.read_data_set();
+                        }
+                        message = std::make_shared<message::Message>(
+                            reception->command_set, data_set);
+                    }
+                }
+                catch(...)
+                {
+                    error = std::current_exception();
+                }
+            }
+
+            if(error || message)
+            {
+                handler(message, error);
+            }
+            else
+            {
+                this->_async_receive_pdus(reception, handler);
+            }
+        });
+}
+
+void
+Association
+::_process_associate_response(dul::EventData & data)
+{
+    if(data.pdu == nullptr)
+    {
+        throw Exception("No response received");
     }
     else
     {
-        dul::EventData data;
-        data.pdu = std::make_shared<pdu::PDataTF>(pdv_items);
-        this->_state_machine.send_pdu(data);
+        auto const acceptation = std::dynamic_pointer_cast<pdu::AAssociateAC>(data.pdu);
+        auto const rejection = std::dynamic_pointer_cast<pdu::AAssociateRJ>(data.pdu);
+        if(acceptation != nullptr)
+        {
+            this->_negotiated_parameters = AssociationParameters(
+                *acceptation, this->_association_parameters);
+
+            this->_transfer_syntaxes_by_abstract_syntax.clear();
+            this->_transfer_syntaxes_by_id.clear();
+
+            for(auto const & pc: this->_negotiated_parameters.get_presentation_contexts())
+            {
+                if(pc.result != AssociationParameters::PresentationContext::Result::Acceptance)
+                {
+                    continue;
+                }
+
+                this->_transfer_syntaxes_by_id[pc.id] = pc.transfer_syntaxes[0];
+                this->_transfer_syntaxes_by_abstract_syntax[pc.abstract_syntax] =
+                    {pc.id, pc.transfer_syntaxes[0]};
+            }
+        }
+        else if(rejection != nullptr)
+        {
+            throw AssociationRejected(
+                rejection->get_result(), rejection->get_source(),
+                rejection->get_reason(), "Association rejected");
+        }
+        else
+        {
+            throw Exception("Invalid response");
+        }
     }
 }
 
-uint16_t
+std::string const &
 Association
-::next_message_id()
+::_get_transfer_syntax(uint8_t presentation_context_id) const
 {
-    return ++this->_next_message_id;
+    auto const transfer_syntax_it =
+        this->_transfer_syntaxes_by_id.find(presentation_context_id);
+    if(transfer_syntax_it == this->_transfer_syntaxes_by_id.end())
+    {
+        throw Exception("No such Presentation Context ID");
+    }
+    return transfer_syntax_it->second;
 }
 
 AssociationReleased
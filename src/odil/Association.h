@@ -10,13 +10,19 @@
 #define _a52696bc_5c6e_402d_a343_6cb085eb0138
 
 #include <cstdint>
+#include <exception>
 #include <functional>
 #include <map>
+#include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 
+#include <boost/asio.hpp>
+
 #include "odil/AssociationAcceptor.h"
 #include "odil/AssociationParameters.h"
+#include "odil/DataSet.h"
 #include "odil/dul/StateMachine.h"
 #include "odil/message/Message.h"
 #include "odil/odil.h"
@@ -26,6 +32,12 @@ namespace odil
 
 /**
  * @brief Association.
+ *
+ * An association created on a caller-supplied io_service is asynchronous:
+ * the blocking operations which wait for the peer are not available, but
+ * the asynchronous operations allow a few threads running the io_service to
+ * serve many associations. The handlers of an association are serialized by
+ * the strand of its transport, and the association must outlive them.
  */
 class ODIL_API Association
 {
@@ -78,9 +90,31 @@ public:
     /// @brief Duration of the timeout.
     typedef dul::StateMachine::duration_type duration_type;
 
+    /**
+     * @brief Callback returning, for the command set of a received message,
+     * the stream to which the encoded data set is copied instead of being
+     * decoded, or null to decode it. The transfer syntax of the data set is
+     * passed as second argument.
+     */
+    typedef std::function<
+            std::ostream *(
+                std::shared_ptr<DataSet const>, std::string const &)
+        > DataSetSink;
+
+    /// @brief Handler of asynchronous operations, with the error if any.
+    typedef std::function<void(std::exception_ptr)> Handler;
+
+    /// @brief Handler of the asynchronous reception of a message.
+    typedef std::function<
+            void(std::shared_ptr<message::Message>, std::exception_ptr)
+        > MessageHandler;
+
     /// @brief Create a default, un-associated, association.
     Association();
 
+    /// @brief Create an un-associated, asynchronous, association.
+    Association(boost::asio::io_service & service);
+
     /// @brief Create an un-associated association.
     Association(Association const & other);
 
@@ -151,6 +185,13 @@ public:
         boost::asio::ip::tcp const & protocol, unsigned short port,
         AssociationAcceptor acceptor=default_association_acceptor);
 
+    /**
+     * @brief Receive an association from a peer whose connection was
+     * accepted on the transport, e.g. by Transport::async_receive.
+     */
+    void receive_association(
+        AssociationAcceptor acceptor=default_association_acceptor);
+
     /// @brief Reject the received association request.
     void reject(Result result, ResultSource result_source, Diagnostic diagnostic);
 
@@ -172,17 +213,86 @@ public:
      */
     std::shared_ptr<message::Message> receive_message();
 
+    /**
+     * @brief Receive a generic DIMSE message, the data set is decoded while
+     * its fragments are received.
+     *
+     * If the sink returns a stream, the encoded data set is copied to it as
+     * it is received and the message holds an empty data set, flagged with
+     * message::Message::is_data_set_streamed.
+     */
+    std::shared_ptr<message::Message> receive_message(DataSetSink const & sink);
+
     /// @brief Send a DIMSE message.
     void send_message(
         std::shared_ptr<message::Message const> message,
         std::string const & abstract_syntax);
 
+    /**
+     * @brief Send a DIMSE message on the presentation context of the abstract
+     * syntax which accepted the given transfer syntax, when several contexts
+     * were negotiated for the same abstract syntax.
+     */
+    void send_message(
+        std::shared_ptr<message::Message const> message,
+        std::string const & abstract_syntax,
+        std::string const & transfer_syntax);
+
     /// @brief Return the next available message id.
     uint16_t next_message_id();
 
     /// @}
 
+    /**
+     * @name Asynchronous operations.
+     *
+     * The handler is called once the operation is completed, with the error
+     * (e.g. AssociationReleased) if it failed. abort is not blocking and is
+     * also available on asynchronous associations.
+     */
+    /// @{
+
+    /// @brief Asynchronously request an association with the peer.
+    void async_associate(Handler const & handler);
+
+    /**
+     * @brief Asynchronously receive an association from a peer whose
+     * connection was accepted on the transport, e.g. by
+     * Transport::async_receive.
+     */
+    void async_receive_association(
+        AssociationAcceptor acceptor, Handler const & handler);
+
+    /// @brief Asynchronously release the association.
+    void async_release(Handler const & handler);
+
+    /**
+     * @brief Asynchronously receive a generic DIMSE message.
+     *
+     * Unlike receive_message, the data set is not decoded while its fragments
+     * are received: they are buffered until the last one, so that the whole
+     * encoded data set is held in memory.
+     */
+    void async_receive_message(MessageHandler const & handler);
+
+    /**
+     * @brief Asynchronously send a DIMSE message. The message is not copied,
+     * and must not be modified until the handler is called.
+     *
+     * Unlike send_message, the whole data set is encoded before its first PDU
+     * is written: its large values are referenced, but the rest of the
+     * encoded data set is held in memory until the message is sent.
+     */
+    void async_send_message(
+        std::shared_ptr<message::Message const> message,
+        std::string const & abstract_syntax, Handler const & handler);
+
+    /// @}
+
 private:
+    /// @brief State of an asynchronous reception of a message.
+    struct MessageReception;
+
     dul::StateMachine _state_machine;
 
     std::string _peer_host;
@@ -196,6 +306,45 @@ private:
     std::map<uint8_t, std::string> _transfer_syntaxes_by_id;
 
     uint16_t _next_message_id;
+
+    /// @brief Send a DIMSE message on the given presentation context.
+    void _send_message(
+        std::shared_ptr<message::Message const> message, uint8_t id,
+        std::string const & transfer_syntax);
+
+    /**
+     * @brief Receive a P-DATA-TF PDU in data, throw an exception if the peer
+     * released or aborted the association.
+     */
+    void _receive_p_data_tf(dul::EventData & data);
+
+    /**
+     * @brief Throw an exception if the received PDU is not a P-DATA-TF PDU,
+     * e.g. if the peer released or aborted the association.
+     */
+    void _check_p_data_tf(dul::EventData & data);
+
+    /// @brief Receive and answer an association request.
+    void _receive_association_request(dul::EventData & data);
+
+    /// @brief Process the answered association request.
+    void _process_association_request(dul::EventData & data);
+
+    /// @brief Process the response to an association request.
+    void _process_associate_response(dul::EventData & data);
+
+    /// @brief Return the transfer syntax of a presentation context.
+    std::string const & _get_transfer_syntax(uint8_t presentation_context_id) const;
+
+    /// @brief Send the association request once the transport is connected.
+    void _async_associate(
+        std::shared_ptr<dul::EventData> data,
+        boost::system::error_code const & error, Handler const & handler);
+
+    /// @brief Receive PDUs until the message is complete.
+    void _async_receive_pdus(
+        std::shared_ptr<MessageReception> reception,
+        MessageHandler const & handler);
 };
 
 /** 
@@ -0,0 +1,622 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/AssociationPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "odil/Association.h"
+#include "odil/AssociationParameters.h"
+#include "odil/EchoSCU.h"
+#include "odil/Exception.h"
+#include "odil/logging.h"
+#include "odil/registry.h"
+
+namespace odil
+{
+
+AssociationPool::Lease
+::Lease()
+: _pool(nullptr), _association(), _parameters(), _peer()
+{
+    // Nothing else.
+}
+
+AssociationPool::Lease
+::Lease(Lease && other)
+: _pool(other._pool), _association(std::move(other._association)),
+  _parameters(std::move(other._parameters)), _peer(std::move(other._peer))
+{
+    other._pool = nullptr;
+    other._association.reset();
+}
+
+AssociationPool::Lease &
+AssociationPool::Lease
+::operator=(Lease && other)
+{
+    if(this != &other)
+    {
+        this->_give_back(false);
+
+        this->_pool = other._pool;
+        this->_association = std::move(other._association);
+        this->_parameters = std::move(other._parameters);
+        this->_peer = std::move(other._peer);
+
+        other._pool = nullptr;
+        other._association.reset();
+    }
+
+    return *this;
+}
+
+AssociationPool::Lease
+::~Lease()
+{
+    try
+    {
+        this->_give_back(false);
+    }
+    catch(std::exception const & e)
+    {
+        ODIL_LOG(warning) << "Cannot give back association: " << e.what();
+    }
+}
+
+Association &
+AssociationPool::Lease
+::get_association() const
+{
+    if(!this->_association)
+    {
+        throw Exception("Empty lease");
+    }
+    return *this->_association;
+}
+
+Association &
+AssociationPool::Lease
+::operator*() const
+{
+    return this->get_association();
+}
+
+Association *
+AssociationPool::Lease
+::operator->() const
+{
+    return &this->get_association();
+}
+
+void
+AssociationPool::Lease
+::discard()
+{
+    this->_give_back(true);
+}
+
+AssociationPool::Lease
+::Lease(
+    AssociationPool * pool, std::shared_ptr<Association> association,
+    AssociationParameters const & parameters,
+    std::pair<std::string, uint16_t> const & peer)
+: _pool(pool), _association(association), _parameters(parameters),
+  _peer(peer)
+{
+    // Nothing else.
+}
+
+void
+AssociationPool::Lease
+::_give_back(bool discard)
+{
+    if(this->_pool == nullptr || !this->_association)
+    {
+        return;
+    }
+
+    auto const pool = this->_pool;
+    auto const association = std::move(this->_association);
+    this->_pool = nullptr;
+    this->_association.reset();
+
+    pool->_give_back(association, this->_parameters, this->_peer, discard);
+}
+
+AssociationPool
+::AssociationPool()
+: _maximum_associations_per_peer(4),
+  _maximum_idle_time(boost::posix_time::seconds(60)),
+  _liveness_check_interval(boost::posix_time::seconds(5)),
+  _acquire_timeout(boost::posix_time::pos_infin)
+{
+    // Nothing else.
+}
+
+AssociationPool
+::~AssociationPool()
+{
+    this->clear();
+}
+
+std::size_t
+AssociationPool
+::get_maximum_associations_per_peer() const
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_maximum_associations_per_peer;
+}
+
+void
+AssociationPool
+::set_maximum_associations_per_peer(std::size_t maximum)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_maximum_associations_per_peer = maximum;
+    }
+    this->_condition.notify_all();
+}
+
+Association::duration_type
+AssociationPool
+::get_maximum_idle_time() const
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_maximum_idle_time;
+}
+
+void
+AssociationPool
+::set_maximum_idle_time(Association::duration_type const & duration)
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_maximum_idle_time = duration;
+}
+
+Association::duration_type
+AssociationPool
+::get_liveness_check_interval() const
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_liveness_check_interval;
+}
+
+void
+AssociationPool
+::set_liveness_check_interval(Association::duration_type const & duration)
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_liveness_check_interval = duration;
+}
+
+Association::duration_type
+AssociationPool
+::get_acquire_timeout() const
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_acquire_timeout;
+}
+
+void
+AssociationPool
+::set_acquire_timeout(Association::duration_type const & duration)
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_acquire_timeout = duration;
+}
+
+AssociationPool::Lease
+AssociationPool
+::acquire(Association const & association)
+{
+    PeerKey const key(association.get_peer_host(), association.get_peer_port());
+    auto const & parameters = association.get_parameters();
+
+    Association::duration_type acquire_timeout;
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        acquire_timeout = this->_acquire_timeout;
+    }
+    // Only used with a finite timeout.
+    auto const deadline =
+        acquire_timeout.is_pos_infinity()
+        ? Clock::time_point()
+        : Clock::now() + _to_clock(acquire_timeout);
+
+    while(true)
+    {
+        std::shared_ptr<Association> idle;
+        Clock::duration idle_time;
+        bool create = false;
+        std::vector<std::shared_ptr<Association>> closed;
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            while(true)
+            {
+                auto const now = Clock::now();
+                auto const expired = this->_collect_expired(now);
+                closed.insert(closed.end(), expired.begin(), expired.end());
+
+                auto & peer = this->_peers[key];
+
+                // Most recently used first: it is the most likely to be alive.
+                auto const it = std::find_if(
+                    peer.idle.rbegin(), peer.idle.rend(),
+                    [&](Idle const & item)
+                    {
+                        return item.parameters == parameters;
+                    });
+                if(it != peer.idle.rend())
+                {
+                    idle = it->association;
+                    idle_time = now - it->since;
+                    peer.idle.erase(std::next(it).base());
+                    break;
+                }
+
+                if(
+                    this->_maximum_associations_per_peer == 0
+                    || peer.count < this->_maximum_associations_per_peer)
+                {
+                    ++peer.count;
+                    create = true;
+                    break;
+                }
+
+                if(!peer.idle.empty())
+                {
+                    // Replace the least recently used association, negotiated
+                    // with other parameters.
+                    closed.push_back(peer.idle.front().association);
+                    peer.idle.erase(peer.idle.begin());
+                    create = true;
+                    break;
+                }
+
+                if(acquire_timeout.is_pos_infinity())
+                {
+                    this->_condition.wait(lock);
+                }
+                else if(
+                    this->_condition.wait_until(lock, deadline)
+                        == std::cv_status::timeout)
+                {
+                    break;
+                }
+            }
+        }
+
+        _close(closed);
+
+        if(idle)
+        {
+            if(this->_is_alive(*idle, idle_time))
+            {
+                return Lease(this, idle, parameters, key);
+            }
+            this->_forget(key);
+        }
+        else if(create)
+        {
+            try
+            {
+                return Lease(this, _create(association), parameters, key);
+            }
+            catch(...)
+            {
+                this->_forget(key);
+                throw;
+            }
+        }
+        else
+        {
+            throw Exception(
+                "No association available with "
+                + key.first + ":" + std::to_string(key.second));
+        }
+    }
+}
+
+std::size_t
+AssociationPool
+::get_associations_count(std::string const & host, uint16_t port) const
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    auto const it = this->_peers.find({host, port});
+    return (it != this->_peers.end())?it->second.count:0;
+}
+
+std::size_t
+AssociationPool
+::get_idle_associations_count(std::string const & host, uint16_t port) const
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    auto const it = this->_peers.find({host, port});
+    return (it != this->_peers.end())?it->second.idle.size():0;
+}
+
+void
+AssociationPool
+::evict_idle()
+{
+    std::vector<std::shared_ptr<Association>> expired;
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        expired = this->_collect_expired(Clock::now());
+    }
+    this->_condition.notify_all();
+    _close(expired);
+}
+
+void
+AssociationPool
+::clear()
+{
+    std::vector<std::shared_ptr<Association>> idle;
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        auto it = this->_peers.begin();
+        while(it != this->_peers.end())
+        {
+            auto & peer = it->second;
+            for(auto const & item: peer.idle)
+            {
+                idle.push_back(item.association);
+            }
+            peer.count -= peer.idle.size();
+            peer.idle.clear();
+
+            if(peer.count == 0)
+            {
+                it = this->_peers.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+    this->_condition.notify_all();
+    _close(idle);
+}
+
+std::vector<std::shared_ptr<Association>>
+AssociationPool
+::_collect_expired(Clock::time_point const & now)
+{
+    std::vector<std::shared_ptr<Association>> expired;
+
+    auto const maximum_idle_time = _to_clock(this->_maximum_idle_time);
+    auto it = this->_peers.begin();
+    while(it != this->_peers.end())
+    {
+        auto & peer = it->second;
+        auto const end = std::remove_if(
+            peer.idle.begin(), peer.idle.end(),
+            [&](Idle const & item)
+            {
+                if(now - item.since < maximum_idle_time)
+                {
+                    return false;
+                }
+                expired.push_back(item.association);
+                return true;
+            });
+        peer.count -= std::distance(end, peer.idle.end());
+        peer.idle.erase(end, peer.idle.end());
+
+        if(peer.count == 0)
+        {
+            it = this->_peers.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    return expired;
+}
+
+void
+AssociationPool
+::_forget(PeerKey const & key)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        auto const it = this->_peers.find(key);
+        if(it != this->_peers.end())
+        {
+            --it->second.count;
+            if(it->second.count == 0)
+            {
+                this->_peers.erase(it);
+            }
+        }
+    }
+    this->_condition.notify_all();
+}
+
+void
+AssociationPool
+::_give_back(
+    std::shared_ptr<Association> association,
+    AssociationParameters const & parameters, PeerKey const & key,
+    bool discard)
+{
+    if(discard && association->is_associated())
+    {
+        try
+        {
+            association->abort(0, 0);
+        }
+        catch(std::exception const & e)
+        {
+            ODIL_LOG(debug) << "Cannot abort association: " << e.what();
+        }
+    }
+
+    if(!association->is_associated())
+    {
+        this->_forget(key);
+        return;
+    }
+
+    std::vector<std::shared_ptr<Association>> expired;
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        auto const now = Clock::now();
+        this->_peers[key].idle.push_back({association, parameters, now});
+        expired = this->_collect_expired(now);
+    }
+    this->_condition.notify_all();
+    _close(expired);
+}
+
+bool
+AssociationPool
+::_is_alive(Association & association, Clock::duration idle) const
+{
+    if(!association.is_associated())
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        if(idle < _to_clock(this->_liveness_check_interval))
+        {
+            return true;
+        }
+    }
+
+    auto const & contexts =
+        association.get_negotiated_parameters().get_presentation_contexts();
+    auto const verification = std::find_if(
+        contexts.begin(), contexts.end(),
+        [](AssociationParameters::PresentationContext const & context)
+        {
+            return
+                context.abstract_syntax == registry::Verification
+                && context.result
+                    == AssociationParameters::PresentationContext::Result
+                        ::Acceptance;
+        });
+    if(verification == contexts.end())
+    {
+        // The peer refused the Verification service: trust the association.
+        return true;
+    }
+
+    try
+    {
+        EchoSCU(association).echo();
+        return true;
+    }
+    catch(std::exception const & e)
+    {
+        ODIL_LOG(info)
+            << "Dropping pooled association with "
+            << association.get_peer_host()
+            << ": " << e.what();
+        try
+        {
+            if(association.is_associated())
+            {
+                association.abort(0, 0);
+            }
+        }
+        catch(...)
+        {
+            // Nothing more can be done with this association.
+        }
+        return false;
+    }
+}
+
+std::shared_ptr<Association>
+AssociationPool
+::_create(Association const & prototype)
+{
+    auto association = std::make_shared<Association>(prototype);
+
+    auto contexts = prototype.get_parameters().get_presentation_contexts();
+    auto const has_verification = std::any_of(
+        contexts.begin(), contexts.end(),
+        [](AssociationParameters::PresentationContext const & context)
+        {
+            return context.abstract_syntax == registry::Verification;
+        });
+    if(!has_verification)
+    {
+        contexts.emplace_back(
+            registry::Verification,
+            std::vector<std::string>{ registry::ImplicitVRLittleEndian },
+            AssociationParameters::PresentationContext::Role::SCU);
+        try
+        {
+            association->update_parameters().set_presentation_contexts(
+                contexts);
+        }
+        catch(Exception const &)
+        {
+            // No presentation context ID left: the association is pooled
+            // without liveness check.
+        }
+    }
+
+    association->associate();
+    return association;
+}
+
+void
+AssociationPool
+::_close(std::vector<std::shared_ptr<Association>> const & associations)
+{
+    for(auto const & association: associations)
+    {
+        try
+        {
+            if(association->is_associated())
+            {
+                association->release();
+            }
+        }
+        catch(std::exception const & e)
+        {
+            ODIL_LOG(debug)
+                << "Cannot release pooled association: " << e.what();
+        }
+    }
+}
+
+AssociationPool::Clock::duration
+AssociationPool
+::_to_clock(Association::duration_type const & value)
+{
+    if(value.is_pos_infinity())
+    {
+        return Clock::duration::max();
+    }
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::microseconds(value.total_microseconds()));
+}
+
+}
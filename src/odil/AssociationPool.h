@@ -0,0 +1,229 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _e204cc1c_ca0e_4591_bc13_5337ed0d6256
+#define _e204cc1c_ca0e_4591_bc13_5337ed0d6256
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "odil/Association.h"
+#include "odil/AssociationParameters.h"
+#include "odil/odil.h"
+
+namespace odil
+{
+
+/**
+ * @brief Pool of established associations, reused by successive SCU
+ * operations with the same peer.
+ *
+ * Associations are matched by peer (host and port) and by requested
+ * parameters. A Verification presentation context is added to the requested
+ * ones, so that associations which stayed idle for a while can be checked
+ * with a C-ECHO before being handed out again. The pool may be used from
+ * several threads, and must outlive its leases.
+ */
+class ODIL_API AssociationPool
+{
+public:
+    /**
+     * @brief Exclusive use of a pooled association; the association goes
+     * back to the pool when the lease is destroyed.
+     *
+     * If the association is released or aborted during the lease, it is
+     * removed from the pool.
+     */
+    class ODIL_API Lease
+    {
+    public:
+        /// @brief Create an empty lease.
+        Lease();
+
+        Lease(Lease const &) = delete;
+        Lease & operator=(Lease const &) = delete;
+
+        /// @brief Take over another lease.
+        Lease(Lease && other);
+
+        /// @brief Give back the association and take over another lease.
+        Lease & operator=(Lease && other);
+
+        /// @brief Give back the association to the pool.
+        ~Lease();
+
+        /// @brief Return the association, throw if the lease is empty.
+        Association & get_association() const;
+
+        /// @brief Return the association, throw if the lease is empty.
+        Association & operator*() const;
+
+        /// @brief Return the association, throw if the lease is empty.
+        Association * operator->() const;
+
+        /**
+         * @brief Abort the association instead of giving it back, e.g. if an
+         * operation was interrupted and its state is unknown.
+         */
+        void discard();
+
+    private:
+        friend class AssociationPool;
+
+        AssociationPool * _pool;
+        std::shared_ptr<Association> _association;
+        AssociationParameters _parameters;
+        std::pair<std::string, uint16_t> _peer;
+
+        Lease(
+            AssociationPool * pool, std::shared_ptr<Association> association,
+            AssociationParameters const & parameters,
+            std::pair<std::string, uint16_t> const & peer);
+
+        /// @brief Give back the association, if any.
+        void _give_back(bool discard);
+    };
+
+    /// @brief Create an empty pool.
+    AssociationPool();
+
+    /// @brief Release the idle associations.
+    ~AssociationPool();
+
+    AssociationPool(AssociationPool const &) = delete;
+    AssociationPool & operator=(AssociationPool const &) = delete;
+
+    /**
+     * @brief Return the maximum number of associations (idle or leased) with
+     * a peer, default to 4; 0 means no limit.
+     */
+    std::size_t get_maximum_associations_per_peer() const;
+
+    /// @brief Set the maximum number of associations with a peer.
+    void set_maximum_associations_per_peer(std::size_t maximum);
+
+    /**
+     * @brief Return the time after which an idle association is released,
+     * default to 60 s.
+     */
+    Association::duration_type get_maximum_idle_time() const;
+
+    /// @brief Set the time after which an idle association is released.
+    void set_maximum_idle_time(Association::duration_type const & duration);
+
+    /**
+     * @brief Return the idle time after which an association is checked with
+     * a C-ECHO before being handed out, default to 5 s.
+     */
+    Association::duration_type get_liveness_check_interval() const;
+
+    /// @brief Set the idle time after which an association is checked.
+    void set_liveness_check_interval(
+        Association::duration_type const & duration);
+
+    /**
+     * @brief Return how long acquire waits when the limit of associations
+     * with the peer is reached, default to infinity.
+     */
+    Association::duration_type get_acquire_timeout() const;
+
+    /// @brief Set how long acquire waits for an association.
+    void set_acquire_timeout(Association::duration_type const & duration);
+
+    /**
+     * @brief Return an association with the peer and the requested
+     * parameters of the given (non-associated) association, reusing an idle
+     * one if possible.
+     *
+     * The timeouts of a new association are copied from the given one. Throw
+     * an exception if no association becomes available before the acquire
+     * timeout, or if the association cannot be established.
+     */
+    Lease acquire(Association const & association);
+
+    /// @brief Return the number of associations (idle or leased) with a peer.
+    std::size_t get_associations_count(
+        std::string const & host, uint16_t port) const;
+
+    /// @brief Return the number of idle associations with a peer.
+    std::size_t get_idle_associations_count(
+        std::string const & host, uint16_t port) const;
+
+    /// @brief Release the associations idle for more than the maximum time.
+    void evict_idle();
+
+    /// @brief Release all idle associations.
+    void clear();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::pair<std::string, uint16_t> PeerKey;
+
+    struct Idle
+    {
+        std::shared_ptr<Association> association;
+        AssociationParameters parameters;
+        Clock::time_point since;
+    };
+
+    struct Peer
+    {
+        /// @brief Idle and leased associations.
+        std::size_t count;
+
+        /// @brief Idle associations, most recently used last.
+        std::vector<Idle> idle;
+    };
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    std::map<PeerKey, Peer> _peers;
+
+    std::size_t _maximum_associations_per_peer;
+    Association::duration_type _maximum_idle_time;
+    Association::duration_type _liveness_check_interval;
+    Association::duration_type _acquire_timeout;
+
+    /// @brief Remove the expired idle associations, the lock must be held.
+    std::vector<std::shared_ptr<Association>> _collect_expired(
+        Clock::time_point const & now);
+
+    /// @brief Remove an association from the count of its peer.
+    void _forget(PeerKey const & key);
+
+    /// @brief Give back a leased association.
+    void _give_back(
+        std::shared_ptr<Association> association,
+        AssociationParameters const & parameters, PeerKey const & key,
+        bool discard);
+
+    /// @brief Test whether an idle association is still usable.
+    bool _is_alive(Association & association, Clock::duration idle) const;
+
+    /// @brief Create and associate a copy of the prototype.
+    static std::shared_ptr<Association> _create(Association const & prototype);
+
+    /// @brief Release the associations, ignoring errors.
+    static void _close(
+        std::vector<std::shared_ptr<Association>> const & associations);
+
+    /// @brief Convert a duration, infinity being mapped to the maximum.
+    static Clock::duration _to_clock(Association::duration_type const & value);
+};
+
+}
+
+#endif // _e204cc1c_ca0e_4591_bc13_5337ed0d6256
@@ -92,9 +92,8 @@ BasicDirectoryCreator
             throw Exception("No such file: "+absolute_path.string());
         }
 
-        boost::filesystem::ifstream stream(
-            absolute_path, std::ifstream::in | std::ifstream::binary);
-        auto const meta_info_and_data_set = Reader::read_file(stream);
+        auto const meta_info_and_data_set = Reader::read_file(
+            absolute_path.string());
         auto const & data_set = meta_info_and_data_set.second;
 
         auto const & patient_id = data_set->as_string(
@@ -0,0 +1,637 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/BatchStoreSCU.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "odil/Association.h"
+#include "odil/AssociationParameters.h"
+#include "odil/DataSet.h"
+#include "odil/Exception.h"
+#include "odil/logging.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/message/CStoreResponse.h"
+#include "odil/message/Response.h"
+#include "odil/StoreSCU.h"
+
+namespace
+{
+
+/// @brief Queue with a maximum size, which may be closed by either side.
+template<typename T>
+class BoundedQueue
+{
+public:
+    BoundedQueue(std::size_t size)
+    : _size(std::max<std::size_t>(size, 1)), _closed(false)
+    {
+        // Nothing else.
+    }
+
+    /// @brief Wait for some room, return false if the queue was closed.
+    bool push(T && item)
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_not_full.wait(
+            lock,
+            [this]() {
+                return this->_closed || this->_items.size() < this->_size; });
+        if(this->_closed)
+        {
+            return false;
+        }
+        this->_items.push_back(std::move(item));
+        this->_not_empty.notify_one();
+        return true;
+    }
+
+    /// @brief Wait for an item, return false if the queue is closed and empty.
+    bool pop(T & item)
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_not_empty.wait(
+            lock,
+            [this]() { return this->_closed || !this->_items.empty(); });
+        if(this->_items.empty())
+        {
+            return false;
+        }
+        item = std::move(this->_items.front());
+        this->_items.pop_front();
+        this->_not_full.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_closed = true;
+        this->_not_full.notify_all();
+        this->_not_empty.notify_all();
+    }
+
+private:
+    std::size_t _size;
+    bool _closed;
+    std::deque<T> _items;
+    std::mutex _mutex;
+    std::condition_variable _not_full;
+    std::condition_variable _not_empty;
+};
+
+/// @brief Test whether a data set can be re-encoded from this transfer syntax.
+bool is_native(std::string const & transfer_syntax)
+{
+    return
+        transfer_syntax.empty()
+        || transfer_syntax == odil::registry::ImplicitVRLittleEndian
+        || transfer_syntax == odil::registry::ExplicitVRLittleEndian
+        || transfer_syntax == odil::registry::ExplicitVRBigEndian
+        || transfer_syntax == odil::registry::DeflatedExplicitVRLittleEndian;
+}
+
+/**
+ * @brief Return the group of an instance, given its SOP class and transfer
+ * syntax: the native instances of a SOP class share a presentation context,
+ * the encapsulated ones have one per transfer syntax.
+ */
+std::pair<std::string, std::string>
+get_group(std::pair<std::string, std::string> const & syntax)
+{
+    return {syntax.first, is_native(syntax.second)?"":syntax.second};
+}
+
+/// @brief Return the group of the instances of a presentation context.
+std::pair<std::string, std::string>
+get_group(
+    odil::AssociationParameters::PresentationContext const &
+        presentation_context)
+{
+    return get_group({
+        presentation_context.abstract_syntax,
+        presentation_context.transfer_syntaxes[0]});
+}
+
+}
+
+namespace odil
+{
+
+struct BatchStoreSCU::Instance
+{
+    std::size_t index;
+    std::shared_ptr<DataSet> data_set;
+    std::string transfer_syntax;
+    std::size_t bytes;
+    std::string error;
+};
+
+bool
+BatchStoreSCU::Result
+::is_success() const
+{
+    return this->error.empty() && !message::Response::is_failure(this->status);
+}
+
+double
+BatchStoreSCU::Statistics
+::get_instances_per_second() const
+{
+    return
+        (this->duration > 0)
+        ? (this->instances-this->failures)/this->duration : 0;
+}
+
+double
+BatchStoreSCU::Statistics
+::get_bytes_per_second() const
+{
+    return (this->duration > 0) ? this->bytes/this->duration : 0;
+}
+
+BatchStoreSCU
+::BatchStoreSCU(Association const & association)
+: _association(association), _associations_count(4), _loaders_count(2),
+  _prefetch_size(16)
+{
+    // Nothing else.
+}
+
+unsigned int
+BatchStoreSCU
+::get_associations_count() const
+{
+    return this->_associations_count;
+}
+
+void
+BatchStoreSCU
+::set_associations_count(unsigned int count)
+{
+    if(count == 0)
+    {
+        throw Exception("At least one association is required");
+    }
+    this->_associations_count = count;
+}
+
+unsigned int
+BatchStoreSCU
+::get_loaders_count() const
+{
+    return this->_loaders_count;
+}
+
+void
+BatchStoreSCU
+::set_loaders_count(unsigned int count)
+{
+    if(count == 0)
+    {
+        throw Exception("At least one loader is required");
+    }
+    this->_loaders_count = count;
+}
+
+std::size_t
+BatchStoreSCU
+::get_prefetch_size() const
+{
+    return this->_prefetch_size;
+}
+
+void
+BatchStoreSCU
+::set_prefetch_size(std::size_t size)
+{
+    this->_prefetch_size = size;
+}
+
+BatchStoreSCU::Statistics
+BatchStoreSCU
+::store(
+    std::vector<std::string> const & paths, Callback const & callback) const
+{
+    // Only read the beginning of the files to negotiate the presentation
+    // contexts.
+    std::vector<std::pair<std::string, std::string>> syntaxes;
+    syntaxes.reserve(paths.size());
+    for(auto const & path: paths)
+    {
+        try
+        {
+            auto const header_and_data_set = Reader::read_file(
+                path, false,
+                [](Tag const & tag) { return tag > registry::SOPClassUID; });
+            syntaxes.emplace_back(
+                header_and_data_set.second->as_string(registry::SOPClassUID, 0),
+                header_and_data_set.first->as_string(
+                    registry::TransferSyntaxUID, 0));
+        }
+        catch(std::exception const &)
+        {
+            // The error is reported when the file is loaded.
+            syntaxes.emplace_back("", "");
+        }
+    }
+
+    return this->_store(
+        syntaxes,
+        [&paths](Instance & instance)
+        {
+            auto const & path = paths[instance.index];
+            // The data set is released once stored: its pixel data is sent
+            // from the mapping without being copied.
+            instance.data_set = Reader::read_file(
+                path, false, [](Tag const &) { return false; }, false, {},
+                nullptr, true).second;
+            instance.bytes = boost::filesystem::file_size(path);
+        },
+        callback);
+}
+
+BatchStoreSCU::Statistics
+BatchStoreSCU
+::store(
+    std::vector<std::shared_ptr<DataSet>> const & data_sets,
+    Callback const & callback) const
+{
+    std::vector<std::pair<std::string, std::string>> syntaxes;
+    syntaxes.reserve(data_sets.size());
+    for(auto const & data_set: data_sets)
+    {
+        syntaxes.emplace_back(
+            data_set->as_string(registry::SOPClassUID, 0), "");
+    }
+
+    return this->_store(
+        syntaxes,
+        [&data_sets](Instance & instance)
+        {
+            instance.data_set = data_sets[instance.index];
+        },
+        callback);
+}
+
+BatchStoreSCU::Statistics
+BatchStoreSCU
+::_store(
+    std::vector<std::pair<std::string, std::string>> const & syntaxes,
+    Loader const & loader, Callback const & callback) const
+{
+    Statistics statistics{syntaxes.size(), 0, 0, 0.};
+    if(syntaxes.empty())
+    {
+        return statistics;
+    }
+
+    // Instances are stored with the parameter set of their group, the
+    // instances which could not be read with the first one.
+    auto const parameter_sets =
+        BatchStoreSCU::_get_presentation_contexts(syntaxes);
+    std::map<std::pair<std::string, std::string>, std::size_t> set_of_group;
+    for(std::size_t set=0; set<parameter_sets.size(); ++set)
+    {
+        for(auto const & presentation_context: parameter_sets[set])
+        {
+            set_of_group[get_group(presentation_context)] = set;
+        }
+    }
+    std::vector<std::vector<std::size_t>> indices(
+        std::max<std::size_t>(parameter_sets.size(), 1));
+    for(std::size_t index=0; index<syntaxes.size(); ++index)
+    {
+        auto const set_it = set_of_group.find(get_group(syntaxes[index]));
+        indices[(set_it != set_of_group.end())?set_it->second:0].push_back(
+            index);
+    }
+
+    std::mutex mutex;
+    std::vector<bool> reported(syntaxes.size(), false);
+    auto const report = [&](Result const & result, std::size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reported[result.index] = true;
+        statistics.bytes += bytes;
+        if(!result.is_success())
+        {
+            ++statistics.failures;
+        }
+        if(callback)
+        {
+            callback(result);
+        }
+    };
+
+    auto const begin = std::chrono::steady_clock::now();
+
+    for(std::size_t set=0; set<parameter_sets.size(); ++set)
+    {
+        this->_store(
+            indices[set], syntaxes, parameter_sets[set], loader, report);
+    }
+
+    // Instances left behind when all associations failed.
+    for(std::size_t index=0; index<reported.size(); ++index)
+    {
+        if(!reported[index])
+        {
+            report({index, "", 0, "No association available"}, 0);
+        }
+    }
+
+    statistics.duration = std::chrono::duration<double>(
+        std::chrono::steady_clock::now()-begin).count();
+    return statistics;
+}
+
+void
+BatchStoreSCU
+::_store(
+    std::vector<std::size_t> const & indices,
+    std::vector<std::pair<std::string, std::string>> const & syntaxes,
+    std::vector<AssociationParameters::PresentationContext> const &
+        presentation_contexts,
+    Loader const & loader, Reporter const & report) const
+{
+    if(indices.empty())
+    {
+        return;
+    }
+
+    BoundedQueue<Instance> queue(this->_prefetch_size);
+
+    // The last loader closes the queue so that the senders stop once it is
+    // empty; the last sender closes it so that the loaders do not wait for
+    // room forever.
+    std::atomic<std::size_t> next_index(0);
+    std::atomic<unsigned int> loaders(this->_loaders_count);
+    auto const load = [&]()
+    {
+        while(true)
+        {
+            auto const position = next_index++;
+            if(position >= indices.size())
+            {
+                break;
+            }
+            Instance instance{indices[position], nullptr, "", 0, ""};
+            instance.transfer_syntax = syntaxes[instance.index].second;
+            try
+            {
+                loader(instance);
+            }
+            catch(std::exception const & e)
+            {
+                instance.error = std::string("Cannot load: ")+e.what();
+            }
+            if(!queue.push(std::move(instance)))
+            {
+                break;
+            }
+        }
+        if(--loaders == 0)
+        {
+            queue.close();
+        }
+    };
+
+    std::atomic<unsigned int> senders(this->_associations_count);
+    auto const send = [&]()
+    {
+        Association association(this->_association);
+        association.update_parameters().set_presentation_contexts(
+            presentation_contexts);
+        try
+        {
+            association.associate();
+        }
+        catch(std::exception const & e)
+        {
+            ODIL_LOG(error) << "Cannot associate: " << e.what();
+            if(--senders == 0)
+            {
+                queue.close();
+            }
+            return;
+        }
+
+        // Accepted transfer syntax of each group.
+        std::map<std::pair<std::string, std::string>, std::string>
+            accepted_transfer_syntaxes;
+        for(auto const & presentation_context:
+            association.get_negotiated_parameters().get_presentation_contexts())
+        {
+            if(
+                presentation_context.result
+                == AssociationParameters::PresentationContext::Result::Acceptance)
+            {
+                accepted_transfer_syntaxes[get_group(presentation_context)] =
+                    presentation_context.transfer_syntaxes[0];
+            }
+        }
+
+        // The instances are stored with pipelined requests; the sent ones are
+        // kept until their response is received. The same data set may be
+        // sent several times in a batch of data sets.
+        std::multimap<DataSet const *, Instance> outstanding;
+        auto const source = [&]() -> std::shared_ptr<DataSet>
+        {
+            Instance instance;
+            while(queue.pop(instance))
+            {
+                Result result{instance.index, "", 0, instance.error};
+                if(result.error.empty())
+                {
+                    try
+                    {
+                        auto const data_set = instance.data_set;
+                        auto const & sop_class = data_set->as_string(
+                            registry::SOPClassUID, 0);
+                        result.sop_instance_uid = data_set->as_string(
+                            registry::SOPInstanceUID, 0);
+
+                        // Native instances are re-encoded to the accepted
+                        // syntax, encapsulated pixel data cannot be
+                        // transcoded.
+                        auto const group =
+                            get_group({sop_class, instance.transfer_syntax});
+                        if(!accepted_transfer_syntaxes.count(group))
+                        {
+                            auto const sop_class_it =
+                                accepted_transfer_syntaxes.lower_bound(
+                                    {sop_class, ""});
+                            if(
+                                sop_class_it == accepted_transfer_syntaxes.end()
+                                || sop_class_it->first.first != sop_class)
+                            {
+                                throw Exception(
+                                    "SOP class not accepted by peer");
+                            }
+                            throw Exception(
+                                "Transfer syntax not accepted by peer: "
+                                +instance.transfer_syntax);
+                        }
+
+                        outstanding.emplace(data_set.get(), std::move(instance));
+                        return data_set;
+                    }
+                    catch(std::exception const & e)
+                    {
+                        result.error = e.what();
+                    }
+                }
+                report(result, 0);
+
+                // Release the data set before waiting for the next one.
+                instance = Instance();
+            }
+            return nullptr;
+        };
+
+        // Only the stored instances account for the transferred bytes.
+        auto const stored = [&](
+            std::shared_ptr<DataSet const> data_set,
+            std::shared_ptr<message::CStoreResponse const> response)
+        {
+            auto const instance_it = outstanding.find(data_set.get());
+            Result const result{
+                instance_it->second.index,
+                data_set->as_string(registry::SOPInstanceUID, 0),
+                response->get_status(), ""};
+            report(result, result.is_success()?instance_it->second.bytes:0);
+            outstanding.erase(instance_it);
+        };
+
+        StoreSCU scu(association);
+        try
+        {
+            scu.store(source, stored);
+        }
+        catch(std::exception const & e)
+        {
+            // The outstanding requests will not get a response: stop using
+            // this association, the other ones keep on storing the batch.
+            for(auto const & item: outstanding)
+            {
+                auto const & instance = item.second;
+                report(
+                    {
+                        instance.index,
+                        instance.data_set->as_string(
+                            registry::SOPInstanceUID, 0),
+                        0, e.what()},
+                    0);
+            }
+            outstanding.clear();
+            if(association.is_associated())
+            {
+                try
+                {
+                    association.abort(0, 0);
+                }
+                catch(std::exception const & e)
+                {
+                    ODIL_LOG(warning)
+                        << "Cannot abort association: " << e.what();
+                }
+            }
+        }
+
+        if(association.is_associated())
+        {
+            try
+            {
+                association.release();
+            }
+            catch(std::exception const & e)
+            {
+                ODIL_LOG(warning) << "Cannot release association: " << e.what();
+            }
+        }
+        if(--senders == 0)
+        {
+            queue.close();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned int i=0; i<this->_loaders_count; ++i)
+    {
+        threads.emplace_back(load);
+    }
+    for(unsigned int i=0; i<this->_associations_count; ++i)
+    {
+        threads.emplace_back(send);
+    }
+    for(auto & thread: threads)
+    {
+        thread.join();
+    }
+}
+
+std::vector<std::vector<AssociationParameters::PresentationContext>>
+BatchStoreSCU
+::_get_presentation_contexts(
+    std::vector<std::pair<std::string, std::string>> const & syntaxes)
+{
+    // One context per SOP class for its native instances, which may be
+    // re-encoded, and one per SOP class and encapsulated transfer syntax,
+    // whose instances can only be sent as they are.
+    std::set<std::pair<std::string, std::string>> groups;
+    for(auto const & syntax: syntaxes)
+    {
+        if(!syntax.first.empty())
+        {
+            groups.insert(get_group(syntax));
+        }
+    }
+
+    // An association has at most 128 presentation contexts: split the batch
+    // into several parameter sets beyond that.
+    std::vector<std::vector<AssociationParameters::PresentationContext>>
+        parameter_sets;
+    for(auto const & group: groups)
+    {
+        if(parameter_sets.empty() || parameter_sets.back().size() == 128)
+        {
+            parameter_sets.emplace_back();
+        }
+        auto & presentation_contexts = parameter_sets.back();
+        uint8_t const id = 2*presentation_contexts.size()+1;
+        presentation_contexts.emplace_back(
+            id, group.first,
+            group.second.empty()
+                ? std::vector<std::string>{
+                    registry::ExplicitVRLittleEndian,
+                    registry::ImplicitVRLittleEndian }
+                : std::vector<std::string>{ group.second },
+            AssociationParameters::PresentationContext::Role::SCU);
+    }
+    return parameter_sets;
+}
+
+}
@@ -0,0 +1,183 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _30629407_c534_47df_89cc_80af192aa305
+#define _30629407_c534_47df_89cc_80af192aa305
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "odil/Association.h"
+#include "odil/AssociationParameters.h"
+#include "odil/DataSet.h"
+#include "odil/odil.h"
+#include "odil/Value.h"
+
+namespace odil
+{
+
+/**
+ * @brief Store a batch of instances over several parallel associations with
+ * the same peer.
+ *
+ * The presentation contexts are negotiated once for the whole batch, from the
+ * SOP classes and transfer syntaxes of the instances. Files are loaded ahead
+ * of the network by loader threads, and each association is run by its own
+ * thread, which encodes the data sets while they are sent. The requests of an
+ * association are pipelined by StoreSCU within the asynchronous operations
+ * window negotiated from the parameters of the association.
+ *
+ * The native instances of a SOP class share a presentation context, and are
+ * re-encoded to its accepted transfer syntax. The encapsulated instances are
+ * sent as they are, on a presentation context proposed for their SOP class
+ * and transfer syntax. If the batch requires more than the 128 presentation
+ * contexts of an association, its instances are sent in turn on associations
+ * negotiating different parameter sets.
+ */
+class ODIL_API BatchStoreSCU
+{
+public:
+    /// @brief Outcome of the storage of an instance.
+    struct ODIL_API Result
+    {
+        /// @brief Position of the instance in the batch.
+        std::size_t index;
+
+        /// @brief SOP Instance UID, empty if the instance could not be loaded.
+        std::string sop_instance_uid;
+
+        /// @brief Status of the C-STORE response, only valid without error.
+        Value::Integer status;
+
+        /// @brief Reason why no response was received, empty on success.
+        std::string error;
+
+        /// @brief Test whether the instance was stored, possibly with a warning.
+        bool is_success() const;
+    };
+
+    /// @brief Aggregate figures of a batch.
+    struct ODIL_API Statistics
+    {
+        /// @brief Number of instances in the batch.
+        std::size_t instances;
+
+        /// @brief Number of instances which were not stored.
+        std::size_t failures;
+
+        /**
+         * @brief Size of the files which were stored, 0 for in-memory data
+         * sets.
+         */
+        std::size_t bytes;
+
+        /// @brief Duration of the transfer, in seconds.
+        double duration;
+
+        /// @brief Return the number of instances stored per second.
+        double get_instances_per_second() const;
+
+        /// @brief Return the number of bytes stored per second.
+        double get_bytes_per_second() const;
+    };
+
+    /**
+     * @brief Callback called once per instance. The calls are serialized, but
+     * are run by the threads of the associations.
+     */
+    typedef std::function<void(Result const &)> Callback;
+
+    /**
+     * @brief Create a batch sender; the peer, the AE titles and the other
+     * association parameters are taken from the given association, except
+     * for the presentation contexts.
+     */
+    BatchStoreSCU(Association const & association);
+
+    /// @brief Return the number of parallel associations, default to 4.
+    unsigned int get_associations_count() const;
+
+    /// @brief Set the number of parallel associations.
+    void set_associations_count(unsigned int count);
+
+    /// @brief Return the number of loader threads, default to 2.
+    unsigned int get_loaders_count() const;
+
+    /// @brief Set the number of loader threads.
+    void set_loaders_count(unsigned int count);
+
+    /**
+     * @brief Return the number of loaded instances which may wait for an
+     * association, default to 16.
+     */
+    std::size_t get_prefetch_size() const;
+
+    /// @brief Set the number of loaded instances which may wait.
+    void set_prefetch_size(std::size_t size);
+
+    /// @brief Store the instances of the given files.
+    Statistics store(
+        std::vector<std::string> const & paths,
+        Callback const & callback=Callback()) const;
+
+    /// @brief Store the given data sets.
+    Statistics store(
+        std::vector<std::shared_ptr<DataSet>> const & data_sets,
+        Callback const & callback=Callback()) const;
+
+private:
+    /// @brief Instance ready to be sent.
+    struct Instance;
+
+    /// @brief Load the instance at an index of the batch.
+    typedef std::function<void(Instance &)> Loader;
+
+    /// @brief Report the outcome of an instance and the size of its file.
+    typedef std::function<void(Result const &, std::size_t)> Reporter;
+
+    Association _association;
+    unsigned int _associations_count;
+    unsigned int _loaders_count;
+    std::size_t _prefetch_size;
+
+    /**
+     * @brief Store the instances of the batch, given their SOP class and
+     * their original transfer syntax (empty if any transfer syntax is
+     * suitable).
+     */
+    Statistics _store(
+        std::vector<std::pair<std::string, std::string>> const & syntaxes,
+        Loader const & loader, Callback const & callback) const;
+
+    /**
+     * @brief Store the instances at the given indices of the batch on
+     * associations negotiating the given presentation contexts.
+     */
+    void _store(
+        std::vector<std::size_t> const & indices,
+        std::vector<std::pair<std::string, std::string>> const & syntaxes,
+        std::vector<AssociationParameters::PresentationContext> const &
+            presentation_contexts,
+        Loader const & loader, Reporter const & report) const;
+
+    /**
+     * @brief Return the presentation contexts of the batch, split in sets
+     * which fit in an association.
+     */
+    static std::vector<std::vector<AssociationParameters::PresentationContext>>
+    _get_presentation_contexts(
+        std::vector<std::pair<std::string, std::string>> const & syntaxes);
+};
+
+}
+
+#endif // _30629407_c534_47df_89cc_80af192aa305
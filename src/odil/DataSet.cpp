@@ -9,59 +9,111 @@
 #include "odil/DataSet.h"
 
 #include <cstddef>
+#include <algorithm>
 #include <cstdint>
-#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <boost/container/pmr/global_resource.hpp>
+
 #include "odil/Exception.h"
 #include "odil/Tag.h"
 #include "odil/VR.h"
 
+namespace
+{
+
+/// @brief Comparator of elements and tags for binary searches.
+bool is_before(
+    std::pair<odil::Tag, odil::Element> const & item, odil::Tag const & tag)
+{
+    return item.first < tag;
+}
+
+/// @brief Comparator of elements for sorting.
+bool has_lower_tag(
+    std::pair<odil::Tag, odil::Element> const & left,
+    std::pair<odil::Tag, odil::Element> const & right)
+{
+    return left.first < right.first;
+}
+
+}
+
 namespace odil
 {
 
 DataSet
-::DataSet(std::string const & transfer_syntax)
-: _transfer_syntax(transfer_syntax)
+::DataSet(
+    std::string const & transfer_syntax, MemoryResource * memory_resource)
+: _elements(
+    memory_resource?memory_resource
+    :boost::container::pmr::get_default_resource()),
+    _transfer_syntax(transfer_syntax)
+{
+    // Nothing else.
+}
+
+DataSet::SortedState
+::SortedState()
+: size(0), sorted(true)
+{
+    // Nothing else.
+}
+
+DataSet::SortedState
+::SortedState(SortedState const & other)
+: size(other.size), sorted(other.sorted.load())
 {
     // Nothing else.
 }
 
+DataSet::SortedState
+::SortedState(SortedState && other)
+: size(other.size), sorted(other.sorted.load())
+{
+    // The moved-from elements, if any, are sorted again on their next access.
+    other.size = 0;
+    other.sorted = false;
+}
+
+DataSet::SortedState &
+DataSet::SortedState
+::operator=(SortedState const & other)
+{
+    this->size = other.size;
+    this->sorted = other.sorted.load();
+    return *this;
+}
+
+DataSet::SortedState &
+DataSet::SortedState
+::operator=(SortedState && other)
+{
+    if(this != &other)
+    {
+        this->size = other.size;
+        this->sorted = other.sorted.load();
+        other.size = 0;
+        other.sorted = false;
+    }
+    return *this;
+}
+
 void
 DataSet
 ::add(Tag const & tag, Element const & element)
 {
-    auto const iterator = this->_elements.find(tag);
-    if(iterator == this->_elements.end())
-    {
-        // WARNING: std::map<K,V>::emplace does not exist on old compilers.
-        // This is however a case of non-mandatory copy elision, so the copy
-        // constructor of element should only be called once.
-        this->_elements.insert(std::make_pair(tag, element));
-        //this->_elements.emplace(tag, element);
-    }
-    else
-    {
-        iterator->second = element;
-    }
+    this->_add(tag, element);
 }
 
 void
 DataSet
 ::add(Tag const & tag, Element && element)
 {
-    auto const iterator = this->_elements.find(tag);
-    if(iterator == this->_elements.end())
-    {
-        // WARNING: std::map<K,V>::emplace does not exist on old compilers.
-        this->_elements.insert(std::make_pair(tag, std::move(element)));
-        //this->_elements.emplace(tag, std::move(element));
-    }
-    else
-    {
-        iterator->second = element;
-    }
+    this->_add(tag, std::move(element));
 }
 
 void
@@ -156,7 +208,8 @@ DataSet
         throw Exception("No such element " + std::string( tag ));
     }
 
-    this->_elements.erase(tag);
+    this->_elements.erase(this->_find(tag));
+    --this->_sorted_state.size;
 }
 
 bool
@@ -170,6 +223,8 @@ std::size_t
 DataSet
 ::size() const
 {
+    // Elements added out of order may replace other ones.
+    this->_sort();
     return this->_elements.size();
 }
 
@@ -177,7 +232,7 @@ Element const &
 DataSet
 ::operator[](Tag const & tag) const
 {
-    ElementMap::const_iterator const it = this->_elements.find(tag);
+    auto const it = this->_find(tag);
     if(it == this->_elements.end())
     {
         throw Exception("No such element " + std::string( tag ));
@@ -190,7 +245,7 @@ Element &
 DataSet
 ::operator[](Tag const & tag)
 {
-    ElementMap::iterator it = this->_elements.find(tag);
+    auto const it = this->_find(tag);
     if(it == this->_elements.end())
     {
         throw Exception("No such element " + std::string( tag ));
@@ -354,14 +409,14 @@ bool
 DataSet
 ::has(Tag const & tag) const
 {
-    return (this->_elements.find(tag) != this->_elements.end());
+    return (this->_find(tag) != this->_elements.end());
 }
 
 VR
 DataSet
 ::get_vr(Tag const & tag) const
 {
-    ElementMap::const_iterator const it = this->_elements.find(tag);
+    auto const it = this->_find(tag);
     if(it == this->_elements.end())
     {
         throw Exception("No such element "+  std::string(tag) );
@@ -374,7 +429,7 @@ bool
 DataSet
 ::empty(Tag const & tag) const
 {
-    ElementMap::const_iterator const it = this->_elements.find(tag);
+    auto const it = this->_find(tag);
     if(it == this->_elements.end())
     {
         throw Exception("No such element " + std::string( tag ) );
@@ -387,7 +442,7 @@ std::size_t
 DataSet
 ::size(Tag const & tag) const
 {
-    ElementMap::const_iterator const it = this->_elements.find(tag);
+    auto const it = this->_find(tag);
     if(it == this->_elements.end())
     {
         throw Exception("No such element " + std::string( tag ));
@@ -400,6 +455,7 @@ DataSet::const_iterator
 DataSet
 ::begin() const
 {
+    this->_sort();
     return this->_elements.begin();
 }
 
@@ -407,6 +463,7 @@ DataSet::const_iterator
 DataSet
 ::end() const
 {
+    this->_sort();
     return this->_elements.end();
 }
 
@@ -414,6 +471,8 @@ bool
 DataSet
 ::operator==(DataSet const & other) const
 {
+    this->_sort();
+    other._sort();
     return (this->_elements == other._elements);
 }
 
@@ -429,13 +488,15 @@ DataSet
 ::clear()
 {
     this->_elements.clear();
+    this->_sorted_state.size = 0;
+    this->_sorted_state.sorted = true;
 }
 
 void
 DataSet
 ::clear(Tag const & tag)
 {
-    ElementMap::iterator const it = this->_elements.find(tag);
+    auto const it = this->_find(tag);
     if(it == this->_elements.end())
     {
         throw Exception("No such element: "+std::string(tag));
@@ -444,6 +505,105 @@ DataSet
     it->second.clear();
 }
 
+DataSet::ElementContainer::const_iterator
+DataSet
+::_find(Tag const & tag) const
+{
+    this->_sort();
+    auto const it = std::lower_bound(
+        this->_elements.begin(), this->_elements.end(), tag, is_before);
+    return
+        (it != this->_elements.end() && it->first == tag)
+        ?it:this->_elements.end();
+}
+
+DataSet::ElementContainer::iterator
+DataSet
+::_find(Tag const & tag)
+{
+    this->_sort();
+    auto const it = std::lower_bound(
+        this->_elements.begin(), this->_elements.end(), tag, is_before);
+    return
+        (it != this->_elements.end() && it->first == tag)
+        ?it:this->_elements.end();
+}
+
+template<typename TElement>
+void
+DataSet
+::_add(Tag const & tag, TElement && element)
+{
+    auto & state = this->_sorted_state;
+    if(state.sorted)
+    {
+        // Fast path: elements are usually added in ascending order.
+        if(this->_elements.empty() || this->_elements.back().first < tag)
+        {
+            this->_elements.emplace_back(tag, std::forward<TElement>(element));
+            ++state.size;
+            return;
+        }
+
+        auto const it = std::lower_bound(
+            this->_elements.begin(), this->_elements.end(), tag, is_before);
+        if(it != this->_elements.end() && it->first == tag)
+        {
+            it->second = std::forward<TElement>(element);
+            return;
+        }
+    }
+
+    // Inserting in the middle of the vector would be quadratic when adding
+    // many elements out of order: sort them on the next access instead.
+    this->_elements.emplace_back(tag, std::forward<TElement>(element));
+    state.sorted = false;
+}
+
+void
+DataSet
+::_sort() const
+{
+    auto & state = this->_sorted_state;
+    if(state.sorted)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if(state.sorted)
+    {
+        return;
+    }
+
+    // Both sorts are stable: the elements with the same tag stay in order of
+    // addition, and the last one is kept.
+    auto const middle = this->_elements.begin()+state.size;
+    std::stable_sort(middle, this->_elements.end(), has_lower_tag);
+    std::inplace_merge(
+        this->_elements.begin(), middle, this->_elements.end(),
+        has_lower_tag);
+
+    auto destination = this->_elements.begin();
+    for(auto it = this->_elements.begin(); it != this->_elements.end(); ++it)
+    {
+        auto const next = it+1;
+        if(next != this->_elements.end() && next->first == it->first)
+        {
+            continue;
+        }
+        if(destination != it)
+        {
+            *destination = std::move(*it);
+        }
+        ++destination;
+    }
+    this->_elements.erase(destination, this->_elements.end());
+
+    state.size = this->_elements.size();
+    state.sorted = true;
+}
+
 std::string const &
 DataSet
 ::get_transfer_syntax() const
@@ -458,4 +618,11 @@ DataSet
     this->_transfer_syntax = transfer_syntax;
 }
 
+DataSet::MemoryResource *
+DataSet
+::get_memory_resource() const
+{
+    return this->_elements.get_allocator().resource();
+}
+
 }
@@ -9,13 +9,18 @@
 #ifndef _8424446e_1153_4acc_9f57_e86faa7246e3
 #define _8424446e_1153_4acc_9f57_e86faa7246e3
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
-#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <boost/container/pmr/memory_resource.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+
 #include "odil/Element.h"
 #include "odil/odil.h"
 #include "odil/Value.h"
@@ -25,12 +30,28 @@ namespace odil
 
 /**
  * @brief DICOM Data set.
+ *
+ * The elements are stored in a vector sorted by tag. Adding or removing an
+ * element invalidates all iterators and all references to elements and to
+ * their values, including those returned by operator[] and the as_*
+ * accessors. Elements added out of order are sorted on the next access.
  */
 class ODIL_API DataSet
 {
 public:
-    /// @brief Create an empty data set.
-    explicit DataSet(std::string const & transfer_syntax="");
+    /// @brief Source of memory for the data set and its elements.
+    typedef boost::container::pmr::memory_resource MemoryResource;
+
+    /**
+     * @brief Create an empty data set.
+     *
+     * The storage of the elements is allocated from the given memory
+     * resource, or from the default resource if null. The resource must
+     * outlive the data set. Copies of the data set use the default resource.
+     */
+    explicit DataSet(
+        std::string const & transfer_syntax="",
+        MemoryResource * memory_resource=nullptr);
 
     /** @addtogroup default_operations Default class operations
      * @{
@@ -42,13 +63,17 @@ public:
     DataSet & operator=(DataSet &&) =default;
     /// @}
 
-    /// @brief Add an element to the dataset.
+    /**
+     * @brief Add an element to the dataset, replacing an existing element
+     * with the same tag. All iterators and references to elements are
+     * invalidated.
+     */
     void add(Tag const & tag, Element const & element);
 
-    /// @brief Add an element to the dataset.
+    /// @brief Add an element to the dataset, cf. above.
     void add(Tag const & tag, Element && element);
 
-    /// @brief Add an empty element to the dataset.
+    /// @brief Add an empty element to the dataset, cf. above.
     void add(Tag const & tag, VR vr=VR::UNKNOWN);
 
 #define ODIL_DATASET_ADD(type) \
@@ -72,19 +97,20 @@ public:
     ODIL_DATASET_ADD(Binary)
 #undef ODIL_DATASET_ADD
 
-    /// @brief Add an element to the dataset.
+    /// @brief Add an element to the dataset, cf. above.
     void add(
         Tag const & tag, std::initializer_list<int> const & value,
         VR vr=VR::UNKNOWN);
 
-    /// @brief Add an element to the dataset.
+    /// @brief Add an element to the dataset, cf. above.
     void add(
         Tag const & tag,
         std::initializer_list<std::initializer_list<uint8_t>> const & value,
         VR vr=VR::UNKNOWN);
 
     /**
-     * @brief Remove an element from the data set.
+     * @brief Remove an element from the data set. All iterators and
+     * references to elements are invalidated.
      *
      * If the element is not in the data set, a odil::Exception is raised.
      */
@@ -121,14 +147,16 @@ public:
     std::size_t size(Tag const & tag) const;
 
     /**
-     * @brief Access the given element.
+     * @brief Access the given element. The reference is valid until an
+     * element is added to or removed from the data set.
      *
      * If the element is not in the data set, a odil::Exception is raised.
      */
     Element const & operator[](Tag const & tag) const;
 
     /**
-     * @brief Access the given element.
+     * @brief Access the given element. The reference is valid until an
+     * element is added to or removed from the data set.
      *
      * If the element is not in the data set, a odil::Exception is raised.
      */
@@ -196,8 +224,15 @@ public:
     Value::Binary::value_type const &
     as_binary(Tag const & tag, unsigned int position) const;
 
-    /// @brief Iterator to the elements.
-    typedef std::map<Tag, Element>::const_iterator const_iterator;
+    /**
+     * @brief Iterator to the elements, in ascending order of tags, valid
+     * until an element is added to or removed from the data set.
+     */
+    typedef std::vector<
+            std::pair<Tag, Element>,
+            boost::container::pmr::polymorphic_allocator<
+                std::pair<Tag, Element>>
+        >::const_iterator const_iterator;
 
     /// @brief Return an iterator to the start of the elements.
     const_iterator begin() const;
@@ -226,10 +261,55 @@ public:
     /// @brief Set the current transfer syntax.
     void set_transfer_syntax(std::string const & transfer_syntax);
 
+    /// @brief Return the memory resource of the elements.
+    MemoryResource * get_memory_resource() const;
+
 private:
-    typedef std::map<Tag, Element> ElementMap;
+    /**
+     * @brief Elements sorted by tag: lookups are binary searches, and elements
+     * added in ascending order (e.g. by Reader) are appended.
+     */
+    typedef std::vector<
+            std::pair<Tag, Element>,
+            boost::container::pmr::polymorphic_allocator<
+                std::pair<Tag, Element>>
+        > ElementContainer;
+
+    /**
+     * @brief Number of sorted elements at the start of the container, the
+     * other ones being in order of addition, and lock of their sorting.
+     */
+    struct SortedState
+    {
+        std::size_t size;
+        std::atomic<bool> sorted;
+        std::mutex mutex;
+
+        SortedState();
+        SortedState(SortedState const & other);
+        SortedState(SortedState && other);
+        SortedState & operator=(SortedState const & other);
+        SortedState & operator=(SortedState && other);
+    };
+
+    mutable ElementContainer _elements;
+    mutable SortedState _sorted_state;
+
+    /**
+     * @brief Sort the elements added out of order, keeping the last one
+     * added for each tag. Concurrent calls are safe.
+     */
+    void _sort() const;
+
+    /// @brief Return the position of an element, or end() if not found.
+    ElementContainer::const_iterator _find(Tag const & tag) const;
+
+    /// @brief Return the position of an element, or end() if not found.
+    ElementContainer::iterator _find(Tag const & tag);
 
-    ElementMap _elements;
+    /// @brief Add an element or replace an existing one.
+    template<typename TElement>
+    void _add(Tag const & tag, TElement && element);
 
     /// @brief Current transfer syntax.
     std::string _transfer_syntax;
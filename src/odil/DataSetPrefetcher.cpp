@@ -0,0 +1,163 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/DataSetPrefetcher.h"
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "odil/DataSet.h"
+#include "odil/SCP.h"
+
+namespace odil
+{
+
+DataSetPrefetcher
+::DataSetPrefetcher(
+    std::shared_ptr<SCP::DataSetGenerator> generator, std::size_t size)
+: _generator(generator), _size(size), _started(false), _done(false),
+  _stopped(false)
+{
+    if(this->_size != 0)
+    {
+        this->_thread = std::thread(&DataSetPrefetcher::_run, this);
+    }
+}
+
+DataSetPrefetcher
+::~DataSetPrefetcher()
+{
+    if(this->_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_stopped = true;
+        }
+        this->_condition.notify_all();
+        this->_thread.join();
+    }
+}
+
+std::shared_ptr<DataSet>
+DataSetPrefetcher
+::get()
+{
+    std::unique_lock<std::mutex> lock(this->_mutex);
+
+    if(this->_size == 0)
+    {
+        // Synchronous mode: the lock serializes the calls to the generator.
+        if(this->_done)
+        {
+            return nullptr;
+        }
+        try
+        {
+            if(this->_started)
+            {
+                this->_generator->next();
+            }
+            this->_started = true;
+            if(this->_generator->done())
+            {
+                this->_done = true;
+                return nullptr;
+            }
+            return this->_generator->get();
+        }
+        catch(...)
+        {
+            // Other consumers must not call the generator anymore.
+            this->_done = true;
+            throw;
+        }
+    }
+
+    this->_condition.wait(
+        lock, [this]() { return this->_done || !this->_data_sets.empty(); });
+    if(!this->_data_sets.empty())
+    {
+        auto const data_set = this->_data_sets.front();
+        this->_data_sets.pop_front();
+        lock.unlock();
+        this->_condition.notify_all();
+        return data_set;
+    }
+    else if(this->_error)
+    {
+        std::rethrow_exception(this->_error);
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+
+void
+DataSetPrefetcher
+::_run()
+{
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_condition.wait(
+                lock,
+                [this]()
+                {
+                    return
+                        this->_stopped
+                        || this->_data_sets.size() < this->_size;
+                });
+            if(this->_stopped)
+            {
+                return;
+            }
+        }
+
+        // Only this thread calls the generator: run it without the lock.
+        std::shared_ptr<DataSet> data_set;
+        std::exception_ptr error;
+        try
+        {
+            if(!this->_generator->done())
+            {
+                data_set = this->_generator->get();
+                this->_generator->next();
+            }
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if(data_set)
+            {
+                this->_data_sets.push_back(data_set);
+            }
+            if(!data_set || error)
+            {
+                this->_error = error;
+                this->_done = true;
+            }
+        }
+        this->_condition.notify_all();
+
+        if(!data_set || error)
+        {
+            return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,79 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _8b59aae5_824f_46be_abce_5a4cdeb0748a
+#define _8b59aae5_824f_46be_abce_5a4cdeb0748a
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "odil/DataSet.h"
+#include "odil/odil.h"
+#include "odil/SCP.h"
+
+namespace odil
+{
+
+/**
+ * @brief Thread-safe source of the data sets of an initialized generator,
+ * used by the sub-operations of C-GET and C-MOVE.
+ *
+ * With a non-zero size, a background thread reads ahead of the consumers, so
+ * that the generator (usually reading files) and the network run in
+ * parallel; the generator must then not modify in next() the data sets it
+ * has returned. With a size of 0, the generator is called by the consumers,
+ * and next() is only called when the following data set is requested.
+ *
+ * In both cases, the generator is never called concurrently.
+ */
+class ODIL_API DataSetPrefetcher
+{
+public:
+    /// @brief Create a prefetcher, keeping at most size data sets in advance.
+    DataSetPrefetcher(
+        std::shared_ptr<SCP::DataSetGenerator> generator, std::size_t size);
+
+    /// @brief Stop the background thread.
+    ~DataSetPrefetcher();
+
+    DataSetPrefetcher(DataSetPrefetcher const &) = delete;
+    DataSetPrefetcher & operator=(DataSetPrefetcher const &) = delete;
+
+    /**
+     * @brief Return the next data set, or nullptr once the generator is done;
+     * the errors of the generator are re-thrown here, after the data sets
+     * generated before them.
+     */
+    std::shared_ptr<DataSet> get();
+
+private:
+    std::shared_ptr<SCP::DataSetGenerator> _generator;
+    std::size_t _size;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::shared_ptr<DataSet>> _data_sets;
+    bool _started;
+    bool _done;
+    bool _stopped;
+    std::exception_ptr _error;
+
+    std::thread _thread;
+
+    /// @brief Fill the queue from the generator, in the background thread.
+    void _run();
+};
+
+}
+
+#endif // _8b59aae5_824f_46be_abce_5a4cdeb0748a
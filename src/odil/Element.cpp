@@ -9,6 +9,8 @@
 #include "odil/Element.h"
 
 #include <initializer_list>
+#include <memory>
+#include <mutex>
 #include <utility>
 
 #include "odil/Exception.h"
@@ -110,32 +112,39 @@ Element
     // Nothing else
 }
 
+Element
+::Element(std::shared_ptr<EncodedValue const> encoded_value, VR const & vr)
+: Element(vr)
+{
+    this->_lazy_value = std::make_shared<LazyValue>(encoded_value);
+}
+
 bool
 Element
 ::empty() const
 {
-    return this->_value.empty();
+    return this->_decode().empty();
 }
 
 std::size_t
 Element
 ::size() const
 {
-    return this->_value.size();
+    return this->_decode().size();
 }
 
 Value &
 Element
 ::get_value()
 {
-    return this->_value;
+    return this->_get_mutable_value();
 }
 
 Value const &
 Element
 ::get_value() const
 {
-    return this->_value;
+    return this->_decode();
 }
 
 bool
@@ -149,14 +158,14 @@ Value::Integers const &
 Element
 ::as_int() const
 {
-    return this->_value.as_integers();
+    return this->_decode().as_integers();
 }
 
 Value::Integers &
 Element
 ::as_int()
 {
-    return this->_value.as_integers();
+    return this->_get_mutable_value().as_integers();
 }
 
 bool
@@ -170,14 +179,14 @@ Value::Reals const &
 Element
 ::as_real() const
 {
-    return this->_value.as_reals();
+    return this->_decode().as_reals();
 }
 
 Value::Reals &
 Element
 ::as_real()
 {
-    return this->_value.as_reals();
+    return this->_get_mutable_value().as_reals();
 }
 
 bool
@@ -191,14 +200,14 @@ Value::Strings const &
 Element
 ::as_string() const
 {
-    return this->_value.as_strings();
+    return this->_decode().as_strings();
 }
 
 Value::Strings &
 Element
 ::as_string()
 {
-    return this->_value.as_strings();
+    return this->_get_mutable_value().as_strings();
 }
 
 bool
@@ -212,13 +221,13 @@ Value::DataSets const &
 Element
 ::as_data_set() const
 {
-    return this->_value.as_data_sets();
+    return this->_decode().as_data_sets();
 }
 
 Value::DataSets &
 Element::as_data_set()
 {
-    return this->_value.as_data_sets();
+    return this->_get_mutable_value().as_data_sets();
 }
 
 bool
@@ -232,20 +241,20 @@ Value::Binary const &
 Element
 ::as_binary() const
 {
-    return this->_value.as_binary();
+    return this->_decode().as_binary();
 }
 
 Value::Binary &
 Element::as_binary()
 {
-    return this->_value.as_binary();
+    return this->_get_mutable_value().as_binary();
 }
 
 bool
 Element
 ::operator==(Element const & other) const
 {
-    return (this->vr == other.vr) && (this->_value == other._value);
+    return (this->vr == other.vr) && (this->_decode() == other._decode());
 }
 
 bool
@@ -259,7 +268,65 @@ void
 Element
 ::clear()
 {
-    this->_value.clear();
+    this->_get_mutable_value().clear();
+}
+
+std::shared_ptr<Element::EncodedValue const> const &
+Element
+::get_encoded_value() const
+{
+    static std::shared_ptr<EncodedValue const> const none;
+    return this->_lazy_value?this->_lazy_value->encoded_value:none;
+}
+
+Element::LazyValue
+::LazyValue(std::shared_ptr<EncodedValue const> encoded_value)
+: encoded_value(encoded_value), value(Value::Integers())
+{
+    // Nothing else
+}
+
+Value const &
+Element
+::_decode() const
+{
+    if(!this->_lazy_value)
+    {
+        return this->_value;
+    }
+
+    auto & lazy_value = *this->_lazy_value;
+    std::call_once(
+        lazy_value.decoded,
+        [&]()
+        {
+            auto const & encoded_value = *lazy_value.encoded_value;
+            lazy_value.value = (*encoded_value.decoder)(
+                this->vr, encoded_value);
+        });
+    return lazy_value.value;
+}
+
+Value &
+Element
+::_get_mutable_value()
+{
+    if(this->_lazy_value)
+    {
+        // The value may be modified: the encoded value is no longer valid,
+        // and the decoded value may be shared with other copies.
+        this->_decode();
+        if(this->_lazy_value.use_count() == 1)
+        {
+            this->_value = std::move(this->_lazy_value->value);
+        }
+        else
+        {
+            this->_value = this->_lazy_value->value;
+        }
+        this->_lazy_value = nullptr;
+    }
+    return this->_value;
 }
 
 }
@@ -10,8 +10,13 @@
 #define _9c3d8f32_0310_4e3a_b5d2_6d69f229a2cf
 
 #include <cstddef>
+#include <functional>
 #include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
 
+#include "odil/endian.h"
 #include "odil/odil.h"
 #include "odil/Tag.h"
 #include "odil/Value.h"
@@ -27,6 +32,43 @@ class ODIL_API Element
 {
 public:
 
+    /**
+     * @brief Value as stored in a stream, decoded on the first access to the
+     * element, cf. Reader::lazy_decoding.
+     */
+    struct EncodedValue
+    {
+        /// @brief Function decoding the value.
+        typedef std::function<Value(VR, EncodedValue const &)> Decoder;
+
+        /**
+         * @brief Memory holding the value, shared by all values read from
+         * the same buffer.
+         */
+        std::shared_ptr<char const> buffer;
+
+        /// @brief Position of the value in the buffer.
+        std::size_t offset;
+
+        /**
+         * @brief Size of the value, including the delimitation items when
+         * the length is undefined.
+         */
+        std::size_t length;
+
+        /// @brief Whether the value was stored with an undefined length.
+        bool undefined_length;
+
+        /// @brief Byte ordering of the data.
+        ByteOrdering byte_ordering;
+
+        /// @brief Decoder of the data, shared by all values of a stream.
+        std::shared_ptr<Decoder const> decoder;
+
+        /// @brief Return the bytes of the value.
+        char const * data() const { return this->buffer.get()+this->offset; }
+    };
+
     /// @brief VR of the element.
     VR vr;
 
@@ -64,6 +106,9 @@ public:
         std::initializer_list<std::initializer_list<uint8_t>> const & value,
         VR const & vr=VR::INVALID);
 
+    /// @brief Constructor of an element decoded on first access.
+    Element(std::shared_ptr<EncodedValue const> encoded_value, VR const & vr);
+
     /** @addtogroup default_operations Default class operations
      * @{
      */
@@ -180,8 +225,40 @@ public:
     /// @brief Clear the element (element.empty() will be true).
     void clear();
 
+    /**
+     * @brief Return the encoded value of an element which was read lazily
+     * and has not been accessed in read-write mode since, nullptr otherwise.
+     */
+    std::shared_ptr<EncodedValue const> const & get_encoded_value() const;
+
 private:
+    /**
+     * @brief Encoded value and its decoded form, shared by the copies of an
+     * element until they are accessed in read-write mode.
+     */
+    struct LazyValue
+    {
+        std::shared_ptr<EncodedValue const> encoded_value;
+        std::once_flag decoded;
+        Value value;
+
+        LazyValue(std::shared_ptr<EncodedValue const> encoded_value);
+    };
+
+    /// @brief Value, or empty value of the type of the lazy value.
     Value _value;
+
+    /// @brief Lazy value, null once decoded in read-write mode.
+    std::shared_ptr<LazyValue> _lazy_value;
+
+    /**
+     * @brief Decode the value if needed, keep the encoded value. The
+     * decoding happens once, even if several threads access the element.
+     */
+    Value const & _decode() const;
+
+    /// @brief Decode the value if needed, discard the encoded value.
+    Value & _get_mutable_value();
 };
 
 /**
@@ -0,0 +1,232 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/FrameIndex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/Exception.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/Tag.h"
+#include "odil/Value.h"
+#include "odil/VR.h"
+
+namespace odil
+{
+
+FrameIndex
+::FrameIndex(
+    std::istream & stream, std::string const & transfer_syntax,
+    DataSet const & data_set)
+{
+    Reader const reader(stream, transfer_syntax);
+    this->_byte_ordering = reader.byte_ordering;
+
+    // Pixel Data element header
+    auto const tag = reader.read_tag();
+    if(tag != registry::PixelData)
+    {
+        throw Exception("Expected PixelData, got: "+std::string(tag));
+    }
+    VR vr = VR::OB;
+    if(reader.explicit_vr)
+    {
+        char vr_data[2];
+        Reader::read(stream, vr_data, 2);
+        vr = as_vr(std::string(vr_data, 2));
+    }
+    if(reader.read_length(vr) != 0xffffffff)
+    {
+        throw Exception("Pixel data is not encapsulated");
+    }
+
+    // Basic Offset Table, in the first item
+    uint32_t basic_offset_table_length;
+    if(!this->_read_item(stream, basic_offset_table_length))
+    {
+        throw Exception("Missing Basic Offset Table");
+    }
+    std::vector<uint32_t> basic_offset_table(basic_offset_table_length/4);
+    for(auto & offset: basic_offset_table)
+    {
+        offset = Reader::read_binary<uint32_t>(stream, this->_byte_ordering);
+    }
+    Reader::ignore(stream, basic_offset_table_length%4);
+    this->_first_fragment = stream.tellg();
+
+    std::size_t frames_count = 1;
+    if(data_set.has(registry::NumberOfFrames)
+        && !data_set.empty(registry::NumberOfFrames))
+    {
+        frames_count = data_set.as_int(registry::NumberOfFrames, 0);
+    }
+
+    if(data_set.has(registry::ExtendedOffsetTable)
+        && !data_set.empty(registry::ExtendedOffsetTable)
+        && !data_set.as_binary(registry::ExtendedOffsetTable)[0].empty())
+    {
+        // PS 3.5, A.4: 64-bits offsets, already in host byte order since
+        // the Reader swaps OV values.
+        auto const & table = data_set.as_binary(registry::ExtendedOffsetTable)[0];
+        this->_offsets.resize(table.size()/8);
+        for(std::size_t i=0; i<this->_offsets.size(); ++i)
+        {
+            std::memcpy(&this->_offsets[i], &table[8*i], 8);
+        }
+    }
+    else if(!basic_offset_table.empty())
+    {
+        this->_offsets.assign(
+            basic_offset_table.begin(), basic_offset_table.end());
+    }
+    else
+    {
+        // No offset table: scan the fragment headers.
+        std::vector<uint64_t> fragments;
+        uint32_t length;
+        while(this->_read_item(stream, length))
+        {
+            fragments.push_back(stream.tellg()-this->_first_fragment-8);
+            Reader::ignore(stream, length);
+        }
+
+        if(frames_count == 1 && !fragments.empty())
+        {
+            this->_offsets.push_back(0);
+        }
+        else if(fragments.size() == frames_count)
+        {
+            this->_offsets = std::move(fragments);
+        }
+        else
+        {
+            throw Exception(
+                "Cannot find the frames without offset table: "
+                +std::to_string(fragments.size())+" fragments for "
+                +std::to_string(frames_count)+" frames");
+        }
+    }
+
+    if(this->_offsets.size() != frames_count)
+    {
+        throw Exception(
+            "Offset table has "+std::to_string(this->_offsets.size())
+            +" entries for "+std::to_string(frames_count)+" frames");
+    }
+}
+
+std::size_t
+FrameIndex
+::size() const
+{
+    return this->_offsets.size();
+}
+
+std::streampos
+FrameIndex
+::get_position(std::size_t frame) const
+{
+    if(frame >= this->_offsets.size())
+    {
+        throw Exception("No such frame: "+std::to_string(frame));
+    }
+    return this->_first_fragment+std::streamoff(this->_offsets[frame]);
+}
+
+std::vector<FrameIndex::Fragment>
+FrameIndex
+::get_fragments(std::istream & stream, std::size_t frame) const
+{
+    auto const end = this->_seek(stream, frame);
+
+    std::vector<Fragment> fragments;
+    uint32_t length;
+    while(
+        (end == std::streampos(-1) || stream.tellg() < end)
+        && this->_read_item(stream, length))
+    {
+        fragments.push_back({stream.tellg(), length});
+        Reader::ignore(stream, length);
+    }
+
+    return fragments;
+}
+
+Value::Binary::value_type
+FrameIndex
+::read_frame(std::istream & stream, std::size_t frame) const
+{
+    auto const end = this->_seek(stream, frame);
+
+    Value::Binary::value_type data;
+    uint32_t length;
+    while(
+        (end == std::streampos(-1) || stream.tellg() < end)
+        && this->_read_item(stream, length))
+    {
+        auto const offset = data.size();
+        data.resize(offset+length);
+        if(length > 0)
+        {
+            Reader::read(
+                stream, reinterpret_cast<char*>(&data[offset]), length);
+        }
+    }
+
+    return data;
+}
+
+std::streampos
+FrameIndex
+::_seek(std::istream & stream, std::size_t frame) const
+{
+    auto const begin = this->get_position(frame);
+
+    stream.clear();
+    stream.seekg(begin);
+    if(!stream)
+    {
+        throw Exception("Could not seek to frame "+std::to_string(frame));
+    }
+
+    return
+        (frame+1 < this->_offsets.size())
+        ? this->get_position(frame+1) : std::streampos(-1);
+}
+
+bool
+FrameIndex
+::_read_item(std::istream & stream, uint32_t & length) const
+{
+    auto const group = Reader::read_binary<uint16_t>(
+        stream, this->_byte_ordering);
+    auto const element = Reader::read_binary<uint16_t>(
+        stream, this->_byte_ordering);
+    Tag const tag(group, element);
+    length = Reader::read_binary<uint32_t>(stream, this->_byte_ordering);
+
+    if(tag == registry::SequenceDelimitationItem)
+    {
+        return false;
+    }
+    else if(tag != registry::Item)
+    {
+        throw Exception(
+            "Expected SequenceDelimitationItem, got: "+std::string(tag));
+    }
+    return true;
+}
+
+}
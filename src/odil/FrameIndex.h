@@ -0,0 +1,97 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _3c9f5e1a_8d27_4b60_a4e3_71f0b2d6c845
+#define _3c9f5e1a_8d27_4b60_a4e3_71f0b2d6c845
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/endian.h"
+#include "odil/odil.h"
+#include "odil/Value.h"
+
+namespace odil
+{
+
+/**
+ * @brief Random access to the frames of encapsulated pixel data (PS 3.5,
+ * A.4) stored in a seekable stream.
+ *
+ * The start of each frame is given by the Extended Offset Table or by the
+ * Basic Offset Table: locating a frame does not depend on the number of
+ * frames and only the fragments of the requested frame are read. If both
+ * tables are empty, the fragment headers are scanned once, without reading
+ * their content, and each fragment is assumed to be a frame.
+ */
+class ODIL_API FrameIndex
+{
+public:
+    /// @brief Location of a fragment in the stream.
+    struct Fragment
+    {
+        /// @brief Position of the content of the fragment.
+        std::streampos position;
+
+        /// @brief Length of the content of the fragment.
+        uint32_t length;
+    };
+
+    /**
+     * @brief Index the encapsulated pixel data at the current position of
+     * the stream, i.e. at the Pixel Data tag after Reader::read_file or
+     * Reader::read_data_set halted on it.
+     *
+     * The data set provides the Number of Frames and the Extended Offset
+     * Table, if any. The position of the stream is not specified after the
+     * call.
+     */
+    FrameIndex(
+        std::istream & stream, std::string const & transfer_syntax,
+        DataSet const & data_set);
+
+    /// @brief Return the number of frames.
+    std::size_t size() const;
+
+    /// @brief Return the position of the first fragment of a frame.
+    std::streampos get_position(std::size_t frame) const;
+
+    /// @brief Return the fragments of a frame, reading their headers.
+    std::vector<Fragment> get_fragments(
+        std::istream & stream, std::size_t frame) const;
+
+    /// @brief Read the content of a frame, concatenating its fragments.
+    Value::Binary::value_type read_frame(
+        std::istream & stream, std::size_t frame) const;
+
+private:
+    ByteOrdering _byte_ordering;
+
+    /// @brief Position of the first fragment, after the Basic Offset Table.
+    std::streampos _first_fragment;
+
+    /// @brief Offset of each frame, relative to the first fragment.
+    std::vector<uint64_t> _offsets;
+
+    /**
+     * @brief Move the stream to the first fragment of a frame, return the
+     * position of the next frame, or -1 for the last frame.
+     */
+    std::streampos _seek(std::istream & stream, std::size_t frame) const;
+
+    /// @brief Read an item header, return false at the end of the sequence.
+    bool _read_item(std::istream & stream, uint32_t & length) const;
+};
+
+}
+
+#endif // _3c9f5e1a_8d27_4b60_a4e3_71f0b2d6c845
@@ -8,9 +8,12 @@
 
 #include "odil/GetSCP.h"
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 
 #include "odil/Association.h"
+#include "odil/DataSetPrefetcher.h"
 #include "odil/Exception.h"
 #include "odil/SCP.h"
 #include "odil/StoreSCU.h"
@@ -25,7 +28,8 @@ GetSCP
 ::GetSCP(
     Association & association,
     std::shared_ptr<DataSetGenerator> const & generator)
-: SCP(association), _generator(nullptr)
+: SCP(association), _generator(nullptr), _prefetch_size(0),
+  _pending_responses_interval(boost::posix_time::seconds(0))
 {
     this->set_generator(generator);
 }
@@ -44,6 +48,34 @@ GetSCP
     this->_generator = generator;
 }
 
+std::size_t
+GetSCP
+::get_prefetch_size() const
+{
+    return this->_prefetch_size;
+}
+
+void
+GetSCP
+::set_prefetch_size(std::size_t size)
+{
+    this->_prefetch_size = size;
+}
+
+Association::duration_type
+GetSCP
+::get_pending_responses_interval() const
+{
+    return this->_pending_responses_interval;
+}
+
+void
+GetSCP
+::set_pending_responses_interval(Association::duration_type const & interval)
+{
+    this->_pending_responses_interval = interval;
+}
+
 void
 GetSCP
 ::operator()(std::shared_ptr<message::Message> message)
@@ -70,22 +102,34 @@ GetSCP
         this->_generator->initialize(request);
         remaining_sub_operations = this->_generator->count();
 
-        while(!this->_generator->done())
+        auto const interval = std::chrono::microseconds(
+            this->_pending_responses_interval.total_microseconds());
+        bool pending_sent = false;
+        std::chrono::steady_clock::time_point last_pending;
+
+        DataSetPrefetcher prefetcher(this->_generator, this->_prefetch_size);
+        while(auto const data_set = prefetcher.get())
         {
-            auto response = std::make_shared<message::CGetResponse>(
-                request->get_message_id(), message::CGetResponse::Pending);
-            response->set_number_of_remaining_sub_operations(
-                remaining_sub_operations);
-            response->set_number_of_completed_sub_operations(
-                completed_sub_operations);
-            response->set_number_of_failed_sub_operations(
-                failed_sub_operations);
-            response->set_number_of_warning_sub_operations(
-                warning_sub_operations);
-            this->_association.send_message(
-                response, request->get_affected_sop_class_uid());
-
-            auto data_set = this->_generator->get();
+            auto const now = std::chrono::steady_clock::now();
+            if(!pending_sent || now-last_pending >= interval)
+            {
+                auto response = std::make_shared<message::CGetResponse>(
+                    request->get_message_id(), message::CGetResponse::Pending);
+                response->set_number_of_remaining_sub_operations(
+                    remaining_sub_operations);
+                response->set_number_of_completed_sub_operations(
+                    completed_sub_operations);
+                response->set_number_of_failed_sub_operations(
+                    failed_sub_operations);
+                response->set_number_of_warning_sub_operations(
+                    warning_sub_operations);
+                this->_association.send_message(
+                    response, request->get_affected_sop_class_uid());
+
+                pending_sent = true;
+                last_pending = now;
+            }
+
             store_scu.set_affected_sop_class(data_set);
             try
             {
@@ -96,10 +140,9 @@ GetSCP
             }
             catch(Exception const &)
             {
+                --remaining_sub_operations;
                 ++failed_sub_operations;
             }
-
-            this->_generator->next();
         }
     }
     catch(SCP::Exception const & e)
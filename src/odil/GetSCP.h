@@ -9,6 +9,7 @@
 #ifndef _2f0ad1fd_8779_4ab3_b7e8_6d37fdc0c018
 #define _2f0ad1fd_8779_4ab3_b7e8_6d37fdc0c018
 
+#include <cstddef>
 #include <memory>
 
 #include "odil/Association.h"
@@ -44,10 +45,35 @@ public:
     /// @brief Set the generator.
     void set_generator(std::shared_ptr<DataSetGenerator> const & generator);
 
+    /**
+     * @brief Return the number of data sets read from the generator in
+     * advance of the sub-operations, default to 0.
+     *
+     * When non-zero, the generator is run by a background thread, see
+     * DataSetPrefetcher.
+     */
+    std::size_t get_prefetch_size() const;
+
+    /// @brief Set the number of data sets read in advance.
+    void set_prefetch_size(std::size_t size);
+
+    /**
+     * @brief Return the minimum interval between two Pending responses,
+     * default to 0 (a Pending response before each sub-operation).
+     */
+    Association::duration_type get_pending_responses_interval() const;
+
+    /// @brief Set the minimum interval between two Pending responses.
+    void set_pending_responses_interval(
+        Association::duration_type const & interval);
+
     /// @brief Process a C-Get request.
     virtual void operator()(std::shared_ptr<message::Message> message);
 private:
     std::shared_ptr<DataSetGenerator> _generator;
+    std::size_t _prefetch_size;
+    Association::duration_type _pending_responses_interval;
+
     void operator()(std::shared_ptr<message::CGetRequest const> request);
 };
 
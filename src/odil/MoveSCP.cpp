@@ -8,12 +8,20 @@
 
 #include "odil/MoveSCP.h"
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "odil/Association.h"
+#include "odil/DataSetPrefetcher.h"
 #include "odil/Exception.h"
 #include "odil/logging.h"
 #include "odil/SCP.h"
@@ -27,7 +35,9 @@ namespace odil
 
 MoveSCP
 ::MoveSCP(Association & association)
-: SCP(association), _generator(nullptr)
+: SCP(association), _generator(nullptr), _prefetch_size(0),
+  _sub_associations_count(1),
+  _pending_responses_interval(boost::posix_time::seconds(0))
 {
     // Nothing else.
 }
@@ -36,7 +46,9 @@ MoveSCP
 ::MoveSCP(
     Association & association,
     std::shared_ptr<DataSetGenerator> const & generator)
-: SCP(association), _generator(nullptr)
+: SCP(association), _generator(nullptr), _prefetch_size(0),
+  _sub_associations_count(1),
+  _pending_responses_interval(boost::posix_time::seconds(0))
 {
     this->set_generator(generator);
 }
@@ -55,6 +67,52 @@ MoveSCP
     this->_generator = generator;
 }
 
+std::size_t
+MoveSCP
+::get_prefetch_size() const
+{
+    return this->_prefetch_size;
+}
+
+void
+MoveSCP
+::set_prefetch_size(std::size_t size)
+{
+    this->_prefetch_size = size;
+}
+
+unsigned int
+MoveSCP
+::get_sub_associations_count() const
+{
+    return this->_sub_associations_count;
+}
+
+void
+MoveSCP
+::set_sub_associations_count(unsigned int count)
+{
+    if(count == 0)
+    {
+        throw odil::Exception("At least one sub-association is required");
+    }
+    this->_sub_associations_count = count;
+}
+
+Association::duration_type
+MoveSCP
+::get_pending_responses_interval() const
+{
+    return this->_pending_responses_interval;
+}
+
+void
+MoveSCP
+::set_pending_responses_interval(Association::duration_type const & interval)
+{
+    this->_pending_responses_interval = interval;
+}
+
 void
 MoveSCP
 ::operator()(std::shared_ptr<message::Message> message)
@@ -84,10 +142,26 @@ MoveSCP
     }
 
     move_association.associate();
-    StoreSCU store_scu(move_association);
+
+    std::vector<std::shared_ptr<Association>> sub_associations;
+    for(unsigned int i=1; i<this->_sub_associations_count; ++i)
+    {
+        auto sub_association = std::make_shared<Association>(move_association);
+        try
+        {
+            sub_association->associate();
+        }
+        catch(odil::Exception const & e)
+        {
+            ODIL_LOG(warning)
+                << "Cannot open additional move association: " << e.what();
+            break;
+        }
+        sub_associations.push_back(sub_association);
+    }
 
     Value::Integer final_status = message::CMoveResponse::Success;
-    std::shared_ptr<DataSet> status_fields;
+    auto status_fields = std::make_shared<DataSet>();
     unsigned int remaining_sub_operations = 0;
     unsigned int completed_sub_operations=0;
     unsigned int failed_sub_operations=0;
@@ -97,15 +171,29 @@ MoveSCP
         this->_association.get_negotiated_parameters().get_calling_ae_title();
     auto const & move_originator_message_id = request->get_message_id();
 
-    try
+    // Shared by the threads of the sub-associations. The data sets which
+    // could not be sent on a dead association are handed back to the other
+    // ones.
+    std::mutex mutex;
+    std::exception_ptr error;
+    std::deque<std::shared_ptr<DataSet>> handed_back;
+
+    auto const interval = std::chrono::microseconds(
+        this->_pending_responses_interval.total_microseconds());
+    bool pending_sent = false;
+    std::chrono::steady_clock::time_point last_pending;
+    auto const send_pending = [&]()
     {
-        this->_generator->initialize(request);
-        remaining_sub_operations = this->_generator->count();
+        auto const now = std::chrono::steady_clock::now();
+        if(pending_sent && now-last_pending < interval)
+        {
+            return;
+        }
 
-        while(!this->_generator->done())
+        auto response = std::make_shared<message::CMoveResponse>(
+            request->get_message_id(), message::CMoveResponse::Pending);
         {
-            auto response = std::make_shared<message::CMoveResponse>(
-                request->get_message_id(), message::CMoveResponse::Pending);
+            std::lock_guard<std::mutex> lock(mutex);
             response->set_number_of_remaining_sub_operations(
                 remaining_sub_operations);
             response->set_number_of_completed_sub_operations(
@@ -114,26 +202,138 @@ MoveSCP
                 failed_sub_operations);
             response->set_number_of_warning_sub_operations(
                 warning_sub_operations);
-            this->_association.send_message(
-                response, request->get_affected_sop_class_uid());
+        }
+        this->_association.send_message(
+            response, request->get_affected_sop_class_uid());
 
-            auto data_set = this->_generator->get();
-            store_scu.set_affected_sop_class(data_set);
-            try
+        pending_sent = true;
+        last_pending = now;
+    };
+
+    // Only the current thread sends the Pending responses, on the main
+    // association.
+    auto const run = [&](
+        DataSetPrefetcher & prefetcher, Association & sub_association,
+        bool send_responses)
+    {
+        StoreSCU store_scu(sub_association);
+        try
+        {
+            while(true)
             {
-                store_scu.store(
-                    data_set, move_originator_aet, move_originator_message_id);
+                std::shared_ptr<DataSet> data_set;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if(error)
+                    {
+                        return;
+                    }
+                    if(!handed_back.empty())
+                    {
+                        data_set = handed_back.front();
+                        handed_back.pop_front();
+                    }
+                }
+
+                if(!data_set)
+                {
+                    data_set = prefetcher.get();
+                }
+                if(!data_set)
+                {
+                    return;
+                }
+
+                if(send_responses)
+                {
+                    send_pending();
+                }
+
+                store_scu.set_affected_sop_class(data_set);
+                bool stored = false;
+                try
+                {
+                    store_scu.store(
+                        data_set,
+                        move_originator_aet, move_originator_message_id);
+                    stored = true;
+                }
+                catch(odil::Exception const &)
+                {
+                    stored = false;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if(!stored && !sub_association.is_associated())
+                {
+                    // Let the other associations try: the data set is only
+                    // counted once, either by them or when all are done.
+                    ODIL_LOG(warning)
+                        << "Move association lost, stopping its transfers";
+                    handed_back.push_back(data_set);
+                    return;
+                }
 
                 --remaining_sub_operations;
-                ++completed_sub_operations;
+                if(stored)
+                {
+                    ++completed_sub_operations;
+                }
+                else
+                {
+                    ++failed_sub_operations;
+                }
             }
-            catch(Exception const &)
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!error)
             {
-                --remaining_sub_operations;
-                ++failed_sub_operations;
+                error = std::current_exception();
+            }
+        }
+    };
+
+    try
+    {
+        this->_generator->initialize(request);
+        remaining_sub_operations = this->_generator->count();
+
+        {
+            DataSetPrefetcher prefetcher(
+                this->_generator, this->_prefetch_size);
+
+            std::vector<std::thread> threads;
+            for(auto const & sub_association: sub_associations)
+            {
+                threads.emplace_back(
+                    [&, sub_association]()
+                    {
+                        run(prefetcher, *sub_association, false);
+                    });
+            }
+            run(prefetcher, move_association, true);
+            for(auto & thread: threads)
+            {
+                thread.join();
             }
+        }
+
+        // No association was left to store the data sets which were handed
+        // back or not fetched yet.
+        if(remaining_sub_operations != 0)
+        {
+            failed_sub_operations += remaining_sub_operations;
+            remaining_sub_operations = 0;
+            final_status =
+                message::CMoveResponse::
+                    SubOperationsCompleteOneOrMoreFailuresOrWarnings;
+        }
 
-            this->_generator->next();
+        if(error)
+        {
+            std::rethrow_exception(error);
         }
     }
     catch(SCP::Exception const & e)
@@ -147,6 +347,19 @@ MoveSCP
         final_status = message::CMoveResponse::UnableToProcess;
     }
 
+    for(auto const & sub_association: sub_associations)
+    {
+        try
+        {
+            sub_association->release();
+        }
+        catch(odil::Exception const & e)
+        {
+            ODIL_LOG(warning)
+                << "Cannot release additional move association: " << e.what();
+        }
+    }
+
     auto response = std::make_shared<message::CMoveResponse>(
         request->get_message_id(), final_status);
     response->set_status_fields(status_fields);
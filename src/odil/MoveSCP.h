@@ -9,6 +9,7 @@
 #ifndef _7e899e10_2a21_45b8_a2d6_af1d13cbfd29
 #define _7e899e10_2a21_45b8_a2d6_af1d13cbfd29
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -59,11 +60,51 @@ public:
     /// @brief Set the generator.
     void set_generator(std::shared_ptr<DataSetGenerator> const & generator);
 
+    /**
+     * @brief Return the number of data sets read from the generator in
+     * advance of the sub-operations, default to 0.
+     *
+     * When non-zero, the generator is run by a background thread, see
+     * DataSetPrefetcher.
+     */
+    std::size_t get_prefetch_size() const;
+
+    /// @brief Set the number of data sets read in advance.
+    void set_prefetch_size(std::size_t size);
+
+    /**
+     * @brief Return the number of sub-associations opened with the move
+     * destination, default to 1.
+     *
+     * Each sub-association is a copy of the one returned by the generator,
+     * and is run by its own thread. The additional sub-associations are
+     * optional: if one cannot be established, the sub-operations are spread
+     * over the other ones.
+     */
+    unsigned int get_sub_associations_count() const;
+
+    /// @brief Set the number of sub-associations.
+    void set_sub_associations_count(unsigned int count);
+
+    /**
+     * @brief Return the minimum interval between two Pending responses,
+     * default to 0 (a Pending response before each sub-operation).
+     */
+    Association::duration_type get_pending_responses_interval() const;
+
+    /// @brief Set the minimum interval between two Pending responses.
+    void set_pending_responses_interval(
+        Association::duration_type const & interval);
+
     /// @brief Process a C-Get request.
     virtual void operator()(std::shared_ptr<message::Message> message);
 
 private:
     std::shared_ptr<DataSetGenerator> _generator;
+    std::size_t _prefetch_size;
+    unsigned int _sub_associations_count;
+    Association::duration_type _pending_responses_interval;
+
     void operator()(std::shared_ptr<message::CMoveRequest const> request);
 };
 
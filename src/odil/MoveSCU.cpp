@@ -8,19 +8,26 @@
 
 #include "odil/MoveSCU.h"
 
-#include <chrono>
+#include <cstddef>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <thread>
 #include <vector>
 
+#include <boost/asio.hpp>
+
 #include "odil/Association.h"
+#include "odil/AssociationAcceptor.h"
 #include "odil/DataSet.h"
 #include "odil/Exception.h"
 #include "odil/logging.h"
 #include "odil/StoreSCP.h"
 #include "odil/message/CMoveRequest.h"
 #include "odil/message/CMoveResponse.h"
+#include "odil/message/CStoreRequest.h"
 #include "odil/message/Message.h"
+#include "odil/message/Response.h"
 
 namespace odil
 {
@@ -94,45 +101,35 @@ MoveSCU
     std::shared_ptr<message::CMoveRequest const> request,
     StoreCallback store_callback, MoveCallback move_callback) const
 {
-    this->_association.send_message(request, this->_affected_sop_class);
-
-    // Receive the responses
-    Association store_association;
-    bool done = false;
-    if(this->_incoming_port != 0)
+    if(this->_incoming_port == 0)
     {
+        this->_association.send_message(request, this->_affected_sop_class);
+
+        bool done = false;
         while(!done)
         {
-            // Use a small timeout to avoid blocking for a long time.
-            boost::posix_time::milliseconds const timeout(10);
-            store_association.set_tcp_timeout(timeout);
-            store_association.set_message_timeout(timeout);
-
-            if(!store_association.is_associated())
-            {
-                try
-                {
-                    store_association.receive_association(
-                        boost::asio::ip::tcp::v4(), this->_incoming_port);
-                    store_association.set_tcp_timeout(
-                        this->_association.get_tcp_timeout());
-                    store_association.set_message_timeout(
-                        this->_association.get_message_timeout());
-                }
-                catch(Exception const & e)
-                {
-                    // Ignore
-                }
-
-                if(store_association.is_associated())
-                {
-                    done = true;
-                }
-            }
+            done = this->_handle_main_response(
+                std::make_shared<message::CMoveResponse>(
+                    this->_association.receive_message()),
+                move_callback);
         }
     }
+    else
+    {
+        // Listen before sending the request, so that the peer can connect as
+        // soon as it starts the sub-operations.
+        boost::asio::io_service service;
+        boost::asio::ip::tcp::acceptor acceptor(service);
+        boost::asio::ip::tcp::endpoint const endpoint(
+            boost::asio::ip::tcp::v4(), this->_incoming_port);
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
 
-    this->_dispatch(store_association, store_callback, move_callback);
+        this->_association.send_message(request, this->_affected_sop_class);
+        this->_dispatch(service, acceptor, store_callback, move_callback);
+    }
 }
 
 std::vector<std::shared_ptr<DataSet>>
@@ -151,34 +148,197 @@ MoveSCU
 void
 MoveSCU
 ::_dispatch(
-    Association & store_association, StoreCallback store_callback,
-    MoveCallback move_callback) const
+    boost::asio::io_service & service,
+    boost::asio::ip::tcp::acceptor & acceptor,
+    StoreCallback store_callback, MoveCallback move_callback) const
 {
-    // If no store association has been established, store is considered done
-    bool store_done = !store_association.is_associated();
+    // All callbacks are run by the current thread, which runs the service:
+    // the store associations are asynchronous, and the responses received on
+    // the main association by a dedicated thread are posted to the service.
+
+    std::exception_ptr error;
+    auto const store_scp_callback =
+        [&store_callback, &error](
+            std::shared_ptr<message::CStoreRequest> request)
+        {
+            try
+            {
+                if(store_callback)
+                {
+                    store_callback(request->get_data_set());
+                }
+            }
+            catch(odil::Exception const &)
+            {
+                throw;
+            }
+            catch(...)
+            {
+                if(!error)
+                {
+                    error = std::current_exception();
+                }
+                return message::Response::ProcessingFailure;
+            }
+            return message::Response::Success;
+        };
+
+    // Stop accepting associations once the C-MOVE is done and the store
+    // associations are closed.
+    auto work = std::make_shared<boost::asio::io_service::work>(service);
     bool main_done = false;
-    while(!(store_done && main_done))
+    std::size_t active_stores = 0;
+    auto const finish = [&]()
+    {
+        if(main_done && active_stores == 0)
+        {
+            boost::system::error_code ignored;
+            acceptor.close(ignored);
+        }
+    };
+
+    // The store associations are kept until the end, since they are still
+    // referenced by the handlers of their last operations.
+    struct Store
     {
-        if(!store_done && store_association.get_transport().get_socket()->available() > 0)
+        Association association;
+        StoreSCP scp;
+
+        Store(
+            boost::asio::io_service & service,
+            StoreSCP::Callback const & callback)
+        : association(service), scp(association, callback)
         {
-            store_done = this->_handle_store_association(
-                store_association, store_callback);
+            // Nothing else.
         }
-        if(!main_done && this->_association.get_transport().get_socket()->available() > 0)
+    };
+    std::vector<std::shared_ptr<Store>> stores;
+
+    std::function<void()> accept;
+    accept = [&]()
+    {
+        auto const store = std::make_shared<Store>(service, store_scp_callback);
+        store->association.set_tcp_timeout(this->_association.get_tcp_timeout());
+        store->association.get_transport().async_receive(
+            acceptor,
+            [&, store](boost::system::error_code const & e)
+            {
+                if(e == boost::asio::error::operation_aborted)
+                {
+                    return;
+                }
+                else if(e)
+                {
+                    ODIL_LOG(warning)
+                        << "Cannot accept store association: " << e.message();
+                    if(acceptor.is_open())
+                    {
+                        accept();
+                    }
+                    return;
+                }
+
+                stores.push_back(store);
+                ++active_stores;
+                accept();
+
+                store->association.async_receive_association(
+                    default_association_acceptor,
+                    [&, store](std::exception_ptr e)
+                    {
+                        if(e)
+                        {
+                            --active_stores;
+                            finish();
+                            return;
+                        }
+                        store->scp.async_serve(
+                            [&, store](std::exception_ptr)
+                            {
+                                // Released or aborted by the peer.
+                                --active_stores;
+                                finish();
+                            });
+                    });
+            });
+    };
+    accept();
+
+    std::thread receiver([&]() {
+        bool done = false;
+        while(!done)
         {
-            main_done = this->_handle_main_association(move_callback);
+            std::shared_ptr<message::CMoveResponse> response;
+            std::exception_ptr receive_error;
+            try
+            {
+                response = std::make_shared<message::CMoveResponse>(
+                    this->_association.receive_message());
+            }
+            catch(...)
+            {
+                receive_error = std::current_exception();
+            }
+            done = (receive_error || !response->is_pending());
+
+            service.post([&, response, receive_error, done]() {
+                try
+                {
+                    if(receive_error)
+                    {
+                        std::rethrow_exception(receive_error);
+                    }
+                    this->_handle_main_response(response, move_callback);
+                }
+                catch(...)
+                {
+                    if(!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+                if(done)
+                {
+                    main_done = true;
+                    work.reset();
+                    finish();
+                }
+            });
         }
+    });
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    try
+    {
+        service.run();
+    }
+    catch(...)
+    {
+        // The receiver may be blocked until the next response of the peer:
+        // close the main association from the thread running its transport,
+        // and make sure the receiver is joined before leaving.
+        auto & transport = this->_association.get_transport();
+        transport.get_service().post([&transport]() { transport.close(); });
+        receiver.join();
+
+        // Run the closing handler if the receiver was already done.
+        transport.get_service().poll();
+        transport.get_service().reset();
+        throw;
+    }
+    receiver.join();
+
+    if(error)
+    {
+        std::rethrow_exception(error);
     }
 }
 
 bool
 MoveSCU
-::_handle_main_association(MoveCallback callback) const
+::_handle_main_response(
+    std::shared_ptr<message::CMoveResponse> response,
+    MoveCallback callback) const
 {
-    auto response = std::make_shared<message::CMoveResponse>(
-        this->_association.receive_message());
     if(message::Response::is_warning(response->get_status()))
     {
         ODIL_LOG(error) << "C-MOVE response status: " << response->get_status();
@@ -198,34 +358,4 @@ MoveSCU
     return done;
 }
 
-bool
-MoveSCU
-::_handle_store_association(
-    Association & association, StoreCallback callback) const
-{
-    bool result = false;
-    try
-    {
-        auto const store_callback = [&callback](std::shared_ptr<message::CStoreRequest> request) {
-            if(callback)
-            {
-                callback(request->get_data_set());
-            }
-            return message::Response::Success;
-        };
-        StoreSCP scp(association, store_callback);
-        scp.receive_and_process();
-    }
-    catch(AssociationReleased const &)
-    {
-        result = true;
-    }
-    catch(AssociationAborted const & e)
-    {
-        result = true;
-    }
-
-    return result;
-}
-
 }
@@ -13,6 +13,8 @@
 #include <string>
 #include <vector>
 
+#include <boost/asio.hpp>
+
 #include "odil/Association.h"
 #include "odil/DataSet.h"
 #include "odil/message/CMoveRequest.h"
@@ -82,13 +84,18 @@ private:
         std::shared_ptr<message::CMoveRequest const> request,
         StoreCallback store_callback, MoveCallback move_callback) const;
     
+    /**
+     * @brief Receive the responses on the main association and serve the
+     * incoming store associations until the C-MOVE is done.
+     */
     void _dispatch(
-        Association & store_association, StoreCallback store_callback,
-        MoveCallback move_callback) const;
+        boost::asio::io_service & service,
+        boost::asio::ip::tcp::acceptor & acceptor,
+        StoreCallback store_callback, MoveCallback move_callback) const;
     
-    bool _handle_main_association(MoveCallback callback) const;
-    bool _handle_store_association(
-        Association & association, StoreCallback callback) const;
+    bool _handle_main_response(
+        std::shared_ptr<message::CMoveResponse> response,
+        MoveCallback callback) const;
 };
 
 }
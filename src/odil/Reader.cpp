@@ -11,19 +11,29 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <functional>
 #include <istream>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
 
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #include "odil/DataSet.h"
 #include "odil/Element.h"
 #include "odil/endian.h"
 #include "odil/Exception.h"
 #include "odil/logging.h"
+#include "odil/numeric_string.h"
 #include "odil/registry.h"
+#include "odil/StringStream.h"
 #include "odil/Tag.h"
 #include "odil/Value.h"
 #include "odil/VR.h"
@@ -36,14 +46,43 @@ std::string read_string(std::istream & stream, unsigned int size)
         return std::string();
     }
     std::string value(size, '\0');
-    stream.read(&value[0], value.size());
-    if(!stream)
+    try
+    {
+        odil::Reader::read(stream, &value[0], value.size());
+    }
+    catch(odil::Exception const &)
     {
         throw odil::Exception("Cannot read string");
     }
     return value;
 }
 
+namespace
+{
+
+/// @brief Test whether the length of an element is stored on 4 bytes.
+bool has_long_length(odil::VR vr, bool explicit_vr)
+{
+    // PS 3.5, 7.1.2
+    return
+        !explicit_vr
+        || odil::is_binary(vr) || vr == odil::VR::SQ || vr == odil::VR::UC
+        || vr == odil::VR::UR || vr == odil::VR::UT;
+}
+
+/// @brief Decode an integer stored in a buffer.
+template<typename T>
+T decode(char const * data, odil::ByteOrdering byte_ordering)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return
+        (byte_ordering == odil::ByteOrdering::LittleEndian)
+        ? odil::little_endian_to_host(value) : odil::big_endian_to_host(value);
+}
+
+}
+
 namespace odil
 {
 
@@ -71,12 +110,9 @@ Reader
 
             if(item_length > 0)
             {
-                stream.read(
-                    reinterpret_cast<char*>(&item_data[0]), item_length);
-                if(!stream)
-                {
-                    throw Exception("Could not read from stream");
-                }
+                Reader::read(
+                    stream, reinterpret_cast<char*>(&item_data[0]),
+                    item_length);
             }
 
             value.push_back(item_data);
@@ -100,96 +136,91 @@ void
 Reader
 ::ignore(std::istream & stream, std::streamsize size)
 {
-    stream.ignore(size);
-    if(!stream)
+    // Same as read: discard the data through the stream buffer.
+    auto * buffer = stream.rdbuf();
+    if(!stream.good() || buffer == nullptr)
     {
         throw Exception("Could not read from stream");
     }
+    if(size > 0 && Source::next(stream, size) != nullptr)
+    {
+        return;
+    }
+
+    char discarded[256];
+    while(size > 0)
+    {
+        auto const chunk = std::min<std::streamsize>(size, sizeof(discarded));
+        if(buffer->sgetn(discarded, chunk) != chunk)
+        {
+            stream.setstate(std::ios::eofbit | std::ios::failbit);
+            throw Exception("Could not read from stream");
+        }
+        size -= chunk;
+    }
 }
 
 Reader
 ::Reader(
     std::istream & stream, std::string const & transfer_syntax,
-    bool keep_group_length)
+    bool keep_group_length, bool lazy_decoding,
+    DataSet::MemoryResource * memory_resource)
 : stream(stream), transfer_syntax(transfer_syntax),
     byte_ordering(
         (transfer_syntax==registry::ExplicitVRBigEndian)?
         ByteOrdering::BigEndian:ByteOrdering::LittleEndian),
     explicit_vr(transfer_syntax!=registry::ImplicitVRLittleEndian),
-    keep_group_length(keep_group_length)
+    keep_group_length(keep_group_length), lazy_decoding(lazy_decoding),
+    memory_resource(memory_resource), _stream_end(-1)
 {
     // Nothing else
 }
 
 std::shared_ptr<DataSet>
 Reader
-::read_data_set(std::function<bool(Tag const &)> halt_condition) const
+::read_data_set(
+    std::function<bool(Tag const &)> halt_condition,
+    std::function<bool(Tag const &)> filter) const
 {
-    auto data_set = std::make_shared<DataSet>(this->transfer_syntax);
-
-    while(this->stream.peek() != EOF)
-    {
-        Tag const tag = this->read_tag();
-
-        if(halt_condition(tag))
-        {
-            this->stream.seekg(-4, std::ios::cur);
-            break;
-        }
-        else
-        {
-            Element element = this->read_element(tag, data_set);
-
-            if(this->keep_group_length || tag.element != 0)
-            {
-                data_set->add(tag, std::move(element));
-            }
-        }
-
-    }
-
-    return data_set;
+    this->_stream_end = -1;
+    return this->_read_data_set(halt_condition, filter, -1);
 }
 
 Tag
 Reader
 ::read_tag() const
 {
-    auto const group = this->read_binary<uint16_t>(
-        this->stream, this->byte_ordering);
-    auto const element = this->read_binary<uint16_t>(
-        this->stream, this->byte_ordering);
-    return Tag(group, element);
+    char fallback[4];
+    auto const * data = Source::read(this->stream, 4, fallback);
+    return Tag(
+        decode<uint16_t>(data, this->byte_ordering),
+        decode<uint16_t>(data+2, this->byte_ordering));
 }
 
 uint32_t
 Reader
 ::read_length(VR vr) const
 {
+    char fallback[6];
     uint32_t length;
     if(this->explicit_vr)
     {
-        // PS 3.5, 7.1.2
-        if(is_binary(vr)
-            || vr == VR::SQ || vr == VR::UC || vr == VR::UR || vr == VR::UT)
+        if(has_long_length(vr, this->explicit_vr))
         {
-            Reader::ignore(this->stream, 2);
-            auto const vl = Reader::read_binary<uint32_t>(
-                this->stream, this->byte_ordering);
-            length = vl;
+            // Reserved bytes, then the length.
+            auto const * data = Source::read(this->stream, 6, fallback);
+            length = decode<uint32_t>(data+2, this->byte_ordering);
         }
         else
         {
-            auto const vl = Reader::read_binary<uint16_t>(
-                this->stream, this->byte_ordering);
-            length = vl;
+            auto const * data = Source::read(this->stream, 2, fallback);
+            length = decode<uint16_t>(data, this->byte_ordering);
         }
     }
     else
     {
-        auto const vl = Reader::read_binary<uint32_t>(
-            this->stream, this->byte_ordering);
-        length = vl;
+        auto const * data = Source::read(this->stream, 4, fallback);
+        length = decode<uint32_t>(data, this->byte_ordering);
     }
 
     return length;
@@ -202,7 +233,9 @@ Reader
     VR vr;
     if(this->explicit_vr)
     {
-        vr = as_vr(read_string(this->stream, 2));
+        char fallback[2];
+        auto const * data = Source::read(this->stream, 2, fallback);
+        vr = as_vr(data[0], data[1]);
     }
     else
     {
@@ -210,50 +243,148 @@ Reader
         vr = vr_finder(tag, data_set, this->transfer_syntax);
     }
 
-    std::shared_ptr<Value> value;
-
     auto const vl = this->read_length(vr);
-    if(is_int(vr))
-    {
-        value = std::make_shared<Value>(Value::Integers());
-    }
-    else if(is_real(vr))
-    {
-        value = std::make_shared<Value>(Value::Reals());
-    }
-    else if(is_string(vr))
-    {
-        value = std::make_shared<Value>(Value::Strings());
-    }
-    else if(vr == VR::SQ)
+    // Large values reference the buffer, if any, instead of being copied.
+    auto const reference =
+        this->lazy_decoding
+        || (this->buffer && (is_binary(vr) || vr == VR::LT || vr == VR::UT));
+    if(reference && vl > 0)
     {
-        value = std::make_shared<Value>(Value::DataSets());
-    }
-    else if(is_binary(vr))
-    {
-        value = std::make_shared<Value>(Value::Binary());
+        if(!this->_decoder)
+        {
+            auto const transfer_syntax = this->transfer_syntax;
+            auto const byte_ordering = this->byte_ordering;
+            auto const explicit_vr = this->explicit_vr;
+            auto const keep_group_length = this->keep_group_length;
+            auto const memory_resource = this->memory_resource;
+            this->_decoder = std::make_shared<Element::EncodedValue::Decoder>(
+                [=](VR vr, Element::EncodedValue const & encoded_value)
+                {
+                    IStringStream stream(
+                        encoded_value.data(), encoded_value.length);
+                    Visitor const visitor(
+                        stream, vr,
+                        encoded_value.undefined_length
+                            ? 0xffffffff : encoded_value.length,
+                        transfer_syntax, byte_ordering, explicit_vr,
+                        keep_group_length, memory_resource);
+
+                    Element element(vr);
+                    apply_visitor(visitor, element.get_value());
+                    return std::move(element.get_value());
+                });
+        }
+
+        auto encoded_value = std::make_shared<Element::EncodedValue>();
+        auto const begin =
+            this->buffer ? this->stream.tellg() : std::streampos(-1);
+        if(begin != std::streampos(-1))
+        {
+            // Record the position of the value in the buffer, skip it.
+            this->_read_raw_value(vl, nullptr);
+            encoded_value->buffer = this->buffer;
+            encoded_value->offset = std::streamoff(begin);
+            encoded_value->length = this->stream.tellg()-begin;
+        }
+        else
+        {
+            auto data = std::make_shared<std::string>();
+            this->_read_raw_value(vl, data.get());
+            encoded_value->buffer = std::shared_ptr<char const>(
+                data, data->data());
+            encoded_value->offset = 0;
+            encoded_value->length = data->size();
+        }
+        encoded_value->undefined_length = (vl == 0xffffffff);
+        encoded_value->byte_ordering = this->byte_ordering;
+        encoded_value->decoder = this->_decoder;
+        return Element(encoded_value, vr);
     }
-    else
+
+    if(
+        !is_int(vr) && !is_real(vr) && !is_string(vr) && vr != VR::SQ
+        && !is_binary(vr))
     {
         throw Exception("Cannot create value for VR " + as_string(vr));
     }
 
+    // Decode directly in the value of the element
+    Element element(vr);
     if(vl > 0)
     {
         Visitor visitor(
             this->stream, vr, vl, this->transfer_syntax, this->byte_ordering,
-            this->explicit_vr, this->keep_group_length);
-        apply_visitor(visitor, *value);
+            this->explicit_vr, this->keep_group_length, this->memory_resource);
+        visitor.buffer = this->buffer;
+        apply_visitor(visitor, element.get_value());
     }
 
-    return Element(*value, vr);
+    return element;
 }
 
 std::pair<std::shared_ptr<DataSet>, std::shared_ptr<DataSet>>
 Reader
 ::read_file(
     std::istream & stream, bool keep_group_length,
-    std::function<bool(Tag const &)> halt_condition)
+    std::function<bool(Tag const &)> halt_condition, bool lazy_decoding,
+    std::function<bool(Tag const &)> filter,
+    DataSet::MemoryResource * memory_resource)
+{
+    return Reader::_read_file(
+        stream, nullptr, keep_group_length, halt_condition, lazy_decoding,
+        filter, memory_resource);
+}
+
+std::pair<std::shared_ptr<DataSet>, std::shared_ptr<DataSet>>
+Reader
+::read_file(
+    std::string const & path, bool keep_group_length,
+    std::function<bool(Tag const &)> halt_condition, bool lazy_decoding,
+    std::function<bool(Tag const &)> filter,
+    DataSet::MemoryResource * memory_resource, bool memory_mapped)
+{
+    if(!memory_mapped)
+    {
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if(!stream)
+        {
+            throw Exception("Cannot open "+path);
+        }
+        return Reader::_read_file(
+            stream, nullptr, keep_group_length, halt_condition, lazy_decoding,
+            filter, memory_resource);
+    }
+
+    auto const region = std::make_shared<boost::interprocess::mapped_region>();
+    try
+    {
+        boost::interprocess::file_mapping const mapping(
+            path.c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region(
+            mapping, boost::interprocess::read_only).swap(*region);
+    }
+    catch(boost::interprocess::interprocess_exception const & e)
+    {
+        throw Exception("Cannot map "+path+": "+e.what());
+    }
+
+    // The values referencing the mapping keep it alive.
+    std::shared_ptr<char const> const buffer(
+        region, reinterpret_cast<char const *>(region->get_address()));
+
+    IStringStream stream(buffer.get(), region->get_size());
+    return Reader::_read_file(
+        stream, buffer, keep_group_length, halt_condition, lazy_decoding,
+        filter, memory_resource);
+}
+
+std::pair<std::shared_ptr<DataSet>, std::shared_ptr<DataSet>>
+Reader
+::_read_file(
+    std::istream & stream, std::shared_ptr<char const> const & buffer,
+    bool keep_group_length, std::function<bool(Tag const &)> halt_condition,
+    bool lazy_decoding, std::function<bool(Tag const &)> filter,
+    DataSet::MemoryResource * memory_resource)
 {
     // File preamble
     stream.ignore(128);
@@ -271,7 +402,8 @@ Reader
 
     // Read meta information
     Reader meta_information_reader(
-        stream, registry::ExplicitVRLittleEndian, keep_group_length);
+        stream, registry::ExplicitVRLittleEndian, keep_group_length, false,
+        memory_resource);
     auto meta_information = meta_information_reader.read_data_set(
         [](Tag const & tag) { return (tag.group != 0x0002); });
 
@@ -290,20 +422,216 @@ Reader
 
     Reader data_set_reader(
         stream, meta_information->as_string(registry::TransferSyntaxUID)[0],
-        keep_group_length);
-    auto data_set = data_set_reader.read_data_set(halt_condition);
+        keep_group_length, lazy_decoding, memory_resource);
+    data_set_reader.buffer = buffer;
+    auto data_set = data_set_reader.read_data_set(halt_condition, filter);
 
     return std::make_pair(meta_information, data_set);
 }
 
+std::shared_ptr<DataSet>
+Reader
+::_read_data_set(
+    std::function<bool(Tag const &)> halt_condition,
+    std::function<bool(Tag const &)> filter, std::streampos end) const
+{
+    // Allocate the data set and its control block from the memory resource
+    auto data_set =
+        this->memory_resource
+        ? std::allocate_shared<DataSet>(
+            boost::container::pmr::polymorphic_allocator<DataSet>(
+                this->memory_resource),
+            this->transfer_syntax, this->memory_resource)
+        : std::make_shared<DataSet>(this->transfer_syntax);
+
+    while(
+        (end == std::streampos(-1) || this->stream.tellg() < end)
+        && this->stream.rdbuf()->sgetc() != EOF)
+    {
+        Tag const tag = this->read_tag();
+
+        if(halt_condition(tag))
+        {
+            this->stream.seekg(-4, std::ios::cur);
+            break;
+        }
+        else if(filter && !filter(tag))
+        {
+            this->_skip_element();
+        }
+        else
+        {
+            Element element = this->read_element(tag, data_set);
+
+            if(this->keep_group_length || tag.element != 0)
+            {
+                data_set->add(tag, std::move(element));
+            }
+        }
+
+    }
+
+    return data_set;
+}
+
+void
+Reader
+::_skip_element() const
+{
+    // The VR is only needed to know the size of the length field.
+    VR vr = VR::UN;
+    if(this->explicit_vr)
+    {
+        char fallback[2];
+        auto const * data = Source::read(this->stream, 2, fallback);
+        vr = as_vr(data[0], data[1]);
+    }
+    auto const vl = this->read_length(vr);
+    this->_read_raw_value(vl, nullptr);
+}
+
+void
+Reader
+::_read_raw_value(uint32_t vl, std::string * data) const
+{
+    if(vl != 0xffffffff)
+    {
+        this->_read_raw(vl, data);
+        return;
+    }
+
+    // Undefined length: items of a sequence (PS 3.5, 7.5) or fragments of
+    // encapsulated pixel data (PS 3.5, A.4), up to the delimitation item.
+    auto const read_header = [&](std::size_t size)
+    {
+        auto const header = read_string(this->stream, size);
+        if(data != nullptr)
+        {
+            data->append(header);
+        }
+        return header;
+    };
+
+    bool done = false;
+    while(!done)
+    {
+        auto const header = read_header(8);
+        Tag const tag(
+            decode<uint16_t>(&header[0], this->byte_ordering),
+            decode<uint16_t>(&header[2], this->byte_ordering));
+        auto const item_length = decode<uint32_t>(
+            &header[4], this->byte_ordering);
+
+        if(tag == registry::SequenceDelimitationItem)
+        {
+            done = true;
+        }
+        else if(tag != registry::Item)
+        {
+            throw Exception(
+                "Expected SequenceDelimitationItem, got: "+std::string(tag));
+        }
+        else if(item_length != 0xffffffff)
+        {
+            this->_read_raw(item_length, data);
+        }
+        else
+        {
+            // Undefined length item: elements up to the delimitation item.
+            bool item_done = false;
+            while(!item_done)
+            {
+                auto const tag_data = read_header(4);
+                Tag const element_tag(
+                    decode<uint16_t>(&tag_data[0], this->byte_ordering),
+                    decode<uint16_t>(&tag_data[2], this->byte_ordering));
+                if(element_tag == registry::ItemDelimitationItem)
+                {
+                    this->_read_raw(4, data);
+                    item_done = true;
+                }
+                else
+                {
+                    VR vr = VR::UN;
+                    if(this->explicit_vr)
+                    {
+                        vr = as_vr(read_header(2));
+                    }
+
+                    uint32_t element_length;
+                    if(!this->explicit_vr)
+                    {
+                        element_length = decode<uint32_t>(
+                            &read_header(4)[0], this->byte_ordering);
+                    }
+                    else if(has_long_length(vr, this->explicit_vr))
+                    {
+                        element_length = decode<uint32_t>(
+                            &read_header(6)[2], this->byte_ordering);
+                    }
+                    else
+                    {
+                        element_length = decode<uint16_t>(
+                            &read_header(2)[0], this->byte_ordering);
+                    }
+                    this->_read_raw_value(element_length, data);
+                }
+            }
+        }
+    }
+}
+
+void
+Reader
+::_read_raw(std::size_t size, std::string * data) const
+{
+    if(size == 0)
+    {
+        return;
+    }
+    else if(data == nullptr)
+    {
+        // Seek over the value when possible: the skipped bytes are never
+        // read, e.g. from a memory-mapped file.
+        auto const begin = this->stream.tellg();
+        if(begin == std::streampos(-1))
+        {
+            Reader::ignore(this->stream, size);
+        }
+        else
+        {
+            if(this->_stream_end == std::streampos(-1))
+            {
+                this->stream.seekg(0, std::ios::end);
+                this->_stream_end = this->stream.tellg();
+                this->stream.seekg(begin);
+            }
+            if(
+                !this->stream
+                || this->_stream_end-begin < std::streamoff(size))
+            {
+                throw Exception("Could not read from stream");
+            }
+            this->stream.seekg(begin+std::streamoff(size));
+        }
+    }
+    else
+    {
+        auto const begin = data->size();
+        data->resize(begin+size);
+        Reader::read(this->stream, &(*data)[begin], size);
+    }
+}
+
 Reader::Visitor
 ::Visitor(
     std::istream & stream, VR vr, uint32_t vl,
     std::string const & transfer_syntax, ByteOrdering byte_ordering,
-    bool explicit_vr, bool keep_group_length)
+    bool explicit_vr, bool keep_group_length,
+    DataSet::MemoryResource * memory_resource)
 : stream(stream), vr(vr), vl(vl), transfer_syntax(transfer_syntax),
     byte_ordering(byte_ordering), explicit_vr(explicit_vr),
-    keep_group_length(keep_group_length)
+    keep_group_length(keep_group_length), memory_resource(memory_resource)
 {
     // Nothing else
 }
@@ -314,29 +642,13 @@ Reader::Visitor
 {
     if(this->vr == VR::IS)
     {
-        auto const string = read_string(this->stream, this->vl);
-        if(!string.empty())
+        if(this->vl != 0)
         {
-            auto const strings = this->split_strings(string);
-
-            value.resize(strings.size());
-            std::transform(
-                strings.begin(), strings.end(), value.begin(),
-                [](std::string const & s)
-                {
-                    long long value = 0;
-                    try
-                    {
-                        value = std::stoll(s);
-                    }
-                    catch(std::invalid_argument const &)
-                    {
-                        ODIL_LOG(error)
-                            << "Cannot convert \"" << s << "\" to IS, "
-                            << "setting to 0";
-                    }
-                    return static_cast<Value::Integer>(value);
-                });
+            char buffer[256];
+            std::string storage;
+            auto const * data = this->read_contiguous(
+                buffer, sizeof(buffer), storage);
+            read_is(data, data+this->vl, value);
         }
     }
     else
@@ -408,29 +720,13 @@ Reader::Visitor
 {
     if(this->vr == VR::DS)
     {
-        auto const string = read_string(this->stream, this->vl);
-        if(!string.empty())
+        if(this->vl != 0)
         {
-            auto const strings = this->split_strings(string);
-            value.resize(strings.size());
-            std::transform(
-                strings.begin(), strings.end(), value.begin(),
-                [](std::string const & s)
-                {
-                    long double value = 0;
-                    try
-                    {
-                        value = std::stold(s);
-                    }
-                    catch(std::invalid_argument const &)
-                    {
-                        ODIL_LOG(error)
-                            << "Cannot convert \"" << s << "\" to DS, "
-                            << "setting to 0";
-                    }
-                    return static_cast<Value::Real>(value);
-                }
-            );
+            char buffer[256];
+            std::string storage;
+            auto const * data = this->read_contiguous(
+                buffer, sizeof(buffer), storage);
+            read_ds(data, data+this->vl, value);
         }
     }
     else
@@ -519,13 +815,29 @@ Reader::Visitor
 {
     if(this->vl != 0xffffffff)
     {
-        // Explicit length sequence
-        std::string const data = read_string(this->stream, this->vl);
-        std::istringstream sequence_stream(data);
+        // Explicit length sequence: read the items directly from the stream
+        // if it is seekable, from a copy of the sequence otherwise.
+        auto const end = this->get_end(this->stream, this->vl);
+        std::string data;
+        std::istringstream buffered_stream;
+        if(end == std::streampos(-1))
+        {
+            data = read_string(this->stream, this->vl);
+            buffered_stream.str(data);
+        }
+        std::istream & sequence_stream =
+            (end == std::streampos(-1))?buffered_stream:this->stream;
+        auto const is_done = [&]() {
+            return
+                (end == std::streampos(-1))
+                ? (sequence_stream.peek() == EOF)
+                : (sequence_stream.tellg() >= end);
+        };
+
         Reader const sequence_reader(
             sequence_stream, this->transfer_syntax, this->keep_group_length);
 
-        bool done = (sequence_stream.peek() == EOF);
+        bool done = is_done();
         while(!done)
         {
             auto const tag = sequence_reader.read_tag();
@@ -538,7 +850,12 @@ Reader::Visitor
                 throw Exception("Expected Item, got: "+std::string(tag));
             }
 
-            done = (sequence_stream.peek() == EOF);
+            done = is_done();
+        }
+
+        if(end != std::streampos(-1) && sequence_stream.tellg() != end)
+        {
+            throw Exception("Sequence does not match its length");
         }
     }
     else
@@ -584,92 +901,66 @@ Reader::Visitor
     }
     else
     {
-        value.resize(1);
+        // Words are stored in host byte order: read the whole array at once,
+        // then swap it in place if needed.
+        std::size_t word_size;
         if(this->vr == VR::OB || this->vr == VR::UN)
         {
-            value[0].resize(this->vl);
-            this->stream.read(
-                reinterpret_cast<char*>(&value[0][0]), value[0].size());
+            word_size = 1;
         }
-        else if(this->vr == VR::OD)
+        else if(this->vr == VR::OW)
         {
-            if(this->vl%8 != 0)
-            {
-                throw Exception("Cannot read OD for odd-sized array");
-            }
-
-            value[0].resize(this->vl);
-            for(unsigned int i=0; i<value[0].size(); i+=8)
-            {
-                auto const item = Reader::read_binary<double>(
-                    this->stream, this->byte_ordering);
-                *reinterpret_cast<double*>(&value[0][i]) = item;
-            }
+            word_size = 2;
         }
-        else if(this->vr == VR::OF)
+        else if(this->vr == VR::OF || this->vr == VR::OL)
         {
-            if(this->vl%4 != 0)
-            {
-                throw Exception("Cannot read OF for odd-sized array");
-            }
-
-            value[0].resize(this->vl);
-            for(unsigned int i=0; i<value[0].size(); i+=4)
-            {
-                auto const item = Reader::read_binary<float>(
-                    this->stream, this->byte_ordering);
-                *reinterpret_cast<float*>(&value[0][i]) = item;
-            }
+            word_size = 4;
         }
-        else if(this->vr == VR::OL)
+        else if(this->vr == VR::OD || this->vr == VR::OV)
         {
-            if(this->vl%4 != 0)
-            {
-                throw Exception("Cannot read OL for odd-sized array");
-            }
-
-            value[0].resize(this->vl);
-            for(unsigned int i=0; i<value[0].size(); i+=4)
-            {
-                auto const item = Reader::read_binary<uint32_t>(
-                    this->stream, this->byte_ordering);
-                *reinterpret_cast<uint32_t*>(&value[0][i]) = item;
-            }
+            word_size = 8;
         }
-        else if(this->vr == VR::OV)
+        else
         {
-            if(this->vl%8 != 0)
-            {
-                throw Exception("Cannot read OV for odd-sized array");
-            }
-
-            value[0].resize(this->vl);
-            for(unsigned int i=0; i<value[0].size(); i+=8)
-            {
-                auto const item = Reader::read_binary<uint64_t>(
-                    this->stream, this->byte_ordering);
-                *reinterpret_cast<uint16_t*>(&value[0][i]) = item;
-            }
+            throw Exception("Cannot read "+as_string(this->vr)+" as binary");
         }
-        else if(this->vr == VR::OW)
-        {
-            if(this->vl%2 != 0)
-            {
-                throw Exception("Cannot read OW for odd-sized array");
-            }
 
-            value[0].resize(this->vl);
-            for(unsigned int i=0; i<value[0].size(); i+=2)
-            {
-                auto const item = Reader::read_binary<uint16_t>(
-                    this->stream, this->byte_ordering);
-                *reinterpret_cast<uint16_t*>(&value[0][i]) = item;
-            }
-        }
-        else
+        if(this->vl%word_size != 0)
         {
-            throw Exception("Cannot read "+as_string(this->vr)+" as binary");
+            throw Exception(
+                "Cannot read "+as_string(this->vr)+" for odd-sized array");
         }
+
+        value.resize(1);
+        value[0].resize(this->vl);
+        Reader::read(
+            this->stream, reinterpret_cast<char*>(&value[0][0]),
+            value[0].size());
+        convert_byte_ordering(
+            &value[0][0], value[0].size(), word_size, this->byte_ordering);
+    }
+}
+
+char const *
+Reader::Visitor
+::read_contiguous(
+    char * buffer, std::size_t size, std::string & storage) const
+{
+    auto const * data = Source::next(this->stream, this->vl);
+    if(data != nullptr)
+    {
+        return data;
+    }
+    else if(this->vl <= size)
+    {
+        Reader::read(this->stream, buffer, this->vl);
+        return buffer;
+    }
+    else
+    {
+        storage.resize(this->vl);
+        Reader::read(this->stream, &storage[0], storage.size());
+        return storage.data();
     }
 }
 
@@ -698,6 +989,16 @@ Reader::Visitor
     return value;
 }
 
+std::streampos
+Reader::Visitor
+::get_end(std::istream & specific_stream, uint32_t length) const
+{
+    auto const begin = specific_stream.tellg();
+    return
+        (begin == std::streampos(-1))
+        ? begin : begin+std::streamoff(length);
+}
+
 std::shared_ptr<DataSet>
 Reader::Visitor
 ::read_item(std::istream & specific_stream) const
@@ -708,18 +1009,45 @@ Reader::Visitor
     std::shared_ptr<DataSet> item;
     if(item_length != 0xffffffff)
     {
-        // Explicit length item
-        std::string const data = read_string(specific_stream, item_length);
-        std::istringstream item_stream(data);
-        Reader const item_reader(
-            item_stream, this->transfer_syntax, this->keep_group_length);
-        item = item_reader.read_data_set();
+        // Explicit length item: read the elements directly from the stream
+        // if it is seekable, from a copy of the item otherwise.
+        auto const end = this->get_end(specific_stream, item_length);
+        if(end != std::streampos(-1))
+        {
+            Reader item_reader(
+                specific_stream, this->transfer_syntax, this->keep_group_length,
+                false, this->memory_resource);
+            if(&specific_stream == &this->stream)
+            {
+                item_reader.buffer = this->buffer;
+            }
+            item = item_reader._read_data_set(
+                [](Tag const &) { return false; }, {}, end);
+            if(specific_stream.tellg() != end)
+            {
+                throw Exception("Item does not match its length");
+            }
+        }
+        else
+        {
+            std::string const data = read_string(specific_stream, item_length);
+            std::istringstream item_stream(data);
+            Reader const item_reader(
+                item_stream, this->transfer_syntax, this->keep_group_length,
+                false, this->memory_resource);
+            item = item_reader.read_data_set();
+        }
     }
     else
     {
         // Undefined length item
-        Reader const item_reader(
-            specific_stream, this->transfer_syntax, this->keep_group_length);
+        Reader item_reader(
+            specific_stream, this->transfer_syntax, this->keep_group_length,
+            false, this->memory_resource);
+        if(&specific_stream == &this->stream)
+        {
+            item_reader.buffer = this->buffer;
+        }
         item = item_reader.read_data_set(
             [](Tag const & tag) { return tag == registry::ItemDelimitationItem; });
 
@@ -9,8 +9,11 @@
 #ifndef _aa2965aa_e891_4713_9c90_e8eacd2944ea
 #define _aa2965aa_e891_4713_9c90_e8eacd2944ea
 
+#include <cstddef>
 #include <functional>
 #include <istream>
+#include <memory>
+#include <streambuf>
 #include <string>
 #include <utility>
 
@@ -44,6 +47,41 @@ public:
     /// @brief Flag to keep or discard group length tags.
     bool keep_group_length;
 
+    /**
+     * @brief Flag to defer the decoding of the values to their first access.
+     *
+     * The position and length of the encoded values are recorded, and the
+     * values are decoded once, when they are first accessed, even through a
+     * const accessor and from several threads. Values which are never
+     * accessed are written back by Writer without being decoded. If the
+     * reader has no buffer, the encoded values are copied from the stream.
+     */
+    bool lazy_decoding;
+
+    /**
+     * @brief Memory read by the stream, starting at its position 0, or null
+     * (default).
+     *
+     * The lazily-read values, and the binary, LT and UT values even if
+     * lazy_decoding is not set, reference this memory instead of copying it:
+     * they are decoded on their first access and keep the memory alive. The
+     * memory must not be modified as long as such a value is alive.
+     */
+    std::shared_ptr<char const> buffer;
+
+    /**
+     * @brief Memory resource of the data sets which are read, including the
+     * items of sequences, or null to use the default resource.
+     *
+     * A monotonic resource lets a whole data set tree be released at once;
+     * it must outlive the data sets. Only the data sets, their control blocks
+     * and their elements are allocated from the resource: the containers of
+     * the values (strings, vectors of numbers and binary items), the encoded
+     * values of lazily-read elements and the temporary strings of the parser
+     * are still allocated with the global allocator.
+     */
+    DataSet::MemoryResource * memory_resource;
+
     /**
      * @brief Read binary data from an stream encoded with the given endianness,
      * ensure stream is still good.
@@ -51,6 +89,15 @@ public:
     template<typename T>
     static T read_binary(std::istream & stream, ByteOrdering ordering);
 
+    /**
+     * @brief Read data from a stream, ensure stream is still good.
+     *
+     * The data is read directly from the buffer of the stream, without the
+     * sentry of std::istream::read: gcount is not updated, but the state of
+     * the stream is set on a short read.
+     */
+    static void read(std::istream & stream, char * data, std::size_t size);
+
     /// @brief Read pixel data in encapsulated form.
     static Value::Binary read_encapsulated_pixel_data(
         std::istream & stream, ByteOrdering byte_ordering,
@@ -65,12 +112,21 @@ public:
      */
     Reader(
         std::istream & stream, std::string const & transfer_syntax,
-        bool keep_group_length=false);
+        bool keep_group_length=false, bool lazy_decoding=false,
+        DataSet::MemoryResource * memory_resource=nullptr);
 
-    /// @brief Read a data set.
+    /**
+     * @brief Read a data set.
+     *
+     * Only the elements whose tag passes the filter are decoded, the values
+     * of the other ones are skipped. If the filter is empty, all elements
+     * are read. Since the filter is a predicate, a sorted set of tags can be
+     * used through std::binary_search.
+     */
     std::shared_ptr<DataSet> read_data_set(
         std::function<bool(Tag const &)> halt_condition =
-            [](Tag const &) { return false;}) const;
+            [](Tag const &) { return false;},
+        std::function<bool(Tag const &)> filter = {}) const;
 
     /// @brief Read a tag.
     Tag read_tag() const;
@@ -87,14 +143,118 @@ public:
         Tag const & tag=Tag(0xffff,0xffff),
         std::shared_ptr<DataSet const> data_set=std::make_shared<DataSet>()) const;
 
-    /// @brief Return the meta-data header and data set stored in the stream.
+    /**
+     * @brief Return the meta-data header and data set stored in the stream.
+     *
+     * The filter applies to the data set, cf. read_data_set; the meta-data
+     * header is always read completely. Both data sets are allocated from
+     * the memory resource, if any.
+     */
     static std::pair<std::shared_ptr<DataSet>, std::shared_ptr<DataSet>>
     read_file(
         std::istream & stream,
         bool keep_group_length=false,
-        std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;});
+        std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;},
+        bool lazy_decoding=false,
+        std::function<bool(Tag const &)> filter = {},
+        DataSet::MemoryResource * memory_resource=nullptr);
+
+    /**
+     * @brief Return the meta-data header and data set stored in the file.
+     *
+     * By default, the file is read through a stream, and the data sets own
+     * all their values.
+     *
+     * If memory_mapped is set, the file is memory-mapped and parsed in place,
+     * cf. buffer: the binary and long text values, or all values if
+     * lazy_decoding is set, are views into the mapping which are only copied
+     * when accessed, and are written by Writer without being copied. Skipped
+     * elements, cf. filter in read_data_set, are never paged in. The mapping
+     * stays open as long as such a value is alive: the file must not be
+     * modified or truncated in the meantime, which includes writing the data
+     * set back to the same path, and it cannot be removed or replaced on
+     * Windows.
+     */
+    static std::pair<std::shared_ptr<DataSet>, std::shared_ptr<DataSet>>
+    read_file(
+        std::string const & path,
+        bool keep_group_length=false,
+        std::function<bool(Tag const &)> halt_condition = [](Tag const &) { return false;},
+        bool lazy_decoding=false,
+        std::function<bool(Tag const &)> filter = {},
+        DataSet::MemoryResource * memory_resource=nullptr,
+        bool memory_mapped=false);
 
 private:
+    /**
+     * @brief Bytes of a stream, read in place from the get area of its
+     * buffer: the memory-mapped file or the string of an IStringStream, the
+     * current fragment of a received PDU, or the buffer of a file stream.
+     *
+     * The bytes are taken and skipped without a virtual call; the stream is
+     * only used as an adapter when they are not contiguous in its buffer.
+     * The position of the stream is kept, so that it can be used between two
+     * reads.
+     */
+    class Source: private std::streambuf
+    {
+    public:
+        Source() = delete;
+
+        /**
+         * @brief Return the next size bytes of the stream and skip them, or
+         * null if they are not all in the get area of its buffer.
+         *
+         * The bytes are valid until the next operation on the stream.
+         */
+        static char const * next(std::istream & stream, std::size_t size);
+
+        /**
+         * @brief Return the next size bytes of the stream and skip them,
+         * in place if possible, copied in fallback otherwise. Raise an
+         * exception if the stream is not good or is too short.
+         */
+        static char const * read(
+            std::istream & stream, std::size_t size, char * fallback);
+    };
+
+    /// @brief Read a file, the data set referencing the buffer if not null.
+    static std::pair<std::shared_ptr<DataSet>, std::shared_ptr<DataSet>>
+    _read_file(
+        std::istream & stream, std::shared_ptr<char const> const & buffer,
+        bool keep_group_length, std::function<bool(Tag const &)> halt_condition,
+        bool lazy_decoding, std::function<bool(Tag const &)> filter,
+        DataSet::MemoryResource * memory_resource);
+
+    /**
+     * @brief Read a data set up to the given position of the stream, or up to
+     * the end of the stream if end is -1.
+     */
+    std::shared_ptr<DataSet> _read_data_set(
+        std::function<bool(Tag const &)> halt_condition,
+        std::function<bool(Tag const &)> filter, std::streampos end) const;
+
+    /// @brief Skip the VR, length and value of an element.
+    void _skip_element() const;
+
+    /**
+     * @brief End of the seekable stream, computed when the first value is
+     * skipped by read_data_set, or -1.
+     */
+    mutable std::streampos _stream_end;
+
+    /// @brief Decoder shared by the lazily-read values, created on demand.
+    mutable std::shared_ptr<Element::EncodedValue::Decoder const> _decoder;
+
+    /**
+     * @brief Read the encoded bytes of a value and append them to data, or
+     * skip them if data is null.
+     */
+    void _read_raw_value(uint32_t vl, std::string * data) const;
+
+    /// @brief Read bytes and append them to data, or skip them if data is null.
+    void _read_raw(std::size_t size, std::string * data) const;
+
     struct Visitor
     {
         typedef void result_type;
@@ -107,11 +267,16 @@ private:
         ByteOrdering byte_ordering;
         bool explicit_vr;
         bool keep_group_length;
+        DataSet::MemoryResource * memory_resource;
+
+        /// @brief Memory read by the stream, passed to the items, or null.
+        std::shared_ptr<char const> buffer;
 
         Visitor(
             std::istream & stream, VR vr, uint32_t vl,
             std::string const & transfer_syntax, ByteOrdering byte_ordering,
-            bool explicit_vr, bool keep_group_length);
+            bool explicit_vr, bool keep_group_length,
+            DataSet::MemoryResource * memory_resource=nullptr);
 
         result_type operator()(Value::Integers & value) const;
         result_type operator()(Value::Reals & value) const;
@@ -121,7 +286,23 @@ private:
 
         // uint32_t read_length() const;
 
+        /**
+         * @brief Return the vl bytes of the value: in place in the buffer of
+         * the stream if possible, copied in buffer if they fit, or in
+         * storage otherwise.
+         */
+        char const * read_contiguous(
+            char * buffer, std::size_t size, std::string & storage) const;
+
         Value::Strings split_strings(std::string const & string) const;
+
+        /**
+         * @brief Return the position of the stream after length bytes, or -1
+         * if the stream is not seekable.
+         */
+        std::streampos get_end(
+            std::istream & specific_stream, uint32_t length) const;
+
         std::shared_ptr<DataSet>
         read_item(std::istream & specific_stream) const;
         Value::Binary read_encapsulated_pixel_data(
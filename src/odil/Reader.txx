@@ -11,8 +11,12 @@
 
 #include "odil/Reader.h"
 
+#include <cstddef>
+#include <cstring>
 #include <functional>
 #include <istream>
+#include <limits>
+#include <streambuf>
 #include <string>
 #include <utility>
 
@@ -33,11 +37,7 @@ Reader
 ::read_binary(std::istream & stream, ByteOrdering ordering)
 {
     T value;
-    stream.read(reinterpret_cast<char*>(&value), sizeof(value));
-    if(!stream)
-    {
-        throw Exception("Could not read from stream");
-    }
+    Reader::read(stream, reinterpret_cast<char*>(&value), sizeof(value));
     if(ordering == ByteOrdering::LittleEndian)
     {
         value = little_endian_to_host(value);
@@ -54,6 +54,80 @@ Reader
     return value;
 }
 
+inline
+void
+Reader
+::read(std::istream & stream, char * data, std::size_t size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    auto const * bytes = Source::read(stream, size, data);
+    if(bytes != data)
+    {
+        std::memcpy(data, bytes, size);
+    }
+}
+
+inline
+char const *
+Reader::Source
+::next(std::istream & stream, std::size_t size)
+{
+    // The get area of any buffer is reached through a pointer to a protected
+    // member of std::streambuf, which may only be formed in a derived class.
+    char * (std::streambuf::* const gptr)() const = &Source::gptr;
+    char * (std::streambuf::* const egptr)() const = &Source::egptr;
+    void (std::streambuf::* const gbump)(int) = &Source::gbump;
+
+    auto * buffer = stream.rdbuf();
+    if(!stream.good() || buffer == nullptr)
+    {
+        return nullptr;
+    }
+
+    char const * const begin = (buffer->*gptr)();
+    if(
+        begin == nullptr
+        || std::size_t((buffer->*egptr)()-begin) < size
+        || size > std::size_t(std::numeric_limits<int>::max()))
+    {
+        return nullptr;
+    }
+
+    (buffer->*gbump)(int(size));
+    return begin;
+}
+
+inline
+char const *
+Reader::Source
+::read(std::istream & stream, std::size_t size, char * fallback)
+{
+    // Read from the stream buffer, without the sentry of std::istream::read.
+    // gcount is not updated.
+    auto * buffer = stream.rdbuf();
+    if(!stream.good() || buffer == nullptr)
+    {
+        throw Exception("Could not read from stream");
+    }
+
+    auto const * bytes = Source::next(stream, size);
+    if(bytes != nullptr)
+    {
+        return bytes;
+    }
+    else if(buffer->sgetn(fallback, size) != std::streamsize(size))
+    {
+        stream.setstate(std::ios::eofbit | std::ios::failbit);
+        throw Exception("Could not read from stream");
+    }
+
+    return fallback;
+}
+
 }
 
 #endif // _b5ac563c_c5fd_4dcc_815c_66868a4b9614
@@ -8,6 +8,9 @@
 
 #include "SCP.h"
 
+#include <ostream>
+#include <string>
+
 #include "odil/Association.h"
 #include "odil/DataSet.h"
 #include "odil/message/Message.h"
@@ -48,8 +51,21 @@ void
 SCP
 ::receive_and_process()
 {
-    auto message = this->_association.receive_message();
+    auto message = this->_association.receive_message(
+        [this](
+            std::shared_ptr<DataSet const> command_set,
+            std::string const & transfer_syntax)
+        {
+            return this->get_data_set_stream(command_set, transfer_syntax);
+        });
     (*this)(message);
 }
 
+std::ostream *
+SCP
+::get_data_set_stream(std::shared_ptr<DataSet const>, std::string const &)
+{
+    return nullptr;
+}
+
 }
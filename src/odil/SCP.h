@@ -9,6 +9,9 @@
 #ifndef _f4680d8c_18a8_4317_956d_3ae238cb39cc
 #define _f4680d8c_18a8_4317_956d_3ae238cb39cc
 
+#include <ostream>
+#include <string>
+
 #include "odil/Association.h"
 #include "odil/DataSet.h"
 #include "odil/Exception.h"
@@ -78,6 +81,15 @@ public:
 
     /// @brief Process a message.
     virtual void operator()(std::shared_ptr<message::Message> message) =0;
+
+    /**
+     * @brief Return the stream to which the encoded data set of a request is
+     * copied instead of being decoded, or null to decode it, cf.
+     * Association::DataSetSink. Default to null.
+     */
+    virtual std::ostream * get_data_set_stream(
+        std::shared_ptr<DataSet const> command_set,
+        std::string const & transfer_syntax);
 protected:
     /// @brief Association with peer.
     Association & _association;
@@ -7,14 +7,18 @@
  ************************************************************************/
 
 #include "odil/Association.h"
+#include "odil/DataSet.h"
 #include "odil/Exception.h"
+#include "odil/registry.h"
 #include "odil/SCP.h"
 #include "odil/SCPDispatcher.h"
 #include "odil/Value.h"
 
 #include <map>
 #include <memory>
+#include <ostream>
 #include <sstream>
+#include <string>
 
 namespace odil
 {
@@ -57,7 +61,19 @@ void
 SCPDispatcher
 ::dispatch()
 {
-    auto const message = this->_association.receive_message();
+    // Let the SCP choose whether the data set is decoded.
+    auto const message = this->_association.receive_message(
+        [this](
+            std::shared_ptr<DataSet const> command_set,
+            std::string const & transfer_syntax) -> std::ostream *
+        {
+            auto const it = this->_providers.find(
+                command_set->as_int(registry::CommandField, 0));
+            return
+                (it != this->_providers.end())
+                ? it->second->get_data_set_stream(command_set, transfer_syntax)
+                : nullptr;
+        });
 
     auto const it = this->_providers.find(message->get_command_field());
     if(it == this->_providers.end())
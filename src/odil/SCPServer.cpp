@@ -0,0 +1,482 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/SCPServer.h"
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "odil/Association.h"
+#include "odil/AssociationAcceptor.h"
+#include "odil/AssociationParameters.h"
+#include "odil/Exception.h"
+#include "odil/logging.h"
+#include "odil/SCPDispatcher.h"
+
+namespace odil
+{
+
+SCPServer
+::SCPServer(
+    boost::asio::ip::tcp const & protocol, unsigned short port,
+    DispatcherFactory const & factory)
+: _endpoint(protocol, port), _factory(factory),
+  _association_acceptor(default_association_acceptor), _workers_count(4),
+  _queue_size(16), _maximum_associations(0), _maximum_associations_per_ae(0),
+  _tcp_timeout(boost::posix_time::pos_infin),
+  _negotiation_timeout(boost::posix_time::seconds(30)), _service(),
+  _acceptor(_service), _negotiation_service(), _stopped(false),
+  _listening(false), _associations_count(0)
+{
+    // Nothing else
+}
+
+SCPServer
+::~SCPServer()
+{
+    // Nothing to do: the acceptor is closed when run returns.
+}
+
+unsigned short
+SCPServer
+::get_port() const
+{
+    return this->_endpoint.port();
+}
+
+AssociationAcceptor const &
+SCPServer
+::get_association_acceptor() const
+{
+    return this->_association_acceptor;
+}
+
+void
+SCPServer
+::set_association_acceptor(AssociationAcceptor const & acceptor)
+{
+    this->_association_acceptor = acceptor;
+}
+
+unsigned int
+SCPServer
+::get_workers_count() const
+{
+    return this->_workers_count;
+}
+
+void
+SCPServer
+::set_workers_count(unsigned int count)
+{
+    if(count == 0)
+    {
+        throw Exception("At least one worker is required");
+    }
+    this->_workers_count = count;
+}
+
+std::size_t
+SCPServer
+::get_queue_size() const
+{
+    return this->_queue_size;
+}
+
+void
+SCPServer
+::set_queue_size(std::size_t size)
+{
+    this->_queue_size = size;
+}
+
+std::size_t
+SCPServer
+::get_maximum_associations() const
+{
+    return this->_maximum_associations;
+}
+
+void
+SCPServer
+::set_maximum_associations(std::size_t maximum)
+{
+    this->_maximum_associations = maximum;
+}
+
+std::size_t
+SCPServer
+::get_maximum_associations_per_ae() const
+{
+    return this->_maximum_associations_per_ae;
+}
+
+void
+SCPServer
+::set_maximum_associations_per_ae(std::size_t maximum)
+{
+    this->_maximum_associations_per_ae = maximum;
+}
+
+Association::duration_type
+SCPServer
+::get_tcp_timeout() const
+{
+    return this->_tcp_timeout;
+}
+
+void
+SCPServer
+::set_tcp_timeout(Association::duration_type const & timeout)
+{
+    this->_tcp_timeout = timeout;
+}
+
+Association::duration_type
+SCPServer
+::get_negotiation_timeout() const
+{
+    return this->_negotiation_timeout;
+}
+
+void
+SCPServer
+::set_negotiation_timeout(Association::duration_type const & timeout)
+{
+    this->_negotiation_timeout = timeout;
+}
+
+std::size_t
+SCPServer
+::get_associations_count() const
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_associations_count;
+}
+
+void
+SCPServer
+::run()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_listen_error = nullptr;
+    }
+
+    try
+    {
+        this->_acceptor.open(this->_endpoint.protocol());
+        this->_acceptor.set_option(
+            boost::asio::ip::tcp::acceptor::reuse_address(true));
+        this->_acceptor.bind(this->_endpoint);
+        this->_acceptor.listen();
+        this->_endpoint.port(this->_acceptor.local_endpoint().port());
+    }
+    catch(...)
+    {
+        boost::system::error_code ignored;
+        this->_acceptor.close(ignored);
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_listen_error = std::current_exception();
+        }
+        this->_condition.notify_all();
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_stopped = false;
+        this->_listening = true;
+    }
+    this->_condition.notify_all();
+
+    std::vector<std::thread> workers;
+    for(unsigned int i=0; i<this->_workers_count; ++i)
+    {
+        workers.emplace_back(&SCPServer::_work, this);
+    }
+
+    // The negotiations may block until their timeout: run them in their own
+    // threads, so that the current thread keeps accepting connections. The
+    // handlers do not throw.
+    std::unique_ptr<boost::asio::io_service::work> negotiation_work(
+        new boost::asio::io_service::work(this->_negotiation_service));
+    std::vector<std::thread> negotiators;
+    for(unsigned int i=0; i<this->_workers_count; ++i)
+    {
+        negotiators.emplace_back(
+            [this]() { this->_negotiation_service.run(); });
+    }
+
+    this->_accept();
+    this->_service.run();
+    this->_service.reset();
+
+    // Finish the pending negotiations.
+    negotiation_work.reset();
+    for(auto & negotiator: negotiators)
+    {
+        negotiator.join();
+    }
+    this->_negotiation_service.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_stopped = true;
+        this->_listening = false;
+    }
+    this->_condition.notify_all();
+    for(auto & worker: workers)
+    {
+        worker.join();
+    }
+}
+
+void
+SCPServer
+::wait_listening()
+{
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    this->_condition.wait(
+        lock,
+        [this]() { return this->_listening || this->_listen_error; });
+    if(this->_listen_error)
+    {
+        std::rethrow_exception(this->_listen_error);
+    }
+}
+
+void
+SCPServer
+::stop()
+{
+    this->_service.post(
+        [this]()
+        {
+            boost::system::error_code ignored;
+            this->_acceptor.close(ignored);
+        });
+}
+
+void
+SCPServer
+::_accept()
+{
+    auto association = std::make_shared<Association>();
+    association->set_tcp_timeout(this->_negotiation_timeout);
+    association->get_transport().async_receive(
+        this->_acceptor,
+        [this, association](boost::system::error_code const & error)
+        {
+            if(
+                error == boost::asio::error::operation_aborted
+                || !this->_acceptor.is_open())
+            {
+                return;
+            }
+
+            if(error)
+            {
+                ODIL_LOG(warning)
+                    << "Cannot accept connection: " << error.message();
+            }
+            else
+            {
+                this->_negotiation_service.post(
+                    [this, association]() { this->_negotiate(association); });
+            }
+            this->_accept();
+        });
+}
+
+void
+SCPServer
+::_negotiate(std::shared_ptr<Association> association)
+{
+    std::string calling_ae_title;
+    bool counted = false;
+    try
+    {
+        association->receive_association(
+            [this, &calling_ae_title, &counted](
+                AssociationParameters const & request)
+            {
+                calling_ae_title = request.get_calling_ae_title();
+                auto const parameters = this->_check_request(request);
+                counted = true;
+                return parameters;
+            });
+        association->set_tcp_timeout(this->_tcp_timeout);
+    }
+    catch(AssociationRejected const & e)
+    {
+        ODIL_LOG(info)
+            << "Association from " << association->get_peer_host()
+            << " rejected: " << e.what();
+        return;
+    }
+    catch(std::exception const & e)
+    {
+        ODIL_LOG(warning) << "Cannot negotiate association: " << e.what();
+        if(counted)
+        {
+            this->_release(calling_ae_title);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_queue.push_back({association, calling_ae_title});
+    }
+    this->_condition.notify_one();
+}
+
+AssociationParameters
+SCPServer
+::_check_request(AssociationParameters const & request)
+{
+    {
+        // Count the association with the check, so that concurrent
+        // negotiations cannot exceed the limits.
+        std::lock_guard<std::mutex> lock(this->_mutex);
+
+        if(
+            this->_associations_count >= this->_workers_count+this->_queue_size
+            || (
+                this->_maximum_associations != 0
+                && this->_associations_count >= this->_maximum_associations))
+        {
+            throw AssociationRejected(
+                Association::RejectedTransient,
+                Association::ULServiceProvderPresentationRelatedFunction,
+                Association::TemporaryCongestion,
+                "Too many associations");
+        }
+
+        if(this->_maximum_associations_per_ae != 0)
+        {
+            auto const it = this->_associations_per_ae.find(
+                request.get_calling_ae_title());
+            if(
+                it != this->_associations_per_ae.end()
+                && it->second >= this->_maximum_associations_per_ae)
+            {
+                throw AssociationRejected(
+                    Association::RejectedTransient,
+                    Association::ULServiceProvderPresentationRelatedFunction,
+                    Association::LocalLimitExceeded,
+                    "Too many associations from "
+                        + request.get_calling_ae_title());
+            }
+        }
+
+        ++this->_associations_count;
+        ++this->_associations_per_ae[request.get_calling_ae_title()];
+    }
+
+    try
+    {
+        return this->_association_acceptor(request);
+    }
+    catch(...)
+    {
+        this->_release(request.get_calling_ae_title());
+        throw;
+    }
+}
+
+void
+SCPServer
+::_release(std::string const & calling_ae_title)
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    --this->_associations_count;
+    auto const it = this->_associations_per_ae.find(calling_ae_title);
+    --it->second;
+    if(it->second == 0)
+    {
+        this->_associations_per_ae.erase(it);
+    }
+}
+
+void
+SCPServer
+::_work()
+{
+    while(true)
+    {
+        Client client;
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_condition.wait(
+                lock,
+                [this]() { return this->_stopped || !this->_queue.empty(); });
+            // Drain the queue before stopping.
+            if(this->_queue.empty())
+            {
+                return;
+            }
+            client = this->_queue.front();
+            this->_queue.pop_front();
+        }
+
+        this->_serve(client);
+        this->_release(client.calling_ae_title);
+    }
+}
+
+void
+SCPServer
+::_serve(Client const & client)
+{
+    auto & association = *client.association;
+    try
+    {
+        auto const dispatcher = this->_factory(association);
+        while(true)
+        {
+            dispatcher->dispatch();
+        }
+    }
+    catch(AssociationReleased const &)
+    {
+        // Normal end of the association.
+    }
+    catch(AssociationAborted const &)
+    {
+        // Peer has left.
+    }
+    catch(std::exception const & e)
+    {
+        ODIL_LOG(error)
+            << "Association from " << client.calling_ae_title
+            << " aborted: " << e.what();
+        try
+        {
+            if(association.is_associated())
+            {
+                association.abort(0, 0);
+            }
+        }
+        catch(...)
+        {
+            // Nothing more can be done with this association.
+        }
+    }
+}
+
+}
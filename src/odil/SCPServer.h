@@ -0,0 +1,216 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _3e8a5d2c_9f41_4b6e_a0d7_6c1f2b84e953
+#define _3e8a5d2c_9f41_4b6e_a0d7_6c1f2b84e953
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <boost/asio.hpp>
+
+#include "odil/Association.h"
+#include "odil/AssociationAcceptor.h"
+#include "odil/odil.h"
+#include "odil/SCPDispatcher.h"
+
+namespace odil
+{
+
+/**
+ * @brief Server accepting associations from many peers, each association
+ * being served by a worker thread with its own SCPDispatcher.
+ *
+ * The connections are accepted by the thread calling run, and negotiated by
+ * as many negotiation threads as there are workers, within the negotiation
+ * timeout: a peer which does not send its request does not delay the other
+ * connections. Accepted associations wait in a bounded queue until a worker
+ * is available; when the queue is full or when too many associations are
+ * open, new associations are rejected (transient rejection, Temporary
+ * Congestion). The number of associations from a single calling AE title may
+ * also be limited (transient rejection, Local Limit Exceeded).
+ *
+ * The settings must not be modified while the server is running.
+ */
+class ODIL_API SCPServer
+{
+public:
+    /**
+     * @brief Create the dispatcher, and its SCPs, serving an association. It
+     * is called by the worker thread.
+     */
+    typedef std::function<
+            std::shared_ptr<SCPDispatcher>(Association &)
+        > DispatcherFactory;
+
+    /// @brief Create a server listening on the given port.
+    SCPServer(
+        boost::asio::ip::tcp const & protocol, unsigned short port,
+        DispatcherFactory const & factory);
+
+    SCPServer(SCPServer const &) = delete;
+    SCPServer & operator=(SCPServer const &) = delete;
+
+    /// @brief Destructor, the server must not be running.
+    ~SCPServer();
+
+    /// @brief Return the port, updated by run if it was 0.
+    unsigned short get_port() const;
+
+    /// @brief Return the callback checking the association requests.
+    AssociationAcceptor const & get_association_acceptor() const;
+
+    /// @brief Set the callback checking the association requests.
+    void set_association_acceptor(AssociationAcceptor const & acceptor);
+
+    /// @brief Return the number of worker threads, default to 4.
+    unsigned int get_workers_count() const;
+
+    /// @brief Set the number of worker threads.
+    void set_workers_count(unsigned int count);
+
+    /**
+     * @brief Return the number of accepted associations which may wait for a
+     * worker, default to 16.
+     */
+    std::size_t get_queue_size() const;
+
+    /// @brief Set the number of associations which may wait for a worker.
+    void set_queue_size(std::size_t size);
+
+    /**
+     * @brief Return the maximum number of open associations, default to 0
+     * (no limit other than the workers and the queue).
+     */
+    std::size_t get_maximum_associations() const;
+
+    /// @brief Set the maximum number of open associations.
+    void set_maximum_associations(std::size_t maximum);
+
+    /**
+     * @brief Return the maximum number of open associations with the same
+     * calling AE title, default to 0 (no limit).
+     */
+    std::size_t get_maximum_associations_per_ae() const;
+
+    /**
+     * @brief Set the maximum number of open associations with the same
+     * calling AE title.
+     */
+    void set_maximum_associations_per_ae(std::size_t maximum);
+
+    /**
+     * @brief Return the TCP timeout of the negotiated associations, default
+     * to infinity.
+     */
+    Association::duration_type get_tcp_timeout() const;
+
+    /**
+     * @brief Set the TCP timeout of the negotiated associations. A finite
+     * timeout closes idle associations.
+     */
+    void set_tcp_timeout(Association::duration_type const & timeout);
+
+    /**
+     * @brief Return the TCP timeout of the negotiation of an association,
+     * default to 30 s.
+     */
+    Association::duration_type get_negotiation_timeout() const;
+
+    /**
+     * @brief Set the TCP timeout of the negotiation of an association: a
+     * peer which does not complete its negotiation within this timeout is
+     * disconnected.
+     */
+    void set_negotiation_timeout(Association::duration_type const & timeout);
+
+    /// @brief Return the number of open associations, waiting or served.
+    std::size_t get_associations_count() const;
+
+    /**
+     * @brief Accept and serve associations until stop is called, then wait
+     * for the open associations to finish.
+     */
+    void run();
+
+    /**
+     * @brief Wait until run listens for connections, may be called from any
+     * thread. Peers may then connect, and the port is known. If run cannot
+     * listen (e.g. the port is already in use), its error is thrown.
+     */
+    void wait_listening();
+
+    /// @brief Stop accepting associations, may be called from any thread.
+    void stop();
+
+private:
+    /// @brief Accepted association.
+    struct Client
+    {
+        std::shared_ptr<Association> association;
+        std::string calling_ae_title;
+    };
+
+    boost::asio::ip::tcp::endpoint _endpoint;
+    DispatcherFactory _factory;
+    AssociationAcceptor _association_acceptor;
+    unsigned int _workers_count;
+    std::size_t _queue_size;
+    std::size_t _maximum_associations;
+    std::size_t _maximum_associations_per_ae;
+    Association::duration_type _tcp_timeout;
+    Association::duration_type _negotiation_timeout;
+
+    boost::asio::io_service _service;
+    boost::asio::ip::tcp::acceptor _acceptor;
+
+    /// @brief Service run by the negotiation threads.
+    boost::asio::io_service _negotiation_service;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stopped;
+    bool _listening;
+    /// @brief Error of run while setting up the listening socket.
+    std::exception_ptr _listen_error;
+    std::deque<Client> _queue;
+    std::size_t _associations_count;
+    std::map<std::string, std::size_t> _associations_per_ae;
+
+    /// @brief Accept the next connection.
+    void _accept();
+
+    /// @brief Negotiate an association on an accepted connection.
+    void _negotiate(std::shared_ptr<Association> association);
+
+    /**
+     * @brief Check the limits, count the association, and call the user
+     * acceptor.
+     */
+    AssociationParameters _check_request(AssociationParameters const & request);
+
+    /// @brief Stop counting an association.
+    void _release(std::string const & calling_ae_title);
+
+    /// @brief Serve the queued associations until the server is stopped.
+    void _work();
+
+    /// @brief Dispatch the messages of an association until it is closed.
+    void _serve(Client const & client);
+};
+
+}
+
+#endif // _3e8a5d2c_9f41_4b6e_a0d7_6c1f2b84e953
@@ -0,0 +1,209 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/SegmentStream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace odil
+{
+
+SegmentStream
+::SegmentStream()
+: std::ostream(nullptr), _buffer(0, Consumer())
+{
+    this->rdbuf(&this->_buffer);
+}
+
+SegmentStream
+::SegmentStream(std::size_t flush_size, Consumer const & consumer)
+: std::ostream(nullptr), _buffer(flush_size, consumer)
+{
+    this->rdbuf(&this->_buffer);
+    // Without badbit in the mask, std::ostream swallows the exceptions of the
+    // consumer, e.g. AssociationAborted, and only sets the state.
+    this->exceptions(std::ios_base::badbit);
+}
+
+void
+SegmentStream
+::write_reference(char const * data, std::size_t size)
+{
+    this->_buffer.write_reference(data, size);
+}
+
+std::vector<SegmentStream::Segment> const &
+SegmentStream
+::get_segments()
+{
+    return this->_buffer.get_segments();
+}
+
+std::size_t
+SegmentStream
+::size() const
+{
+    return this->_buffer.size();
+}
+
+SegmentStream::Buffer
+::Buffer(std::size_t flush_size, Consumer const & consumer)
+: _segments_size(0), _flush_size(flush_size), _consumer(consumer)
+{
+    // Nothing else
+}
+
+void
+SegmentStream::Buffer
+::write_reference(char const * data, std::size_t size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    this->_close_chunk();
+    this->_segments.push_back({data, size});
+    this->_owned.push_back(false);
+    this->_segments_size += size;
+
+    this->_flush();
+}
+
+std::vector<SegmentStream::Segment> const &
+SegmentStream::Buffer
+::get_segments()
+{
+    this->_close_chunk();
+    return this->_segments;
+}
+
+std::size_t
+SegmentStream::Buffer
+::size() const
+{
+    return this->_segments_size+(this->pptr()-this->pbase());
+}
+
+SegmentStream::Buffer::int_type
+SegmentStream::Buffer
+::overflow(int_type c)
+{
+    static std::size_t const initial_size = 4096;
+
+    if(
+        this->_consumer && this->pbase() != nullptr
+        && this->size() >= this->_flush_size)
+    {
+        // Hand the content to the consumer before growing the chunk.
+        this->_close_chunk();
+        this->_flush();
+    }
+
+    if(this->pbase() == nullptr)
+    {
+        // Start a new chunk
+        this->_chunks.emplace_back(initial_size, '\0');
+        auto & chunk = this->_chunks.back();
+        this->setp(&chunk[0], &chunk[0]+chunk.size());
+    }
+    else if(this->pptr() == this->epptr())
+    {
+        // Grow the current chunk
+        auto & chunk = this->_chunks.back();
+        std::size_t const used = this->pptr()-this->pbase();
+        chunk.resize(2*chunk.size());
+        this->setp(&chunk[0], &chunk[0]+chunk.size());
+        // pbump only takes an int
+        for(auto remaining = used; remaining > 0; )
+        {
+            auto const step = std::min<std::size_t>(remaining, 1<<30);
+            this->pbump(int(step));
+            remaining -= step;
+        }
+    }
+
+    if(!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *this->pptr() = traits_type::to_char_type(c);
+        this->pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+void
+SegmentStream::Buffer
+::_close_chunk()
+{
+    if(this->pbase() == nullptr)
+    {
+        return;
+    }
+
+    auto & chunk = this->_chunks.back();
+    std::size_t const used = this->pptr()-this->pbase();
+    this->setp(nullptr, nullptr);
+
+    if(used == 0)
+    {
+        this->_chunks.pop_back();
+    }
+    else
+    {
+        // Shrinking does not move the data.
+        chunk.resize(used);
+        this->_segments.push_back({chunk.data(), used});
+        this->_owned.push_back(true);
+        this->_segments_size += used;
+    }
+}
+
+void
+SegmentStream::Buffer
+::_flush()
+{
+    if(!this->_consumer || this->_segments_size < this->_flush_size)
+    {
+        return;
+    }
+
+    auto remaining = this->_consumer(this->_segments);
+    this->_segments_size -= remaining;
+
+    // Remove the consumed segments, and the chunks they own. Chunks are
+    // closed in order, so the owned segments match the front of the chunks.
+    std::size_t count = 0;
+    while(remaining > 0)
+    {
+        auto & segment = this->_segments[count];
+        if(remaining < segment.size)
+        {
+            segment.data += remaining;
+            segment.size -= remaining;
+            remaining = 0;
+        }
+        else
+        {
+            remaining -= segment.size;
+            if(this->_owned[count])
+            {
+                this->_chunks.pop_front();
+            }
+            ++count;
+        }
+    }
+    this->_segments.erase(
+        this->_segments.begin(), this->_segments.begin()+count);
+    this->_owned.erase(this->_owned.begin(), this->_owned.begin()+count);
+}
+
+}
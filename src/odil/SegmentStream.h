@@ -0,0 +1,108 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _7b0e2f6d_5a1c_4f93_b8d4_2c6e9a13f05b
+#define _7b0e2f6d_5a1c_4f93_b8d4_2c6e9a13f05b
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "odil/odil.h"
+
+namespace odil
+{
+
+/**
+ * @brief Output stream whose content is a list of segments: data written
+ * through the stream is copied in buffers owned by the stream, while large
+ * external buffers (e.g. pixel data) are referenced without being copied.
+ *
+ * The segments can then be sent with vectored I/O. The referenced data must
+ * outlive the segments.
+ *
+ * If a consumer is specified, it receives the segments each time the size of
+ * the content reaches the flush size, and the bytes it consumed are removed
+ * from the content: the content can be sent while it is being written. The
+ * exceptions thrown by the consumer are propagated through the write
+ * operations of the stream.
+ */
+class ODIL_API SegmentStream: public std::ostream
+{
+public:
+    /// @brief Contiguous part of the content.
+    struct Segment
+    {
+        char const * data;
+        std::size_t size;
+    };
+
+    /**
+     * @brief Callback receiving the segments of the content, returning the
+     * number of bytes it consumed from the start of the content.
+     */
+    typedef std::function<std::size_t(std::vector<Segment> const &)> Consumer;
+
+    /// @brief Create an empty stream.
+    SegmentStream();
+
+    /// @brief Create an empty stream flushed to the consumer.
+    SegmentStream(std::size_t flush_size, Consumer const & consumer);
+
+    SegmentStream(SegmentStream const &) = delete;
+    SegmentStream & operator=(SegmentStream const &) = delete;
+
+    /// @brief Append a reference to external data to the content.
+    void write_reference(char const * data, std::size_t size);
+
+    /// @brief Return the segments of the content, in order.
+    std::vector<Segment> const & get_segments();
+
+    /// @brief Return the size of the content.
+    std::size_t size() const;
+
+private:
+    class Buffer: public std::streambuf
+    {
+    public:
+        Buffer(std::size_t flush_size, Consumer const & consumer);
+
+        void write_reference(char const * data, std::size_t size);
+        std::vector<Segment> const & get_segments();
+        std::size_t size() const;
+
+    protected:
+        int_type overflow(int_type c) override;
+
+    private:
+        std::deque<std::string> _chunks;
+        std::vector<Segment> _segments;
+        /// @brief Whether each segment is a chunk, or references external data.
+        std::vector<bool> _owned;
+        std::size_t _segments_size;
+
+        std::size_t _flush_size;
+        Consumer _consumer;
+
+        /// @brief Add the current chunk, if any, to the segments.
+        void _close_chunk();
+
+        /// @brief Pass the segments to the consumer if the content is large enough.
+        void _flush();
+    };
+
+    Buffer _buffer;
+};
+
+}
+
+#endif // _7b0e2f6d_5a1c_4f93_b8d4_2c6e9a13f05b
@@ -8,10 +8,16 @@
 
 #include "odil/StoreSCP.h"
 
+#include <cstddef>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <string>
 
 #include "odil/Association.h"
+#include "odil/DataSet.h"
 #include "odil/Exception.h"
+#include "odil/registry.h"
 #include "odil/SCP.h"
 #include "odil/Value.h"
 #include "odil/message/CStoreRequest.h"
@@ -50,9 +56,78 @@ StoreSCP
     this->_callback = callback;
 }
 
+Association::DataSetSink const &
+StoreSCP
+::get_data_set_sink() const
+{
+    return this->_data_set_sink;
+}
+
+void
+StoreSCP
+::set_data_set_sink(Association::DataSetSink const & sink)
+{
+    this->_data_set_sink = sink;
+}
+
+std::ostream *
+StoreSCP
+::get_data_set_stream(
+    std::shared_ptr<DataSet const> command_set,
+    std::string const & transfer_syntax)
+{
+    return
+        this->_data_set_sink
+        ? this->_data_set_sink(command_set, transfer_syntax)
+        : nullptr;
+}
+
+struct StoreSCP::Service
+{
+    Association::Handler handler;
+
+    /// @brief Maximum number of requests processed concurrently, 0 if unlimited.
+    std::size_t maximum_operations;
+
+    /// @brief Number of requests being processed.
+    std::size_t operations;
+
+    bool receiving;
+    bool done;
+    std::exception_ptr error;
+};
+
 void
 StoreSCP
 ::operator()(std::shared_ptr<message::CStoreRequest> request)
+{
+    auto const response = this->_process(request);
+    this->_association.send_message(
+        response, request->get_affected_sop_class_uid());
+}
+
+void
+StoreSCP
+::async_serve(Association::Handler const & handler)
+{
+    auto const service = std::make_shared<Service>();
+    service->handler = handler;
+    // Outstanding operations invoked by the requestor, cf. PS 3.7, D.3.3.3.
+    service->maximum_operations = this->_association.get_negotiated_parameters()
+        .get_maximum_number_operations_invoked();
+    service->operations = 0;
+    service->receiving = false;
+    service->done = false;
+
+    // The state of the service is only accessed by the strand of the
+    // association.
+    this->_association.get_transport().get_strand().dispatch(
+        [this, service]() { this->_async_receive(service); });
+}
+
+std::shared_ptr<message::CStoreResponse>
+StoreSCP
+::_process(std::shared_ptr<message::CStoreRequest> request)
 {
     Value::Integer status=message::CStoreResponse::Success;
     std::shared_ptr<DataSet> status_fields;
@@ -74,14 +149,138 @@ StoreSCP
     auto response = std::make_shared<message::CStoreResponse>(
         request->get_message_id(), status);
     response->set_status_fields(status_fields);
-    this->_association.send_message(
-        response, request->get_affected_sop_class_uid());
+    return response;
+}
+
+void
+StoreSCP
+::_async_receive(std::shared_ptr<Service> service)
+{
+    if(
+        service->done || service->receiving
+        || (
+            service->maximum_operations != 0
+            && service->operations >= service->maximum_operations))
+    {
+        return;
+    }
+
+    service->receiving = true;
+    this->_association.async_receive_message(
+        [this, service](
+            std::shared_ptr<message::Message> message, std::exception_ptr error)
+        {
+            service->receiving = false;
+            if(error)
+            {
+                // Release or abort by the peer, or transport error.
+                if(!service->done)
+                {
+                    service->done = true;
+                    service->error = error;
+                }
+                this->_async_finish(service);
+            }
+            else
+            {
+                this->_async_process(service, message);
+                this->_async_receive(service);
+            }
+        });
+}
+
+void
+StoreSCP
+::_async_process(
+    std::shared_ptr<Service> service, std::shared_ptr<message::Message> message)
+{
+    ++service->operations;
+
+    // Run the callback outside of the strand, concurrently with the other
+    // requests.
+    auto & transport = this->_association.get_transport();
+    transport.get_service().post([this, &transport, service, message]() {
+        std::shared_ptr<message::CStoreRequest> request;
+        std::shared_ptr<message::CStoreResponse> response;
+        try
+        {
+            request = std::make_shared<message::CStoreRequest>(message);
+            response = this->_process(request);
+        }
+        catch(...)
+        {
+            // Invalid request: the association cannot be trusted anymore.
+            auto const error = std::current_exception();
+            transport.get_strand().dispatch([this, service, error]() {
+                --service->operations;
+                if(!service->done)
+                {
+                    service->done = true;
+                    service->error = error;
+                    try
+                    {
+                        this->_association.abort(0, 0);
+                    }
+                    catch(...)
+                    {
+                        // Nothing more can be done with this association.
+                    }
+                }
+                this->_async_finish(service);
+            });
+            return;
+        }
+
+        this->_association.async_send_message(
+            response, request->get_affected_sop_class_uid(),
+            [this, service, response](std::exception_ptr error)
+            {
+                --service->operations;
+                if(error && !service->done)
+                {
+                    service->done = true;
+                    service->error = error;
+                }
+                this->_async_receive(service);
+                this->_async_finish(service);
+            });
+    });
+}
+
+void
+StoreSCP
+::_async_finish(std::shared_ptr<Service> service)
+{
+    if(service->done && !service->receiving && service->operations == 0)
+    {
+        auto const handler = service->handler;
+        // Make sure the handler is only called once.
+        service->handler = Association::Handler();
+        if(handler)
+        {
+            handler(service->error);
+        }
+    }
 }
 
 void
 StoreSCP
 ::operator()(std::shared_ptr<message::Message> message)
 {
+    auto data_set = message->get_data_set();
+    if(message->is_data_set_streamed())
+    {
+        // The data set was written to the sink: identify the instance from
+        // the command set.
+        auto const command_set = message->get_command_set();
+        data_set->add(
+            registry::SOPClassUID,
+            {command_set->as_string(registry::AffectedSOPClassUID, 0)});
+        data_set->add(
+            registry::SOPInstanceUID,
+            {command_set->as_string(registry::AffectedSOPInstanceUID, 0)});
+    }
+
     auto request = std::make_shared<message::CStoreRequest>(message);
     this->operator()(request);
 }
@@ -10,12 +10,17 @@
 #define _fdbf3f51_91f5_464a_b449_c3f994297210
 
 #include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
 
 #include "odil/Association.h"
+#include "odil/DataSet.h"
 #include "odil/odil.h"
 #include "odil/SCP.h"
 #include "odil/Value.h"
 #include "odil/message/CStoreRequest.h"
+#include "odil/message/CStoreResponse.h"
 #include "odil/message/Message.h"
 
 namespace odil
@@ -45,13 +50,61 @@ public:
     /// @brief Set the callback.
     void set_callback(Callback const & callback);
 
+    /// @brief Return the sink of the data sets.
+    Association::DataSetSink const & get_data_set_sink() const;
+
+    /**
+     * @brief Set the sink of the data sets: if it returns a stream, the
+     * encoded data set of a request is copied to it as it is received, and
+     * the data set of the request passed to the callback only contains the
+     * SOP Class UID and the SOP Instance UID.
+     */
+    void set_data_set_sink(Association::DataSetSink const & sink);
+
     /// @brief Process a C-Store request.
     void operator()(std::shared_ptr<message::CStoreRequest> request);
 
+    /**
+     * @brief Receive and process the C-Store requests of an asynchronous
+     * association until it is released or aborted; the handler is then called
+     * with the corresponding error.
+     *
+     * Up to the negotiated maximum number of operations invoked, requests
+     * are processed concurrently by the threads running the io_service of the
+     * association, and each response is sent as soon as its request is
+     * processed. The callback must then be thread-safe. The data set sink is
+     * not used.
+     */
+    void async_serve(Association::Handler const & handler);
+
     /// @brief Process a C-Store request.
     virtual void operator()(std::shared_ptr<message::Message> message);
+
+    /// @brief Call the sink of the data sets, if any.
+    virtual std::ostream * get_data_set_stream(
+        std::shared_ptr<DataSet const> command_set,
+        std::string const & transfer_syntax);
 private:
+    /// @brief State of the asynchronous processing of requests.
+    struct Service;
+
     Callback _callback;
+    Association::DataSetSink _data_set_sink;
+
+    /// @brief Call the callback and return the response.
+    std::shared_ptr<message::CStoreResponse> _process(
+        std::shared_ptr<message::CStoreRequest> request);
+
+    /// @brief Receive the next request if the window allows it.
+    void _async_receive(std::shared_ptr<Service> service);
+
+    /// @brief Process a request and send its response.
+    void _async_process(
+        std::shared_ptr<Service> service,
+        std::shared_ptr<message::Message> message);
+
+    /// @brief Call the handler once the association is over and idle.
+    void _async_finish(std::shared_ptr<Service> service);
 };
 
 }
@@ -9,12 +9,16 @@
 #include "StoreSCU.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "odil/message/CStoreRequest.h"
 #include "odil/message/CStoreResponse.h"
+#include "odil/AssociationParameters.h"
 #include "odil/DataSet.h"
 #include "odil/Exception.h"
 #include "odil/logging.h"
@@ -74,6 +78,98 @@ StoreSCU
     this->_store(request);
 }
 
+void
+StoreSCU
+::store(
+    std::vector<std::shared_ptr<DataSet>> const & data_sets,
+    StoreCallback callback) const
+{
+    auto data_set_it = data_sets.begin();
+    this->store(
+        [&]()
+        {
+            return
+                (data_set_it != data_sets.end())
+                ? *(data_set_it++) : std::shared_ptr<DataSet>();
+        },
+        [&callback](
+            std::shared_ptr<DataSet const>,
+            std::shared_ptr<message::CStoreResponse const> response)
+        {
+            if(callback)
+            {
+                callback(response);
+            }
+        });
+}
+
+void
+StoreSCU
+::store(DataSetSource const & source, DataSetCallback const & callback) const
+{
+    auto const maximum_outstanding = this->get_maximum_outstanding_requests();
+
+    std::map<
+            Value::Integer, std::shared_ptr<message::CStoreRequest const>
+        > outstanding;
+    bool exhausted = false;
+    while(!exhausted || !outstanding.empty())
+    {
+        if(
+            !exhausted
+            && (
+                maximum_outstanding == 0
+                || outstanding.size() < maximum_outstanding))
+        {
+            auto const data_set = source();
+            if(!data_set)
+            {
+                exhausted = true;
+                continue;
+            }
+
+            auto const request = std::make_shared<message::CStoreRequest const>(
+                this->_association.next_message_id(),
+                data_set->as_string(registry::SOPClassUID, 0),
+                data_set->as_string(registry::SOPInstanceUID, 0),
+                message::Message::Priority::MEDIUM, data_set);
+            this->_send(request);
+            outstanding[request->get_message_id()] = request;
+        }
+        else
+        {
+            auto const response =
+                std::make_shared<message::CStoreResponse const>(
+                    this->_association.receive_message());
+
+            auto const request_it = outstanding.find(
+                response->get_message_id_being_responded_to());
+            if(request_it == outstanding.end())
+            {
+                std::ostringstream message;
+                message << "DIMSE: Unexpected Response MsgId: "
+                        << response->get_message_id_being_responded_to();
+                throw Exception(message.str());
+            }
+            auto const request = request_it->second;
+            outstanding.erase(request_it);
+
+            this->_check_response(*request, *response);
+            callback(request->get_data_set(), response);
+        }
+    }
+}
+
+std::size_t
+StoreSCU
+::get_maximum_outstanding_requests() const
+{
+    // In the A-ASSOCIATE-AC, the number of operations invoked is the number
+    // of outstanding operations the requestor may invoke (PS 3.7, D.3.3.3).
+    return this->_association.get_negotiated_parameters()
+        .get_maximum_number_operations_invoked();
+}
+
 void
 StoreSCU
 ::_store(std::shared_ptr<message::CStoreRequest const> request) const
@@ -92,32 +188,89 @@ StoreSCU
         throw Exception(message.str());
     }
 
-    if(response->has_affected_sop_class_uid() &&
-       response->get_affected_sop_class_uid() != request->get_affected_sop_class_uid())
+    this->_check_response(*request, *response);
+}
+
+void
+StoreSCU
+::_send(std::shared_ptr<message::CStoreRequest const> request) const
+{
+    // Send the data set as it is if its transfer syntax was accepted, or else
+    // re-encode it to a native transfer syntax, which the writer supports.
+    auto const & sop_class = request->get_affected_sop_class_uid();
+    auto const & transfer_syntax =
+        request->get_data_set()->get_transfer_syntax();
+    std::string native;
+    for(auto const & presentation_context:
+        this->_association.get_negotiated_parameters().get_presentation_contexts())
+    {
+        if(
+            presentation_context.result
+                != AssociationParameters::PresentationContext::Result::Acceptance
+            || presentation_context.abstract_syntax != sop_class)
+        {
+            continue;
+        }
+
+        auto const & accepted = presentation_context.transfer_syntaxes[0];
+        if(accepted == transfer_syntax)
+        {
+            this->_association.send_message(request, sop_class, accepted);
+            return;
+        }
+        else if(
+            native.empty()
+            && (
+                accepted == registry::ImplicitVRLittleEndian
+                || accepted == registry::ExplicitVRLittleEndian
+                || accepted == registry::ExplicitVRBigEndian))
+        {
+            native = accepted;
+        }
+    }
+
+    if(!native.empty())
+    {
+        this->_association.send_message(request, sop_class, native);
+    }
+    else
+    {
+        this->_association.send_message(request, sop_class);
+    }
+}
+
+void
+StoreSCU
+::_check_response(
+    message::CStoreRequest const & request,
+    message::CStoreResponse const & response) const
+{
+    if(response.has_affected_sop_class_uid() &&
+       response.get_affected_sop_class_uid() != request.get_affected_sop_class_uid())
     {
         std::ostringstream message;
         message << "DIMSE: Unexpected Response Affected SOP Class UID: "
-                << response->get_affected_sop_class_uid()
-                << " (expected: " << request->get_affected_sop_class_uid() << ")";
+                << response.get_affected_sop_class_uid()
+                << " (expected: " << request.get_affected_sop_class_uid() << ")";
         throw Exception(message.str());
     }
-    if(response->has_affected_sop_instance_uid() &&
-       response->get_affected_sop_instance_uid() != request->get_affected_sop_instance_uid())
+    if(response.has_affected_sop_instance_uid() &&
+       response.get_affected_sop_instance_uid() != request.get_affected_sop_instance_uid())
     {
         std::ostringstream message;
         message << "DIMSE: Unexpected Response Affected SOP Instance UID: "
-                << response->get_affected_sop_instance_uid()
-                << " (expected: " << request->get_affected_sop_instance_uid() << ")";
+                << response.get_affected_sop_instance_uid()
+                << " (expected: " << request.get_affected_sop_instance_uid() << ")";
         throw Exception(message.str());
     }
 
-    if(message::Response::is_warning(response->get_status()))
+    if(message::Response::is_warning(response.get_status()))
     {
-        ODIL_LOG(warning) << "C-STORE response status: " << response->get_status();
+        ODIL_LOG(warning) << "C-STORE response status: " << response.get_status();
     }
-    else if(message::Response::is_failure(response->get_status()))
+    else if(message::Response::is_failure(response.get_status()))
     {
-        ODIL_LOG(error) << "C-STORE response status: " << response->get_status();
+        ODIL_LOG(error) << "C-STORE response status: " << response.get_status();
     }
 }
 
@@ -9,9 +9,15 @@
 #ifndef _1b2f876e_1ad2_464d_9423_28181320aed0
 #define _1b2f876e_1ad2_464d_9423_28181320aed0
 
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "odil/Association.h"
 #include "odil/DataSet.h"
 #include "odil/message/CStoreRequest.h"
+#include "odil/message/CStoreResponse.h"
 #include "odil/odil.h"
 #include "odil/SCU.h"
 
@@ -22,6 +28,27 @@ namespace odil
 class ODIL_API StoreSCU: public SCU
 {
 public:
+    /// @brief Callback called when a C-STORE response is received.
+    typedef std::function<
+            void(std::shared_ptr<message::CStoreResponse const>)
+        > StoreCallback;
+
+    /**
+     * @brief Return the next data set to store in a pipelined C-STORE, or
+     * nullptr once all data sets were returned.
+     */
+    typedef std::function<std::shared_ptr<DataSet>()> DataSetSource;
+
+    /**
+     * @brief Callback called when the C-STORE response of a data set from a
+     * source is received.
+     */
+    typedef std::function<
+            void(
+                std::shared_ptr<DataSet const>,
+                std::shared_ptr<message::CStoreResponse const>)
+        > DataSetCallback;
+
     /// @brief Constructor.
     StoreSCU(Association & association);
 
@@ -35,8 +62,46 @@ public:
         std::shared_ptr<DataSet> dataset,
         Value::String const & move_originator_ae_title = "",
         Value::Integer move_originator_message_id = -1) const;
+
+    /**
+     * @brief Perform the C-STOREs of several data sets, keeping as many
+     * requests outstanding as allowed by the negotiated asynchronous
+     * operations window. The responses are matched to their request by
+     * message id and may be received out of order. The affected SOP class of
+     * each request is the SOP Class UID of its data set.
+     */
+    void store(
+        std::vector<std::shared_ptr<DataSet>> const & data_sets,
+        StoreCallback callback=StoreCallback()) const;
+
+    /**
+     * @brief Perform the C-STOREs of the data sets returned by a source, as
+     * above. The source is only called when a request may be sent, so that
+     * the data sets may be produced while the previous ones are stored.
+     *
+     * Each data set is sent on the presentation context which accepted its
+     * transfer syntax if any, or else re-encoded to a native transfer syntax.
+     */
+    void store(
+        DataSetSource const & source, DataSetCallback const & callback) const;
+
+    /**
+     * @brief Return the number of requests which may be outstanding on the
+     * association, 0 if unlimited.
+     */
+    std::size_t get_maximum_outstanding_requests() const;
 private:
     void _store(std::shared_ptr<message::CStoreRequest const> request) const;
+
+    /**
+     * @brief Send a request on the presentation context matching the
+     * transfer syntax of its data set.
+     */
+    void _send(std::shared_ptr<message::CStoreRequest const> request) const;
+
+    void _check_response(
+        message::CStoreRequest const & request,
+        message::CStoreResponse const & response) const;
 };
 
 }
@@ -3,6 +3,7 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "odil/Exception.h"
 #include "odil/registry.h"
@@ -77,6 +78,30 @@ _enum_to_name = _build_enum_to_name();
 std::map<std::string, odil::VR> const
 _name_to_enum = _build_name_to_enum();
 
+/// @brief Index of two upper-case letters in _characters_to_enum, or -1.
+int _characters_index(char first, char second)
+{
+    return
+        (first >= 'A' && first <= 'Z' && second >= 'A' && second <= 'Z')
+        ? 26*(first-'A')+(second-'A') : -1;
+}
+
+std::vector<odil::VR>
+_build_characters_to_enum()
+{
+    std::vector<odil::VR> result(26*26, odil::VR::UNKNOWN);
+    for(std::map<std::string, odil::VR>::const_iterator it = _name_to_enum.begin();
+        it != _name_to_enum.end(); ++it)
+    {
+        result[_characters_index(it->first[0], it->first[1])] = it->second;
+    }
+
+    return result;
+}
+
+std::vector<odil::VR> const
+_characters_to_enum = _build_characters_to_enum();
+
 }
 
 namespace odil
@@ -106,6 +131,19 @@ VR as_vr(std::string const & vr)
     }
 }
 
+VR as_vr(char first, char second)
+{
+    auto const index = _characters_index(first, second);
+    auto const vr =
+        (index >= 0) ? _characters_to_enum[index] : VR::UNKNOWN;
+    if(vr == VR::UNKNOWN)
+    {
+        throw Exception("Unknown VR: "+std::string({first, second}));
+    }
+
+    return vr;
+}
+
 VR as_vr(Tag const & tag)
 {
     auto const dictionary_it = registry::public_dictionary.find(tag);
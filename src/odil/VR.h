@@ -37,6 +37,14 @@ ODIL_API std::string as_string(VR vr);
  */
 ODIL_API VR as_vr(std::string const & vr);
 
+/**
+ * @brief Convert the two characters of an encoded VR to the VR, without
+ * allocating.
+ *
+ * If the characters do not represent a VR, a odil::Exception is raised.
+ */
+ODIL_API VR as_vr(char first, char second);
+
 /**
  * @brief Guess a VR from a tag.
  *
@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <initializer_list>
 #include <memory>
+#include <new>
 #include <string>
 #include <utility>
 #include <vector>
@@ -81,7 +82,6 @@ namespace odil
     ODIL_VALUE_CONSTRUCTORS(Integers, _integers);
     ODIL_VALUE_CONSTRUCTORS(Reals, _reals);
     ODIL_VALUE_CONSTRUCTORS(Strings, _strings);
-    ODIL_VALUE_CONSTRUCTORS(Binary, _binary);
 
 #undef ODIL_VALUE_CONSTRUCTORS
 
@@ -103,20 +103,109 @@ Value
 {
 }
 
+Value
+::Value(Binary const & value)
+: _type(Type::Binary),
+    _binary(value.empty()?nullptr:std::make_shared<Binary>(value))
+{
+}
+
+Value
+::Value(Binary && value)
+: _type(Type::Binary),
+    _binary(value.empty()?nullptr:std::make_shared<Binary>(std::move(value)))
+{
+}
+
+Value
+::Value(std::initializer_list<Binary::value_type> const & value)
+: _type(Type::Binary),
+    _binary(value.size()==0?nullptr:std::make_shared<Binary>(value))
+{
+}
+
 Value
 ::Value(std::initializer_list<int> const & value)
-: _type(Type::Integers)
+: _type(Type::Integers), _integers(value.begin(), value.end())
 {
-    this->_integers.resize(value.size());
-    std::copy(value.begin(), value.end(), this->_integers.begin());
 }
 
 Value
 ::Value(std::initializer_list<std::initializer_list<uint8_t>> const & value)
-: _type(Type::Binary)
+: _type(Type::Binary),
+    _binary(
+        value.size()==0?nullptr
+        :std::make_shared<Binary>(value.begin(), value.end()))
+{
+}
+
+Value
+::~Value()
+{
+    this->_destroy();
+}
+
+Value
+::Value(Value const & other)
+: _type(other._type)
+{
+    this->_construct(other);
+}
+
+Value
+::Value(Value && other) noexcept
+: _type(other._type)
 {
-    this->_binary.resize(value.size());
-    std::copy(value.begin(), value.end(), this->_binary.begin());
+    this->_construct(std::move(other));
+}
+
+Value &
+Value
+::operator=(Value const & other)
+{
+    if(this != &other)
+    {
+        if(this->_type == Type::Integers && other._type == Type::Integers)
+        {
+            this->_integers = other._integers;
+        }
+        else if(this->_type == Type::Reals && other._type == Type::Reals)
+        {
+            this->_reals = other._reals;
+        }
+        else if(this->_type == Type::Strings && other._type == Type::Strings)
+        {
+            this->_strings = other._strings;
+        }
+        else if(this->_type == Type::DataSets && other._type == Type::DataSets)
+        {
+            this->_data_sets = other._data_sets;
+        }
+        else if(this->_type == Type::Binary && other._type == Type::Binary)
+        {
+            this->_binary = other._binary;
+        }
+        else
+        {
+            // Copy before destroying, in case other is owned by this value.
+            Value copy(other);
+            *this = std::move(copy);
+        }
+    }
+    return *this;
+}
+
+Value &
+Value
+::operator=(Value && other) noexcept
+{
+    if(this != &other)
+    {
+        this->_destroy();
+        this->_type = other._type;
+        this->_construct(std::move(other));
+    }
+    return *this;
 }
 
 Value::Type
@@ -195,8 +284,39 @@ Value
 	return *this->_data_sets;
 }
 
-DECLARE_CONST_ACCESSOR(Binary, binary)
-DECLARE_NON_CONST_ACCESSOR(Binary, binary)
+Value::Binary const &
+Value
+::as_binary() const
+{
+    static Binary const empty;
+
+    if(this->get_type() != Type::Binary)
+    {
+        throw Exception("Type mismatch");
+    }
+    return this->_binary?*this->_binary:empty;
+}
+
+Value::Binary &
+Value
+::as_binary()
+{
+    if(this->get_type() != Type::Binary)
+    {
+        throw Exception("Type mismatch");
+    }
+
+    // Copy on write
+    if(!this->_binary)
+    {
+        this->_binary = std::make_shared<Binary>();
+    }
+    else if(this->_binary.use_count() > 1)
+    {
+        this->_binary = std::make_shared<Binary>(*this->_binary);
+    }
+    return *this->_binary;
+}
 
 #undef DECLARE_NON_CONST_ACCESSOR
 #undef DECLARE_CONST_ACCESSOR
@@ -236,7 +356,9 @@ Value
     }
     else if(this->_type == Value::Type::Binary)
     {
-        return this->_binary == other._binary;
+        return (
+            this->_binary == other._binary
+            || this->as_binary() == other.as_binary());
     }
     else
     {
@@ -255,7 +377,98 @@ void
 Value
 ::clear()
 {
-    apply_visitor(ClearValue(), *this);
+    if(this->_type == Type::Binary)
+    {
+        // Do not copy shared data only to clear it.
+        this->_binary.reset();
+    }
+    else
+    {
+        apply_visitor(ClearValue(), *this);
+    }
+}
+
+void
+Value
+::_construct(Value const & other)
+{
+    if(other._type == Type::Integers)
+    {
+        new (&this->_integers) Integers(other._integers);
+    }
+    else if(other._type == Type::Reals)
+    {
+        new (&this->_reals) Reals(other._reals);
+    }
+    else if(other._type == Type::Strings)
+    {
+        new (&this->_strings) Strings(other._strings);
+    }
+    else if(other._type == Type::DataSets)
+    {
+        new (&this->_data_sets) DataSetsPointer(other._data_sets);
+    }
+    else if(other._type == Type::Binary)
+    {
+        new (&this->_binary) BinaryPointer(other._binary);
+    }
+    else
+    {
+        throw Exception("Unknown type");
+    }
+}
+
+void
+Value
+::_construct(Value && other) noexcept
+{
+    if(other._type == Type::Integers)
+    {
+        new (&this->_integers) Integers(std::move(other._integers));
+    }
+    else if(other._type == Type::Reals)
+    {
+        new (&this->_reals) Reals(std::move(other._reals));
+    }
+    else if(other._type == Type::Strings)
+    {
+        new (&this->_strings) Strings(std::move(other._strings));
+    }
+    else if(other._type == Type::DataSets)
+    {
+        new (&this->_data_sets) DataSetsPointer(
+            std::move(other._data_sets));
+    }
+    else if(other._type == Type::Binary)
+    {
+        new (&this->_binary) BinaryPointer(std::move(other._binary));
+    }
+}
+
+void
+Value
+::_destroy()
+{
+    if(this->_type == Type::Integers)
+    {
+        this->_integers.~Integers();
+    }
+    else if(this->_type == Type::Reals)
+    {
+        this->_reals.~Reals();
+    }
+    else if(this->_type == Type::Strings)
+    {
+        this->_strings.~Strings();
+    }
+    else if(this->_type == Type::DataSets)
+    {
+        this->_data_sets.~DataSetsPointer();
+    }
+    else if(this->_type == Type::Binary)
+    {
+        this->_binary.~BinaryPointer();
+    }
 }
 
 bool operator==(Value::DataSets const & left, Value::DataSets const & right)
@@ -24,6 +24,12 @@ class DataSet;
 
 /**
  * @brief A value held in a DICOM element.
+ *
+ * Binary data is shared between copies of a value and only duplicated when
+ * a copy is modified through the non-const accessor (copy-on-write): copying
+ * a data set does not copy its pixel data. A reference returned by the
+ * non-const accessor must not be used to modify the data after the value
+ * has been copied.
  */
 class ODIL_API Value
 {
@@ -82,15 +88,23 @@ public:
 
     Value(std::initializer_list<std::initializer_list<uint8_t>> const & value);
 
-    /** @addtogroup default_operations Default class operations
-     * @{
+    /// @brief Destructor.
+    ~Value();
+
+    /**
+     * @brief Copy constructor. Copied data sets are shared with the source;
+     * binary items are shared until either copy is modified.
      */
-    ~Value() =default;
-    Value(Value const &) =default;
-    Value(Value &&) =default;
-    Value & operator=(Value const &) =default;
-    Value & operator=(Value &&) =default;
-    /// @}
+    Value(Value const & other);
+
+    /// @brief Move constructor.
+    Value(Value && other) noexcept;
+
+    /// @brief Copy assignment.
+    Value & operator=(Value const & other);
+
+    /// @brief Move assignment.
+    Value & operator=(Value && other) noexcept;
 
     /// @brief Return the type store in the value.
     Type get_type() const;
@@ -165,7 +179,8 @@ public:
     Binary const & as_binary() const;
 
     /**
-     * @brief Return the binary data contained in the value.
+     * @brief Return the binary data contained in the value, duplicating it
+     * first if it is shared with other values.
      *
      * If the value does not contain binary data, a odil::Exception is raised.
      */
@@ -181,15 +196,32 @@ public:
     void clear();
 
 private:
-    Integers _integers;
-    Reals _reals;
-    Strings _strings;
-    // NOTE: can't use std::vector<DataSet> with forward-declaration of DataSet
-    // cf. C++11, 17.6.4.8, last bullet of clause 2
-    std::shared_ptr<DataSets> _data_sets;
-    Binary _binary;
+    typedef std::shared_ptr<DataSets> DataSetsPointer;
+    typedef std::shared_ptr<Binary> BinaryPointer;
 
     Type _type;
+
+    // Only the member matching _type is alive.
+    union
+    {
+        Integers _integers;
+        Reals _reals;
+        Strings _strings;
+        // NOTE: can't use std::vector<DataSet> with forward-declaration of
+        // DataSet cf. C++11, 17.6.4.8, last bullet of clause 2
+        DataSetsPointer _data_sets;
+        // Shared between copies, null if empty.
+        BinaryPointer _binary;
+    };
+
+    /// @brief Construct the member matching the type of other from other.
+    void _construct(Value const & other);
+
+    /// @brief Construct the member matching the type of other from other.
+    void _construct(Value && other) noexcept;
+
+    /// @brief Destroy the alive member.
+    void _destroy();
 };
 
 /**
@@ -8,6 +8,7 @@
 
 #include "odil/Writer.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
@@ -15,17 +16,44 @@
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "odil/DataSet.h"
 #include "odil/endian.h"
 #include "odil/Element.h"
 #include "odil/Exception.h"
+#include "odil/numeric_string.h"
 #include "odil/registry.h"
+#include "odil/SegmentStream.h"
 #include "odil/Tag.h"
 #include "odil/uid.h"
 #include "odil/VR.h"
 #include "odil/write_ds.h"
 
+namespace
+{
+
+/**
+ * @brief Write raw data to a stream. Large data is referenced instead of
+ * copied if the stream is a SegmentStream.
+ */
+void write_raw(std::ostream & stream, char const * data, std::size_t size)
+{
+    static std::size_t const minimum_reference_size = 4096;
+
+    auto * segment_stream = dynamic_cast<odil::SegmentStream *>(&stream);
+    if(segment_stream != nullptr && size >= minimum_reference_size)
+    {
+        segment_stream->write_reference(data, size);
+    }
+    else
+    {
+        stream.write(data, size);
+    }
+}
+
+}
+
 namespace odil
 {
 
@@ -44,7 +72,8 @@ Writer
         Writer::write_binary(length, stream, byte_ordering);
         if(length > 0)
         {
-            stream.write(reinterpret_cast<char const*>(&fragment[0]), length);
+            write_raw(
+                stream, reinterpret_cast<char const*>(&fragment[0]), length);
             if(!stream)
             {
                 throw Exception("Could not write to stream");
@@ -60,6 +89,151 @@ Writer
     }
 }
 
+void
+Writer
+::write_encapsulated_pixel_data(
+    FrameProducer const & producer, std::size_t frames_count,
+    OffsetTable offset_table) const
+{
+    std::size_t const table_entries =
+        (offset_table == OffsetTable::None)?0:frames_count;
+
+    // Reserve the offset tables, patched once the frames are written.
+    std::streampos tables_position = -1;
+    if(table_entries > 0)
+    {
+        tables_position = this->stream.tellp();
+        if(tables_position == std::streampos(-1))
+        {
+            throw Exception("Offset tables require a seekable stream");
+        }
+    }
+
+    std::string const zeros(
+        table_entries*((offset_table == OffsetTable::Extended)?8:4), '\0');
+    if(offset_table == OffsetTable::Extended && table_entries > 0)
+    {
+        for(auto const & tag: {
+            registry::ExtendedOffsetTable,
+            registry::ExtendedOffsetTableLengths})
+        {
+            this->write_tag(tag);
+            this->_write_long_header(VR::OV, zeros.size());
+            this->stream.write(zeros.data(), zeros.size());
+        }
+    }
+
+    this->write_tag(registry::PixelData);
+    this->_write_long_header(VR::OB, 0xffffffff);
+
+    // Basic Offset Table
+    this->write_tag(registry::Item);
+    auto const basic_offset_table_size =
+        (offset_table == OffsetTable::Basic)?zeros.size():0;
+    Writer::write_binary(
+        uint32_t(basic_offset_table_size), this->stream, this->byte_ordering);
+    this->stream.write(zeros.data(), basic_offset_table_size);
+
+    // Fragments: the frame buffer is reused, so it must be copied even to a
+    // SegmentStream.
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> lengths;
+    uint64_t offset = 0;
+    Value::Binary::value_type frame;
+    while(true)
+    {
+        frame.clear();
+        if(!producer(frame))
+        {
+            break;
+        }
+        if(table_entries > 0 && offsets.size() == table_entries)
+        {
+            throw Exception(
+                "Too many frames, expected "+std::to_string(frames_count));
+        }
+
+        // Fragments have an even length, PS 3.5, A.4
+        uint64_t const length = frame.size()+(frame.size()%2);
+        if(length > 0xfffffffe)
+        {
+            throw Exception("Frame is too large");
+        }
+        if(offset_table == OffsetTable::Basic && offset > 0xffffffff)
+        {
+            throw Exception(
+                "Offsets do not fit in the Basic Offset Table, "
+                "use the Extended Offset Table");
+        }
+        offsets.push_back(offset);
+        lengths.push_back(length);
+
+        this->write_tag(registry::Item);
+        Writer::write_binary(
+            uint32_t(length), this->stream, this->byte_ordering);
+        this->stream.write(
+            reinterpret_cast<char const *>(frame.data()), frame.size());
+        if(frame.size()%2 == 1)
+        {
+            this->stream.put('\0');
+        }
+        if(!this->stream)
+        {
+            throw Exception("Could not write to stream");
+        }
+
+        offset += 8+length;
+    }
+
+    this->write_tag(registry::SequenceDelimitationItem);
+    Writer::write_binary(uint32_t(0), this->stream, this->byte_ordering);
+
+    if(table_entries > 0)
+    {
+        if(offsets.size() != table_entries)
+        {
+            throw Exception(
+                "Not enough frames, expected "+std::to_string(frames_count)
+                +", got "+std::to_string(offsets.size()));
+        }
+
+        auto const end = this->stream.tellp();
+        if(offset_table == OffsetTable::Extended)
+        {
+            // Header of an OV element: tag, VR, reserved, length
+            std::streamoff const header = this->explicit_vr?12:8;
+            this->stream.seekp(tables_position+header);
+            for(auto const & value: offsets)
+            {
+                Writer::write_binary(value, this->stream, this->byte_ordering);
+            }
+            this->stream.seekp(
+                tables_position+2*header+std::streamoff(zeros.size()));
+            for(auto const & value: lengths)
+            {
+                Writer::write_binary(value, this->stream, this->byte_ordering);
+            }
+        }
+        else
+        {
+            // Pixel Data header and Basic Offset Table item header
+            std::streamoff const header = (this->explicit_vr?12:8)+8;
+            this->stream.seekp(tables_position+header);
+            for(auto const & value: offsets)
+            {
+                Writer::write_binary(
+                    uint32_t(value), this->stream, this->byte_ordering);
+            }
+        }
+        this->stream.seekp(end);
+    }
+
+    if(!this->stream)
+    {
+        throw Exception("Could not write to stream");
+    }
+}
+
 std::size_t
 Writer
 ::size(odil::Tag const &, bool, ItemEncoding, bool)
@@ -73,8 +247,8 @@ Writer
     odil::VR vr, odil::Value const & value, bool explicit_vr,
     ItemEncoding item_encoding, bool use_group_length)
 {
-    SizeVisitor const visitor(vr, explicit_vr, item_encoding, use_group_length);
-    return apply_visitor(visitor, value);
+    return Writer::_size(
+        vr, value, explicit_vr, item_encoding, use_group_length, nullptr);
 }
 
 std::size_t
@@ -82,6 +256,38 @@ Writer
 ::size(
     odil::Element const & element, bool explicit_vr, ItemEncoding item_encoding,
     bool use_group_length)
+{
+    return Writer::_size(
+        element, explicit_vr, item_encoding, use_group_length, nullptr);
+}
+
+std::size_t
+Writer
+::size(
+    odil::DataSet const & data_set, bool explicit_vr,
+    ItemEncoding item_encoding, bool use_group_length)
+{
+    return Writer::_size(
+        data_set, explicit_vr, item_encoding, use_group_length, nullptr);
+}
+
+std::size_t
+Writer
+::_size(
+    odil::VR vr, odil::Value const & value, bool explicit_vr,
+    ItemEncoding item_encoding, bool use_group_length,
+    ItemSizes * item_sizes)
+{
+    SizeVisitor const visitor(
+        vr, explicit_vr, item_encoding, use_group_length, item_sizes);
+    return apply_visitor(visitor, value);
+}
+
+std::size_t
+Writer
+::_size(
+    odil::Element const & element, bool explicit_vr, ItemEncoding item_encoding,
+    bool use_group_length, ItemSizes * item_sizes)
 {
     std::size_t const vr = explicit_vr ? 2 : 0;
     std::size_t const vl = 
@@ -97,19 +303,35 @@ Writer
             : 2 /* PS3.5, table 7.1-2*/ )
         : 4 /* PS 3.5, table 7.1-3 */;
     
-    auto const value = Writer::size(
-        element.vr, element.get_value(), explicit_vr, item_encoding,
-        use_group_length);
+    auto const & encoded_value = element.get_encoded_value();
+    auto const value =
+        (encoded_value && element.vr != VR::SQ)
+        // The encoded size does not depend on the byte ordering: no need
+        // to decode the value.
+        ? encoded_value->length
+        : Writer::_size(
+            element.vr, element.get_value(), explicit_vr, item_encoding,
+            use_group_length, item_sizes);
     
     return vr+vl+value;
 }
 
 std::size_t
 Writer
-::size(
+::_size(
     odil::DataSet const & data_set, bool explicit_vr,
-    ItemEncoding item_encoding, bool use_group_length)
+    ItemEncoding item_encoding, bool use_group_length,
+    ItemSizes * item_sizes)
 {
+    if(item_sizes != nullptr)
+    {
+        auto const it = item_sizes->find(&data_set);
+        if(it != item_sizes->end())
+        {
+            return it->second;
+        }
+    }
+
     std::size_t size=0;
     
     uint16_t group = 0xffff;
@@ -119,8 +341,8 @@ Writer
         auto const & element = item.second;
         
         size += Writer::size(tag, explicit_vr, item_encoding, use_group_length);
-        size += Writer::size(
-            element, explicit_vr, item_encoding, use_group_length);
+        size += Writer::_size(
+            element, explicit_vr, item_encoding, use_group_length, item_sizes);
         
         if(tag.group != group)
         {
@@ -132,11 +354,18 @@ Writer
             {
                 // Tag
                 size += 4;
+                // VR and VL (explicit VR) or VL (implicit VR)
+                size += 4;
                 // Value (UL)
                 size += 4;
             }
         }
     }
+
+    if(item_sizes != nullptr)
+    {
+        item_sizes->emplace(&data_set, size);
+    }
     
     return size;
 }
@@ -170,6 +399,30 @@ Writer
 void
 Writer
 ::write_data_set(std::shared_ptr<DataSet const> data_set) const
+{
+    ItemSizes item_sizes;
+    this->_write_data_set(*data_set, item_sizes);
+}
+
+void
+Writer
+::write_tag(Tag const & tag) const
+{
+    Writer::write_binary(tag.group, this->stream, this->byte_ordering);
+    Writer::write_binary(tag.element, this->stream, this->byte_ordering);
+}
+
+void
+Writer
+::write_element(Element const & element) const
+{
+    ItemSizes item_sizes;
+    this->_write_element(element, item_sizes);
+}
+
+void
+Writer
+::_write_data_set(DataSet const & data_set, ItemSizes & item_sizes) const
 {
     // Utility function checking whether the group length should be written
     auto write_group_length = [](bool use_group_length, uint16_t group) {
@@ -184,7 +437,7 @@ Writer
     
     // Build a map of the group lengths
     std::map<uint16_t, odil::Value::Integer> group_lengths;
-    for(auto && item: *data_set)
+    for(auto && item: data_set)
     {
         if(write_group_length(this->use_group_length, item.first.group))
         {
@@ -192,34 +445,34 @@ Writer
                 Writer::size(
                     item.first, this->explicit_vr, this->item_encoding,
                     this->use_group_length)
-                + Writer::size(
+                + Writer::_size(
                     item.second, this->explicit_vr, this->item_encoding,
-                    this->use_group_length);
+                    this->use_group_length, &item_sizes);
             group_lengths.insert({item.first.group, 0}).first->second += size;
         }
     }
     
     // Write the data set items. When a new group appears, write its group
     // length if required.
-    uint16_t previous_element = 0xffff;
-    for(auto && item: *data_set)
+    uint16_t previous_group = 0xffff;
+    for(auto && item: data_set)
     {
         auto const & tag = item.first;
         auto const group = tag.group;
-        auto const element = tag.element;
         if(
-            element < previous_element
+            group != previous_group
             && write_group_length(this->use_group_length, group))
         {
             // Group length: (gggg,0000) UL Type=3 VM=1
             this->write_tag(Tag(tag.group, 0));
-            this->write_element(
-                Element(Value::Integers({group_lengths.at(group)}), VR::UL));
+            this->_write_element(
+                Element(Value::Integers({group_lengths.at(group)}), VR::UL),
+                item_sizes);
         }
-        previous_element = element;
+        previous_group = group;
         
         this->write_tag(item.first);
-        this->write_element(item.second);
+        this->_write_element(item.second, item_sizes);
         
         if(!this->stream)
         {
@@ -230,15 +483,7 @@ Writer
 
 void
 Writer
-::write_tag(Tag const & tag) const
-{
-    Writer::write_binary(tag.group, this->stream, this->byte_ordering);
-    Writer::write_binary(tag.element, this->stream, this->byte_ordering);
-}
-
-void
-Writer
-::write_element(Element const & element) const
+::_write_element(Element const & element, ItemSizes & item_sizes) const
 {
     auto const vr = element.vr;
 
@@ -252,12 +497,46 @@ Writer
         }
     }
 
+    bool const long_vl = (
+        vr == VR::OB || vr == VR::OD || vr == VR::OF || vr == VR::OL ||
+        vr == VR::OV || vr == VR::OW || vr == VR::SQ || vr == VR::UC ||
+        vr == VR::UR || vr == VR::UT || vr == VR::UN);
+
+    // Copy lazily-read values without decoding them when their encoding is
+    // valid in the output stream.
+    auto const & encoded_value = element.get_encoded_value();
+    if(encoded_value && this->_can_copy(vr, *encoded_value, long_vl))
+    {
+        uint32_t const vl =
+            encoded_value->undefined_length
+            ? 0xffffffff : encoded_value->length;
+        if(this->explicit_vr && !long_vl)
+        {
+            Writer::write_binary(
+                uint16_t(vl), this->stream, this->byte_ordering);
+        }
+        else
+        {
+            if(this->explicit_vr)
+            {
+                Writer::write_binary(
+                    uint16_t(0), this->stream, this->byte_ordering);
+            }
+            Writer::write_binary(vl, this->stream, this->byte_ordering);
+        }
+        write_raw(
+            this->stream, encoded_value->data(), encoded_value->length);
+        if(!this->stream)
+        {
+            throw Exception("Could not write to stream");
+        }
+        return;
+    }
+
     // Write VL
     if(this->explicit_vr)
     {
-        if(vr == VR::OB || vr == VR::OD || vr == VR::OF || vr == VR::OL ||
-           vr == VR::OV || vr == VR::OW || vr == VR::SQ || vr == VR::UC || 
-           vr == VR::UR || vr == VR::UT || vr == VR::UN)
+        if(long_vl)
         {
             Writer::write_binary(
                 uint16_t(0), this->stream, this->byte_ordering);
@@ -274,26 +553,26 @@ Writer
             }
             else
             {
-                vl = Writer::size(
+                vl = Writer::_size(
                     vr, element.get_value(), this->explicit_vr,
-                    this->item_encoding, this->use_group_length);
+                    this->item_encoding, this->use_group_length, &item_sizes);
             }
             Writer::write_binary(vl, this->stream, this->byte_ordering);
         }
         else
         {
-            auto const vl = Writer::size(
+            auto const vl = Writer::_size(
                 vr, element.get_value(), this->explicit_vr, this->item_encoding,
-                this->use_group_length);
+                this->use_group_length, &item_sizes);
             Writer::write_binary(
                 uint16_t(vl), this->stream, this->byte_ordering);
         }
     }
     else
     {
-        auto const vl = Writer::size(
+        auto const vl = Writer::_size(
             vr, element.get_value(), this->explicit_vr, this->item_encoding,
-            this->use_group_length);
+            this->use_group_length, &item_sizes);
         Writer::write_binary(
             uint32_t(vl), this->stream, this->byte_ordering);
     }
@@ -302,7 +581,7 @@ Writer
     {
         WriteVisitor const visitor(
             this->stream, vr, this->byte_ordering, this->explicit_vr,
-            this->item_encoding, this->use_group_length);
+            this->item_encoding, this->use_group_length, item_sizes);
         apply_visitor(visitor, element.get_value());
     }
     if(!this->stream)
@@ -311,6 +590,47 @@ Writer
     }
 }
 
+void
+Writer
+::_write_long_header(VR vr, uint32_t length) const
+{
+    if(this->explicit_vr)
+    {
+        this->stream << as_string(vr);
+        Writer::write_binary(uint16_t(0), this->stream, this->byte_ordering);
+    }
+    Writer::write_binary(length, this->stream, this->byte_ordering);
+}
+
+bool
+Writer
+::_can_copy(
+    VR vr, Element::EncodedValue const & encoded_value, bool long_vl) const
+{
+    if(vr == VR::SQ)
+    {
+        // Items depend on the VR explicitness and on the item encoding.
+        return false;
+    }
+    else if(this->explicit_vr && !long_vl && encoded_value.length > 0xffff)
+    {
+        return false;
+    }
+    else if(encoded_value.byte_ordering == this->byte_ordering)
+    {
+        return true;
+    }
+    else
+    {
+        // Values which do not depend on the byte ordering
+        return
+            !encoded_value.undefined_length
+            && (
+                vr == VR::OB || vr == VR::UN || vr == VR::DS || vr == VR::IS
+                || (is_string(vr) && vr != VR::AT));
+    }
+}
+
 void
 Writer
 ::write_file(
@@ -406,9 +726,10 @@ Writer::WriteVisitor
 ::WriteVisitor(
     std::ostream & stream, VR vr,
     ByteOrdering byte_ordering, bool explicit_vr, Writer::ItemEncoding item_encoding,
-    bool use_group_length)
+    bool use_group_length, ItemSizes & item_sizes)
 : stream(stream), vr(vr), byte_ordering(byte_ordering), explicit_vr(explicit_vr),
-    item_encoding(item_encoding), use_group_length(use_group_length)
+    item_encoding(item_encoding), use_group_length(use_group_length),
+    item_sizes(item_sizes)
 {
     // Nothing else
 }
@@ -481,44 +802,36 @@ Writer::WriteVisitor
 {
     if(this->vr == VR::DS)
     {
-        int written = 0;
-        for(int i=0; i<value.size(); ++i)
+        // Format the whole value before writing it at once. Each item in the
+        // DS is at most 16 bytes, account for NUL at end and for separator.
+        static unsigned int const buffer_size=16+1;
+        std::string buffer;
+        buffer.reserve(buffer_size*value.size());
+        for(auto const & item: value)
         {
-            auto const & item = value[i];
-            
             if(!std::isfinite(item))
             {
                 throw Exception("DS items must be finite");
             }
-            
-            // Each item in the DS is at most 16 bytes, account for NUL at end
-            static unsigned int const buffer_size=16+1;
-            static char buffer[buffer_size];
-            write_ds(item, buffer, buffer_size);
-            auto const length = strlen(buffer);
-            
-            this->stream.write(buffer, length);
-            written += length;
-            if(!this->stream.good())
-            {
-                throw Exception("Could not write DS");
-            }
-            
-            if(i<value.size()-1)
+
+            if(!buffer.empty())
             {
-                this->stream.put('\\');
-                written += 1;
-                if(!this->stream.good())
-                {
-                    throw Exception("Could not write DS");
-                }
+                buffer += '\\';
             }
-        };
-        if(written % 2 == 1)
+            char item_buffer[buffer_size];
+            write_ds(item, item_buffer, buffer_size);
+            buffer += item_buffer;
+        }
+        if(buffer.size() % 2 == 1)
+        {
+            buffer += ' ';
+        }
+
+        this->stream.write(buffer.data(), buffer.size());
+        if(!this->stream.good())
         {
-            this->stream.put(' ');
+            throw Exception("Could not write DS");
         }
-        //this->write_strings(value, ' ');
     }
     else if(this->vr == VR::FD)
     {
@@ -580,9 +893,9 @@ Writer::WriteVisitor
         uint32_t item_length;
         if(this->item_encoding == ItemEncoding::ExplicitLength)
         {
-            item_length = Writer::size(
+            item_length = Writer::_size(
                 *item, this->explicit_vr, this->item_encoding,
-                this->use_group_length);
+                this->use_group_length, &this->item_sizes);
         }
         else
         {
@@ -591,7 +904,7 @@ Writer::WriteVisitor
         Writer::write_binary(item_length, this->stream, this->byte_ordering);
 
         // Data set
-        sequence_writer.write_data_set(item);
+        sequence_writer._write_data_set(*item, this->item_sizes);
         if(!this->stream)
         {
             throw Exception("Could not write to stream");
@@ -633,52 +946,58 @@ Writer::WriteVisitor
     }
     else
     {
+        std::size_t word_size;
         if(this->vr == VR::OB || this->vr == VR::UN)
         {
-            this->stream.write(
-                reinterpret_cast<char const*>(&value[0][0]), value[0].size());
+            word_size = 1;
         }
         else if(this->vr == VR::OW)
         {
-            if(value[0].size()%2 != 0)
-            {
-                throw Exception("Value cannot be written as OW");
-            }
-            for(int i=0; i<value[0].size(); i+=2)
-            {
-                uint16_t item = *reinterpret_cast<uint16_t const *>(&value[0][i]);
-                Writer::write_binary(item, this->stream, this->byte_ordering);
-            }
+            word_size = 2;
         }
         else if(this->vr == VR::OF || this->vr == VR::OL)
         {
-            if(value[0].size()%4 != 0)
-            {
-                throw Exception("Value cannot be written as " + as_string(this->vr));
-            }
-            for(int i=0; i<value[0].size(); i+=4)
-            {
-                uint32_t item = *reinterpret_cast<uint32_t const *>(&value[0][i]);
-                Writer::write_binary(item, this->stream, this->byte_ordering);
-            }
+            word_size = 4;
         }
         else if(this->vr == VR::OD || this->vr == VR::OV)
         {
-            if(value[0].size()%8 != 0)
-            {
-                throw Exception("Value cannot be written as " + as_string(this->vr));
-            }
-            for(int i=0; i<value[0].size(); i+=8)
-            {
-                uint64_t item = *reinterpret_cast<uint64_t const *>(&value[0][i]);
-                Writer::write_binary(item, this->stream, this->byte_ordering);
-            }
+            word_size = 8;
         }
         else
         {
             throw Exception("Cannot write "+as_string(this->vr)+" as binary");
         }
 
+        if(value[0].size()%word_size != 0)
+        {
+            throw Exception(
+                "Value cannot be written as " + as_string(this->vr));
+        }
+
+        auto const data = reinterpret_cast<char const*>(&value[0][0]);
+        auto const size = value[0].size();
+        if(word_size == 1 || this->byte_ordering == odil::byte_ordering)
+        {
+            write_raw(this->stream, data, size);
+        }
+        else
+        {
+            // Swap a bounded chunk at a time, the value is left untouched.
+            static std::size_t const chunk_size = 65536;
+            std::vector<char> buffer(std::min(size, chunk_size));
+            for(std::size_t offset=0; offset < size; offset += buffer.size())
+            {
+                auto const count = std::min(size-offset, buffer.size());
+                std::memcpy(&buffer[0], data+offset, count);
+                swap_bytes(&buffer[0], count, word_size);
+                this->stream.write(&buffer[0], count);
+                if(!this->stream)
+                {
+                    throw Exception("Could not write to stream");
+                }
+            }
+        }
+
         if(!this->stream)
         {
             throw Exception("Could not write to stream");
@@ -741,48 +1060,39 @@ Writer::WriteVisitor
     {
         return;
     }
-    
-    std::size_t size = 0;
-    
-    auto const last_element_it = --sequence.end();
-    for(auto it = sequence.begin(); it!= sequence.end(); ++it)
-    {
-        // IS is <= 12 bytes (PS 3.5, table 6.2-1)
-        char buffer[13];
-        auto const buffer_size = std::snprintf(buffer, 13, "%li", *it);
-        this->stream.write(buffer, buffer_size);
-        if(!this->stream)
-        {
-            throw Exception("Could not write to stream");
-        }
-        size += buffer_size;
 
-        if(it != last_element_it)
+    // Format the whole value before writing it at once. IS is <= 12 bytes
+    // (PS 3.5, table 6.2-1), but allow for any 64-bits integer.
+    std::string buffer(21*sequence.size(), '\0');
+    auto it = &buffer[0];
+    for(auto const & item: sequence)
+    {
+        if(it != &buffer[0])
         {
-            this->stream.put('\\');
-            if(!this->stream)
-            {
-                throw Exception("Could not write to stream");
-            }
-            ++size;
+            *it = '\\';
+            ++it;
         }
+        it += write_is(item, it);
+    }
+    buffer.resize(it-&buffer[0]);
+    if(buffer.size()%2 == 1)
+    {
+        buffer += padding;
     }
 
-    if(size%2 == 1)
+    this->stream.write(buffer.data(), buffer.size());
+    if(!this->stream)
     {
-        this->stream.put(padding);
-        if(!this->stream)
-        {
-            throw Exception("Could not write to stream");
-        }
+        throw Exception("Could not write to stream");
     }
 }
 
 Writer::SizeVisitor
 ::SizeVisitor(
-    VR vr, bool explicit_vr, ItemEncoding item_encoding, bool use_group_length)
+    VR vr, bool explicit_vr, ItemEncoding item_encoding, bool use_group_length,
+    ItemSizes * item_sizes)
 : vr(vr), explicit_vr(explicit_vr), item_encoding(item_encoding),
-    use_group_length(use_group_length)
+    use_group_length(use_group_length), item_sizes(item_sizes)
 {
     // Nothing else
 }
@@ -856,7 +1166,7 @@ Writer::SizeVisitor
             // Each item in the DS is at most 16 bytes (PS 3.5, 6.2), account
             // for NUL at end
             static unsigned int const buffer_size=16+1;
-            static char buffer[buffer_size];
+            char buffer[buffer_size];
             write_ds(x, buffer, buffer_size);
             size += strlen(buffer);
         }
@@ -935,8 +1245,9 @@ Writer::SizeVisitor
         // Length
         size += 4;
         // Value
-        size += Writer::size(
-            *x, this->explicit_vr, this->item_encoding, this->use_group_length);
+        size += Writer::_size(
+            *x, this->explicit_vr, this->item_encoding, this->use_group_length,
+            this->item_sizes);
         if(this->item_encoding == ItemEncoding::UndefinedLength)
         {
             // Item Delimitation Item tag
@@ -9,8 +9,11 @@
 #ifndef _ca5c06d2_04f9_4009_9e98_5607e1060379
 #define _ca5c06d2_04f9_4009_9e98_5607e1060379
 
+#include <cstddef>
+#include <functional>
 #include <ostream>
 #include <string>
+#include <unordered_map>
 
 #include "odil/DataSet.h"
 #include "odil/Element.h"
@@ -35,6 +38,24 @@ public:
         UndefinedLength
     };
 
+    /// @brief Offset tables of encapsulated pixel data (PS 3.5, A.4).
+    enum class OffsetTable
+    {
+        /// @brief Empty Basic Offset Table.
+        None,
+        /// @brief Basic Offset Table, 32-bits offsets.
+        Basic,
+        /// @brief Extended Offset Table and Extended Offset Table Lengths.
+        Extended
+    };
+
+    /**
+     * @brief Source of the frames of encapsulated pixel data: store the next
+     * frame in its argument and return true, or return false when all frames
+     * have been produced.
+     */
+    typedef std::function<bool(Value::Binary::value_type &)> FrameProducer;
+
     /// @brief Output stream.
     std::ostream & stream;
 
@@ -99,6 +120,22 @@ public:
     /// @brief Write an element (VR, VL and value).
     void write_element(Element const & element) const;
 
+    /**
+     * @brief Write the Pixel Data element in encapsulated form, one fragment
+     * per frame, pulling the frames from the producer: a single frame is
+     * held in memory at any time.
+     *
+     * With a Basic or Extended offset table, frames_count entries are
+     * reserved and filled once all frames are written: the stream must be
+     * seekable and the producer must yield exactly frames_count frames. The
+     * Extended Offset Table and Extended Offset Table Lengths elements are
+     * written before Pixel Data. Without offset table, the stream does not
+     * need to be seekable and frames_count is not used.
+     */
+    void write_encapsulated_pixel_data(
+        FrameProducer const & producer, std::size_t frames_count,
+        OffsetTable offset_table=OffsetTable::Basic) const;
+
     /// @brief Write a file (meta-information and data set).
     static void write_file(
         std::shared_ptr<DataSet const> data_set, std::ostream & stream,
@@ -108,6 +145,33 @@ public:
         bool use_group_length=false);
 
 private:
+    /**
+     * @brief Sizes of the items, computed once per top-level write so that
+     * writing nested explicit-length items is linear in the data set size.
+     */
+    typedef std::unordered_map<DataSet const *, std::size_t> ItemSizes;
+
+    static std::size_t _size(
+        odil::VR vr, odil::Value const &, bool explicit_vr,
+        ItemEncoding item_encoding, bool use_group_length,
+        ItemSizes * item_sizes);
+    static std::size_t _size(
+        odil::Element const &, bool explicit_vr, ItemEncoding item_encoding,
+        bool use_group_length, ItemSizes * item_sizes);
+    static std::size_t _size(
+        odil::DataSet const &, bool explicit_vr, ItemEncoding item_encoding,
+        bool use_group_length, ItemSizes * item_sizes);
+
+    void _write_data_set(
+        DataSet const & data_set, ItemSizes & item_sizes) const;
+    void _write_element(Element const & element, ItemSizes & item_sizes) const;
+
+    /// @brief Write the VR (if explicit) and the 32-bits length of an element.
+    void _write_long_header(VR vr, uint32_t length) const;
+
+    /// @brief Test whether an encoded value can be copied as is.
+    bool _can_copy(
+        VR vr, Element::EncodedValue const & encoded_value, bool long_vl) const;
 
     struct WriteVisitor
     {
@@ -121,10 +185,12 @@ private:
         ItemEncoding item_encoding;
         bool use_group_length;
 
+        ItemSizes & item_sizes;
+
         WriteVisitor(
             std::ostream & stream, VR vr,
             ByteOrdering byte_ordering, bool explicit_vr, ItemEncoding item_encoding,
-            bool use_group_length);
+            bool use_group_length, ItemSizes & item_sizes);
 
         result_type operator()(Value::Integers const & value) const;
         result_type operator()(Value::Reals const & value) const;
@@ -146,9 +212,11 @@ private:
         ItemEncoding item_encoding;
         bool use_group_length;
 
+        ItemSizes * item_sizes;
+
         SizeVisitor(
             VR vr, bool explicit_vr, ItemEncoding item_encoding,
-            bool use_group_length);
+            bool use_group_length, ItemSizes * item_sizes=nullptr);
         
         result_type operator()(Value::Integers const & value) const;
         result_type operator()(Value::Reals const & value) const;
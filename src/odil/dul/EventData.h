@@ -10,12 +10,16 @@
 #define _350775b8_701f_4069_ab1e_c974a209389c
 
 #include <memory>
+#include <vector>
+
+#include <boost/asio.hpp>
 
 #include "odil/AssociationAcceptor.h"
 #include "odil/AssociationParameters.h"
 #include "odil/dul/Transport.h"
 #include "odil/odil.h"
 #include "odil/pdu/Object.h"
+#include "odil/pdu/PDataTF.h"
 
 namespace odil
 {
@@ -29,6 +33,22 @@ class ODIL_API EventData
 public:
     Transport::Socket::endpoint_type peer_endpoint;
     std::shared_ptr<pdu::Object> pdu;
+    /**
+     * @brief Encoded PDU, sent as is when pdu is not set. The referenced
+     * memory must be valid until the PDU is sent.
+     */
+    std::vector<boost::asio::const_buffer> encoded_pdu;
+    /**
+     * @brief If set, handler called when the encoded PDU has been written by
+     * an asynchronous transport, which then does not copy it.
+     */
+    Transport::Handler write_handler;
+    /**
+     * @brief Presentation Data Value Items of a received P-DATA-TF PDU, set
+     * instead of pdu. The fragments reference the receive buffer of the
+     * state machine.
+     */
+    std::vector<pdu::PDataTF::PresentationDataValueView> pdv_items;
     AssociationParameters association_parameters;
     std::shared_ptr<AssociationRejected> reject;
 };
@@ -9,9 +9,13 @@
 #include "odil/dul/StateMachine.h"
 
 #include <cstdint>
+#include <cstring>
+#include <exception>
 #include <functional>
 #include <map>
+#include <memory>
 #include <sstream>
+#include <string>
 #include <tuple>
 #include <utility>
 
@@ -21,6 +25,7 @@
 #include "odil/AssociationParameters.h"
 #include "odil/endian.h"
 #include "odil/Exception.h"
+#include "odil/logging.h"
 #include "odil/dul/EventData.h"
 #include "odil/dul/Transport.h"
 #include "odil/pdu/AAbort.h"
@@ -29,6 +34,7 @@
 #include "odil/pdu/AReleaseRP.h"
 #include "odil/pdu/AReleaseRQ.h"
 #include "odil/pdu/PDataTF.h"
+#include "odil/StringStream.h"
 
 namespace odil
 {
@@ -36,6 +42,8 @@ namespace odil
 namespace dul
 {
 
+std::size_t const StateMachine::retained_pdu_buffer_size = 6+1024*1024;
+
 StateMachine
 ::StateMachine()
 : _state(State::Sta1), _timeout(boost::posix_time::pos_infin),
@@ -45,6 +53,16 @@ StateMachine
     // Nothing else.
 }
 
+StateMachine
+::StateMachine(boost::asio::io_service & service)
+: _state(State::Sta1), _transport(service),
+  _timeout(boost::posix_time::pos_infin),
+  _artim_timer(_transport.get_service()),
+  _association_acceptor(default_association_acceptor)
+{
+    // Nothing else.
+}
+
 StateMachine
 ::~StateMachine()
 {
@@ -147,7 +165,11 @@ void
 StateMachine
 ::receive(EventData & data)
 {
-    this->_transport.receive(data.peer_endpoint);
+    // The connection may already have been accepted on the transport.
+    if(!this->_transport.is_open())
+    {
+        this->_transport.receive(data.peer_endpoint);
+    }
     this->transition(Event::TransportConnectionIndication, data);
 }
 
@@ -155,12 +177,7 @@ void
 StateMachine
 ::send_pdu(EventData & data)
 {
-    if(data.pdu == nullptr)
-    {
-        throw Exception("No PDU");
-    }
-    auto const & item = data.pdu->get_item();
-    auto const type = item.as_unsigned_int_8("PDU-type");
+    auto const type = this->_get_pdu_type(data);
 
     if(type == 0x01)
     {
@@ -201,18 +218,121 @@ void
 StateMachine
 ::receive_pdu(EventData & data)
 {
-    auto const header = this->_transport.read(6);
+    // Read the PDU in a buffer re-used by all PDUs
+    this->_prepare_pdu_buffer();
+    this->_transport.read(this->_pdu_buffer.data(), 6);
+
+    auto const length = this->_get_pdu_length();
+    this->_transport.read(this->_pdu_buffer.data()+6, length);
+
+    this->_process_pdu(data);
+}
+
+void
+StateMachine
+::async_receive_pdu(EventData & data, Handler const & handler)
+{
+    this->_prepare_pdu_buffer();
+
+    auto const report = [handler](boost::system::error_code const & error) {
+        handler(
+            std::make_exception_ptr(
+                (error == boost::asio::error::timed_out)
+                ? Exception("TCP time out")
+                : Exception("Operation error: "+error.message())));
+    };
+
+    this->_transport.async_read(
+        this->_pdu_buffer.data(), 6,
+        [this, &data, handler, report](boost::system::error_code const & e)
+        {
+            if(e)
+            {
+                report(e);
+                return;
+            }
+
+            uint32_t length = 0;
+            try
+            {
+                length = this->_get_pdu_length();
+            }
+            catch(...)
+            {
+                handler(std::current_exception());
+                return;
+            }
+
+            this->_transport.async_read(
+                this->_pdu_buffer.data()+6, length,
+                [this, &data, handler, report](
+                    boost::system::error_code const & e)
+                {
+                    if(e)
+                    {
+                        report(e);
+                        return;
+                    }
+
+                    std::exception_ptr error;
+                    try
+                    {
+                        this->_process_pdu(data);
+                    }
+                    catch(...)
+                    {
+                        error = std::current_exception();
+                    }
+                    handler(error);
+                });
+        });
+}
+
+void
+StateMachine
+::_prepare_pdu_buffer()
+{
+    // The fragments of the previous PDU are no longer used: release the
+    // buffer if an oversized PDU made it grow.
+    if(this->_pdu_buffer.capacity() > StateMachine::retained_pdu_buffer_size)
+    {
+        std::vector<char>().swap(this->_pdu_buffer);
+    }
+    if(this->_pdu_buffer.size() < 6)
+    {
+        this->_pdu_buffer.resize(6);
+    }
+}
+
+uint32_t
+StateMachine
+::_get_pdu_length()
+{
+    uint32_t length;
+    std::memcpy(&length, &this->_pdu_buffer[2], 4);
+    length = big_endian_to_host(length);
 
-    uint8_t const type = header[0];
-    uint32_t const length = big_endian_to_host(
-        *reinterpret_cast<uint32_t const *>(&header[0]+2));
-    auto const pdu_data = this->_transport.read(length);
+    if(this->_pdu_buffer.size() < 6+std::size_t(length))
+    {
+        this->_pdu_buffer.resize(6+std::size_t(length));
+    }
+
+    return length;
+}
+
+void
+StateMachine
+::_process_pdu(EventData & data)
+{
+    uint8_t const type = this->_pdu_buffer[0];
+    uint32_t length;
+    std::memcpy(&length, &this->_pdu_buffer[2], 4);
+    length = big_endian_to_host(length);
 
-    std::stringstream stream;
-    stream.write(&header[0], header.size());
-    stream.write(&pdu_data[0], pdu_data.size());
+    IStringStream stream(this->_pdu_buffer.data(), 6+length);
 
     data.pdu=nullptr;
+    data.pdv_items.clear();
     Event event = Event::None;
     if(type == 0x01)
     {
@@ -231,7 +351,9 @@ StateMachine
     }
     else if(type == 0x04)
     {
-        data.pdu = std::make_shared<pdu::PDataTF>(stream);
+        // Fragments are not copied, but reference the buffer.
+        auto const begin = this->_pdu_buffer.data()+6;
+        pdu::PDataTF::read_pdv_items(begin, begin+length, data.pdv_items);
         event = Event::PDataTFRemote;
     }
     else if(type == 0x05)
@@ -255,7 +377,6 @@ StateMachine
     }
 
     this->transition(event, data);
-
 }
 
 void
@@ -509,27 +630,95 @@ void
 StateMachine
 ::_send_pdu(EventData & data, uint8_t pdu_type)
 {
-    if(data.pdu == nullptr)
+    if(this->_get_pdu_type(data) != pdu_type)
     {
-        throw Exception("No PDU");
+        throw Exception("Invalid PDU");
     }
-    auto const & item = data.pdu->get_item();
 
-    if(item.as_unsigned_int_8("PDU-type") != pdu_type)
+    if(data.pdu == nullptr && data.write_handler)
     {
-        throw Exception("Invalid PDU");
+        this->_transport.async_write(data.encoded_pdu, data.write_handler);
+    }
+    else if(this->_transport.is_asynchronous())
+    {
+        // Write a copy of the PDU, kept until it is written. Without a
+        // handler, a failure is also reported by the next read.
+        auto const encoded_pdu = std::make_shared<std::string>();
+        if(data.pdu == nullptr)
+        {
+            encoded_pdu->reserve(boost::asio::buffer_size(data.encoded_pdu));
+            for(auto const & buffer: data.encoded_pdu)
+            {
+                encoded_pdu->append(
+                    boost::asio::buffer_cast<char const *>(buffer),
+                    boost::asio::buffer_size(buffer));
+            }
+        }
+        else
+        {
+            std::ostringstream stream;
+            stream << data.pdu->get_item();
+            *encoded_pdu = stream.str();
+        }
+
+        auto const handler = data.write_handler;
+        this->_transport.async_write(
+            { boost::asio::buffer(*encoded_pdu) },
+            [encoded_pdu, handler](boost::system::error_code const & error)
+            {
+                if(handler)
+                {
+                    handler(error);
+                }
+                else if(error)
+                {
+                    ODIL_LOG(warning)
+                        << "Could not send PDU: " << error.message();
+                }
+            });
+    }
+    else if(data.pdu == nullptr)
+    {
+        this->_transport.write(data.encoded_pdu);
+    }
+    else
+    {
+        std::ostringstream stream;
+        stream << data.pdu->get_item();
+        this->_transport.write(stream.str());
     }
+}
 
-    std::ostringstream stream;
-    stream << item;
-    this->_transport.write(stream.str());
+uint8_t
+StateMachine
+::_get_pdu_type(EventData const & data) const
+{
+    if(data.pdu != nullptr)
+    {
+        return data.pdu->get_item().as_unsigned_int_8("PDU-type");
+    }
+    else if(
+        !data.encoded_pdu.empty()
+        && boost::asio::buffer_size(data.encoded_pdu[0]) > 0)
+    {
+        return *boost::asio::buffer_cast<uint8_t const *>(
+            data.encoded_pdu[0]);
+    }
+    else
+    {
+        throw Exception("No PDU");
+    }
 }
 
 void
 StateMachine
 ::AE_1(EventData & data)
 {
-    this->_transport.connect(data.peer_endpoint);
+    // An asynchronous transport is connected before the transition.
+    if(!this->_transport.is_open())
+    {
+        this->_transport.connect(data.peer_endpoint);
+    }
 }
 
 void
@@ -9,10 +9,12 @@
 #ifndef _981c80db_b2ac_4f25_af6c_febf5563d178
 #define _981c80db_b2ac_4f25_af6c_febf5563d178
 
+#include <exception>
 #include <functional>
 #include <map>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -66,9 +68,24 @@ public:
     /// @brief Duration of the timeout.
     typedef boost::asio::deadline_timer::duration_type duration_type;
 
+    /// @brief Handler of asynchronous operations, with the error if any.
+    typedef std::function<void(std::exception_ptr)> Handler;
+
+    /**
+     * @brief Largest buffer of received PDUs which is kept between PDUs, a
+     * larger buffer is only kept until the next PDU is received.
+     */
+    static std::size_t const retained_pdu_buffer_size;
+
     /// @brief Constructor, initializing to Sta1.
     StateMachine();
 
+    /**
+     * @brief Constructor, initializing to Sta1, with an asynchronous
+     * transport run by the io_service.
+     */
+    StateMachine(boost::asio::io_service & service);
+
     /// @brief Destructor, closing the transport.
     ~StateMachine();
 
@@ -102,9 +119,23 @@ public:
     /// @brief Send a PDU to the transport, perform the corresponding transition.
     void send_pdu(EventData & data);
 
-    /// @brief Receive a PDU on the transport, perform the corresponding transition.
+    /**
+     * @brief Receive a PDU on the transport, perform the corresponding
+     * transition.
+     *
+     * P-DATA-TF PDUs are not decoded to a PDU object: their Presentation Data
+     * Value Items are stored in data.pdv_items and reference a buffer of the
+     * state machine, valid until the next call.
+     */
     void receive_pdu(EventData & data);
 
+    /**
+     * @brief Asynchronously receive a PDU on the transport, perform the
+     * corresponding transition and call the handler. The data must be valid
+     * until the handler is called.
+     */
+    void async_receive_pdu(EventData & data, Handler const & handler);
+
     /// @brief Start (or re-start if already started) the ARTIM timer.
     void start_timer(EventData & data);
 
@@ -161,9 +192,27 @@ private:
     /// @brief Callback checking whether an association request is acceptable.
     AssociationAcceptor _association_acceptor;
 
+    /**
+     * @brief Buffer of the received PDUs, grown to the largest PDU and
+     * released before the next PDU if larger than retained_pdu_buffer_size.
+     */
+    std::vector<char> _pdu_buffer;
+
     /// @brief Check the PDU type in data and send it.
     void _send_pdu(EventData & data, uint8_t pdu_type);
 
+    /// @brief Prepare the buffer to receive the header of a PDU.
+    void _prepare_pdu_buffer();
+
+    /// @brief Return the length of the PDU whose header is in the buffer.
+    uint32_t _get_pdu_length();
+
+    /// @brief Decode the PDU in the buffer and perform the transition.
+    void _process_pdu(EventData & data);
+
+    /// @brief Return the type of the PDU, either object or encoded, in data.
+    uint8_t _get_pdu_type(EventData const & data) const;
+
     /**
      * @brief Issue TRANSPORT CONNECT request primitive to local transport
      * service.
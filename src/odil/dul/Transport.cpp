@@ -10,6 +10,8 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/date_time.hpp>
@@ -25,8 +27,21 @@ namespace dul
 
 Transport
 ::Transport()
-: _service(), _socket(nullptr), _timeout(boost::posix_time::pos_infin),
-  _deadline(_service)
+: _own_service(std::make_shared<boost::asio::io_service>()),
+  _service(*_own_service), _strand(_service), _socket(nullptr),
+  _timeout(boost::posix_time::pos_infin), _deadline(_service),
+  _read_deadline(_service), _write_deadline(_service), _writing(false),
+  _timed_out(false)
+{
+    // Nothing else
+}
+
+Transport
+::Transport(boost::asio::io_service & service)
+: _own_service(nullptr), _service(service), _strand(_service),
+  _socket(nullptr), _timeout(boost::posix_time::pos_infin),
+  _deadline(_service), _read_deadline(_service), _write_deadline(_service),
+  _writing(false), _timed_out(false)
 {
     // Nothing else
 }
@@ -54,6 +69,20 @@ Transport
     return this->_service;
 }
 
+bool
+Transport
+::is_asynchronous() const
+{
+    return this->_own_service == nullptr;
+}
+
+boost::asio::io_service::strand &
+Transport
+::get_strand()
+{
+    return this->_strand;
+}
+
 std::shared_ptr<Transport::Socket const>
 Transport
 ::get_socket() const
@@ -97,6 +126,10 @@ Transport
     {
         throw Exception("Already connected");
     }
+    if(this->is_asynchronous())
+    {
+        throw Exception("Blocking connection on an asynchronous transport");
+    }
 
     auto source = Source::NONE;
     boost::system::error_code error;
@@ -123,6 +156,10 @@ Transport
     {
         throw Exception("Already connected");
     }
+    if(this->is_asynchronous())
+    {
+        throw Exception("Blocking reception on an asynchronous transport");
+    }
 
     auto source = Source::NONE;
     boost::system::error_code error;
@@ -147,6 +184,26 @@ Transport
     this->_acceptor = nullptr;
 }
 
+void
+Transport
+::async_receive(
+    boost::asio::ip::tcp::acceptor & acceptor, Handler const & handler)
+{
+    if(this->is_open())
+    {
+        throw Exception("Already connected");
+    }
+
+    // The socket belongs to the io_service of the transport, not to the one
+    // of the acceptor.
+    auto const socket = std::make_shared<Socket>(this->_service);
+    this->_socket = socket;
+    this->_timed_out = false;
+    acceptor.async_accept(
+        *socket,
+        [socket, handler](boost::system::error_code const & e) { handler(e); });
+}
+
 void
 Transport
 ::close()
@@ -179,13 +236,24 @@ Transport
 std::string
 Transport
 ::read(std::size_t length)
+{
+    std::string data(length, 'a');
+    this->read(&data[0], length);
+    return data;
+}
+
+void
+Transport
+::read(char * data, std::size_t length)
 {
     if(!this->is_open())
     {
         throw Exception("Not connected");
     }
-
-    std::string data(length, 'a');
+    if(this->is_asynchronous())
+    {
+        throw Exception("Blocking read on an asynchronous transport");
+    }
 
     auto source = Source::NONE;
     boost::system::error_code error;
@@ -193,7 +261,7 @@ Transport
 
     boost::asio::async_read(
         *this->_socket,
-        boost::asio::buffer(&data[0], data.size()),
+        boost::asio::buffer(data, length),
         [&source,&error](boost::system::error_code const & e, std::size_t)
         {
             source = Source::OPERATION;
@@ -202,8 +270,6 @@ Transport
     );
 
     this->_run(source, error);
-
-    return data;
 }
 
 void
@@ -214,6 +280,10 @@ Transport
     {
         throw Exception("Not connected");
     }
+    if(this->is_asynchronous())
+    {
+        throw Exception("Blocking write on an asynchronous transport");
+    }
 
     auto source = Source::NONE;
     boost::system::error_code error;
@@ -231,6 +301,110 @@ Transport
     this->_run(source, error);
 }
 
+void
+Transport
+::write(std::vector<boost::asio::const_buffer> const & buffers)
+{
+    if(!this->is_open())
+    {
+        throw Exception("Not connected");
+    }
+    if(this->is_asynchronous())
+    {
+        throw Exception("Blocking write on an asynchronous transport");
+    }
+
+    auto source = Source::NONE;
+    boost::system::error_code error;
+    this->_start_deadline(source, error);
+
+    boost::asio::async_write(
+        *this->_socket, buffers,
+        [&source,&error](boost::system::error_code const & e, std::size_t)
+        {
+            source = Source::OPERATION;
+            error = e;
+        }
+    );
+
+    this->_run(source, error);
+}
+
+void
+Transport
+::async_connect(
+    Socket::endpoint_type const & peer_endpoint, Handler const & handler)
+{
+    if(this->is_open())
+    {
+        throw Exception("Already connected");
+    }
+
+    auto const operation = std::make_shared<Operation>(Operation::PENDING);
+    this->_start_async_deadline(this->_read_deadline, operation);
+
+    // The handlers keep the socket alive, even if the transport is closed.
+    auto const socket = std::make_shared<Socket>(this->_service);
+    this->_socket = socket;
+    this->_timed_out = false;
+    socket->async_connect(
+        peer_endpoint,
+        this->_strand.wrap(
+            [this, socket, operation, handler](
+                boost::system::error_code const & e)
+            {
+                handler(
+                    this->_stop_async_deadline(
+                        this->_read_deadline, operation, e));
+            }));
+}
+
+void
+Transport
+::async_read(char * data, std::size_t length, Handler const & handler)
+{
+    if(!this->is_open())
+    {
+        throw Exception("Not connected");
+    }
+
+    auto const operation = std::make_shared<Operation>(Operation::PENDING);
+    this->_start_async_deadline(this->_read_deadline, operation);
+
+    auto const socket = this->_socket;
+    boost::asio::async_read(
+        *socket, boost::asio::buffer(data, length),
+        this->_strand.wrap(
+            [this, socket, operation, handler](
+                boost::system::error_code const & e, std::size_t)
+            {
+                handler(
+                    this->_stop_async_deadline(
+                        this->_read_deadline, operation, e));
+            }));
+}
+
+void
+Transport
+::async_write(
+    std::vector<boost::asio::const_buffer> const & buffers,
+    Handler const & handler)
+{
+    if(!this->is_open())
+    {
+        throw Exception("Not connected");
+    }
+
+    // The queue is only modified by the strand.
+    this->_strand.dispatch(
+        [this, buffers, handler]()
+        {
+            auto & pending = this->_queue_write(handler);
+            pending.buffers = buffers;
+            this->_write_next();
+        });
+}
+
 void
 Transport
 ::_start_deadline(Source & source, boost::system::error_code & error)
@@ -312,6 +486,132 @@ Transport
     }
 }
 
+Transport::PendingWrite &
+Transport
+::_queue_write(Handler const & handler)
+{
+    // Elements of a deque are not moved when adding at the end: the buffers
+    // may reference the data of their element.
+    this->_pending_writes.emplace_back();
+    auto & pending = this->_pending_writes.back();
+    pending.handler = handler;
+    return pending;
+}
+
+void
+Transport
+::_write_next()
+{
+    if(this->_writing || this->_pending_writes.empty())
+    {
+        return;
+    }
+
+    this->_writing = true;
+
+    auto const socket = this->_socket;
+    if(!socket)
+    {
+        // Closed while data was pending: fail in a handler, as a write would.
+        this->_service.post(
+            this->_strand.wrap(
+                [this]()
+                {
+                    this->_fail_writes(boost::asio::error::not_connected);
+                }));
+        return;
+    }
+
+    auto const operation = std::make_shared<Operation>(Operation::PENDING);
+    this->_start_async_deadline(this->_write_deadline, operation);
+
+    boost::asio::async_write(
+        *socket, this->_pending_writes.front().buffers,
+        this->_strand.wrap(
+            [this, socket, operation](
+                boost::system::error_code const & e, std::size_t)
+            {
+                auto const error = this->_stop_async_deadline(
+                    this->_write_deadline, operation, e);
+
+                if(error)
+                {
+                    this->_fail_writes(error);
+                }
+                else
+                {
+                    this->_writing = false;
+                    auto const handler = this->_pending_writes.front().handler;
+                    this->_pending_writes.pop_front();
+                    this->_write_next();
+                    if(handler)
+                    {
+                        handler(error);
+                    }
+                }
+            }));
+}
+
+void
+Transport
+::_fail_writes(boost::system::error_code const & error)
+{
+    ODIL_LOG(debug) << "Could not write: " << error.message();
+
+    this->_writing = false;
+    std::deque<PendingWrite> failed;
+    failed.swap(this->_pending_writes);
+    for(auto const & pending: failed)
+    {
+        if(pending.handler)
+        {
+            pending.handler(error);
+        }
+    }
+}
+
+void
+Transport
+::_start_async_deadline(
+    boost::asio::deadline_timer & deadline,
+    std::shared_ptr<Operation> const & operation)
+{
+    deadline.expires_from_now(this->_timeout);
+    deadline.async_wait(
+        this->_strand.wrap(
+            [this, operation](boost::system::error_code const & e)
+            {
+                // The timer may expire after the completion of its operation,
+                // and after having been re-armed for the next one.
+                if(e || *operation != Operation::PENDING || !this->_socket)
+                {
+                    return;
+                }
+                *operation = Operation::TIMED_OUT;
+
+                // The operations of a socket cannot be canceled one by one:
+                // close it, and report the time out to all of them.
+                this->_timed_out = true;
+                this->close();
+            }));
+}
+
+boost::system::error_code
+Transport
+::_stop_async_deadline(
+    boost::asio::deadline_timer & deadline,
+    std::shared_ptr<Operation> const & operation,
+    boost::system::error_code const & error)
+{
+    auto const timed_out =
+        *operation == Operation::TIMED_OUT
+        || (this->_timed_out && error == boost::asio::error::operation_aborted);
+    *operation = Operation::COMPLETED;
+    deadline.expires_at(boost::posix_time::pos_infin);
+
+    return timed_out ? boost::asio::error::timed_out : error;
+}
+
 }
 
 }
@@ -9,8 +9,11 @@
 #ifndef _1619bae8_acba_4bf8_8205_aa8dd0085c66
 #define _1619bae8_acba_4bf8_8205_aa8dd0085c66
 
+#include <deque>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/date_time.hpp>
@@ -29,6 +32,15 @@ namespace dul
  * The behavior of connect, receive, read and write is governed by the timeout
  * value: if the timeout expires before the operation is completed, an exception
  * will be raised.
+ *
+ * A transport created on a caller-supplied io_service is asynchronous: it is
+ * driven by the threads running the io_service, and the blocking operations
+ * are not available. Writes may be started from any thread, the data is
+ * queued by the strand. The completion handlers of an asynchronous transport
+ * are run by its strand; the transport must outlive its pending operations.
+ *
+ * When an asynchronous operation times out, the connection is closed and all
+ * the pending operations fail with boost::asio::error::timed_out.
  */
 struct ODIL_API Transport
 {
@@ -38,9 +50,15 @@ struct ODIL_API Transport
     /// @brief Duration of the timeout.
     typedef boost::asio::deadline_timer::duration_type duration_type;
 
+    /// @brief Completion handler of asynchronous operations.
+    typedef std::function<void(boost::system::error_code const &)> Handler;
+
     /// @brief Constructor.
     Transport();
 
+    /// @brief Create an asynchronous transport, run by the io_service.
+    Transport(boost::asio::io_service & service);
+
     /// @brief Destructor.
     ~Transport();
 
@@ -50,6 +68,12 @@ struct ODIL_API Transport
     /// @brief Return the io_service.
     boost::asio::io_service & get_service();
 
+    /// @brief Test whether the transport is run by a caller-supplied io_service.
+    bool is_asynchronous() const;
+
+    /// @brief Return the strand serializing the asynchronous handlers.
+    boost::asio::io_service::strand & get_strand();
+
     /// @brief Return the socket.
     std::shared_ptr<Socket const> get_socket() const;
 
@@ -74,21 +98,69 @@ struct ODIL_API Transport
      */
     void receive(Socket::endpoint_type const & endpoint);
 
+    /**
+     * @brief Asynchronously accept a connection on an acceptor, which may be
+     * run by another io_service. The handler is called by the io_service of
+     * the acceptor.
+     */
+    void async_receive(
+        boost::asio::ip::tcp::acceptor & acceptor, Handler const & handler);
+
     /// @brief Close the connection.
     void close();
 
     /// @brief Read data, raise an exception on error.
     std::string read(std::size_t length);
 
+    /// @brief Read data in a caller-supplied buffer, raise an exception on error.
+    void read(char * data, std::size_t length);
+
     /// @brief Write data, raise an exception on error.
     void write(std::string const & data);
 
+    /**
+     * @brief Write the content of several buffers using vectored I/O, raise
+     * an exception on error.
+     */
+    void write(std::vector<boost::asio::const_buffer> const & buffers);
+
+    /// @brief Asynchronously connect to the specified endpoint.
+    void async_connect(
+        Socket::endpoint_type const & peer_endpoint, Handler const & handler);
+
+    /// @brief Asynchronously read data in a caller-supplied buffer.
+    void async_read(char * data, std::size_t length, Handler const & handler);
+
+    /**
+     * @brief Asynchronously write the content of several buffers, after the
+     * previously queued data. The buffers must be valid until the handler is
+     * called.
+     */
+    void async_write(
+        std::vector<boost::asio::const_buffer> const & buffers,
+        Handler const & handler);
+
 private:
-    boost::asio::io_service _service;
+    /// @brief Data to be written by an asynchronous transport.
+    struct PendingWrite
+    {
+        std::vector<boost::asio::const_buffer> buffers;
+        Handler handler;
+    };
+
+    std::shared_ptr<boost::asio::io_service> _own_service;
+    boost::asio::io_service & _service;
+    boost::asio::io_service::strand _strand;
     std::shared_ptr<Socket> _socket;
     duration_type _timeout;
     boost::asio::deadline_timer _deadline;
 
+    boost::asio::deadline_timer _read_deadline;
+    boost::asio::deadline_timer _write_deadline;
+    std::deque<PendingWrite> _pending_writes;
+    bool _writing;
+    bool _timed_out;
+
     std::shared_ptr<boost::asio::ip::tcp::acceptor> _acceptor;
 
     enum class Source
@@ -98,10 +170,44 @@ private:
         OPERATION,
     };
 
+    /// @brief State of an asynchronous operation guarded by a timer.
+    enum class Operation
+    {
+        PENDING,
+        COMPLETED,
+        TIMED_OUT,
+    };
+
     void _start_deadline(Source & source, boost::system::error_code & error);
     void _stop_deadline();
 
     void _run(Source & source, boost::system::error_code & error);
+
+    /// @brief Queue data to be written by an asynchronous transport.
+    PendingWrite & _queue_write(Handler const & handler);
+
+    /// @brief Start writing the first queued data, if not already writing.
+    void _write_next();
+
+    /// @brief Report an error to the handlers of all the queued data.
+    void _fail_writes(boost::system::error_code const & error);
+
+    /**
+     * @brief Start the timer of an asynchronous operation, closing the
+     * connection if the operation is still pending upon expiration.
+     */
+    void _start_async_deadline(
+        boost::asio::deadline_timer & deadline,
+        std::shared_ptr<Operation> const & operation);
+
+    /**
+     * @brief Stop the timer of a completed asynchronous operation, return its
+     * error.
+     */
+    boost::system::error_code _stop_async_deadline(
+        boost::asio::deadline_timer & deadline,
+        std::shared_ptr<Operation> const & operation,
+        boost::system::error_code const & error);
 };
 
 }
@@ -8,7 +8,131 @@
 
 #include "odil/endian.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define ODIL_SSSE3
+#elif defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ODIL_SSE2
+#endif
+
+#include "odil/Exception.h"
+
+namespace
+{
+
+uint16_t swap_word(uint16_t x)
+{
+    return (x >> 8) | (x << 8);
+}
+
+uint32_t swap_word(uint32_t x)
+{
+    return
+        ((x & 0x000000ffu) << 24) | ((x & 0x0000ff00u) << 8)
+        | ((x & 0x00ff0000u) >> 8) | ((x & 0xff000000u) >> 24);
+}
+
+uint64_t swap_word(uint64_t x)
+{
+    return
+        (uint64_t(swap_word(uint32_t(x))) << 32)
+        | swap_word(uint32_t(x >> 32));
+}
+
+/// @brief Swap the remaining words which do not fill a SIMD register.
+template<typename T>
+void swap_scalar(char * data, std::size_t count)
+{
+    for(std::size_t i=0; i<count; ++i, data += sizeof(T))
+    {
+        // Go through memcpy: the array may not be aligned on sizeof(T).
+        T word;
+        std::memcpy(&word, data, sizeof(T));
+        word = swap_word(word);
+        std::memcpy(data, &word, sizeof(T));
+    }
+}
+
+#if defined(ODIL_SSSE3)
+
+template<typename T>
+__m128i swap_register(__m128i value);
+
+template<>
+__m128i swap_register<uint16_t>(__m128i value)
+{
+    return _mm_shuffle_epi8(
+        value, _mm_set_epi8(14,15, 12,13, 10,11, 8,9, 6,7, 4,5, 2,3, 0,1));
+}
+
+template<>
+__m128i swap_register<uint32_t>(__m128i value)
+{
+    return _mm_shuffle_epi8(
+        value, _mm_set_epi8(12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3));
+}
+
+template<>
+__m128i swap_register<uint64_t>(__m128i value)
+{
+    return _mm_shuffle_epi8(
+        value, _mm_set_epi8(8,9,10,11,12,13,14,15, 0,1,2,3,4,5,6,7));
+}
+
+#elif defined(ODIL_SSE2)
+
+template<typename T>
+__m128i swap_register(__m128i value);
+
+template<>
+__m128i swap_register<uint16_t>(__m128i value)
+{
+    return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+}
+
+template<>
+__m128i swap_register<uint32_t>(__m128i value)
+{
+    // Swap the 16-bits halves of each word, then the bytes of each half.
+    value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+    value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+    return swap_register<uint16_t>(value);
+}
+
+template<>
+__m128i swap_register<uint64_t>(__m128i value)
+{
+    // Reverse the 16-bits quarters of each word, then the bytes of each one.
+    value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+    value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+    return swap_register<uint16_t>(value);
+}
+
+#endif
+
+template<typename T>
+void swap(char * data, std::size_t size)
+{
+#if defined(ODIL_SSSE3) || defined(ODIL_SSE2)
+    auto const end = data + (size - size%16);
+    for(/* no initialization */; data != end; data += 16)
+    {
+        auto const value = _mm_loadu_si128(reinterpret_cast<__m128i*>(data));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(data), swap_register<T>(value));
+    }
+    size %= 16;
+#endif
+    swap_scalar<T>(data, size/sizeof(T));
+}
+
+}
 
 namespace odil
 {
@@ -22,4 +146,44 @@ ByteOrdering get_endianness()
 
 ByteOrdering const byte_ordering{get_endianness()};
 
+void swap_bytes(void * data, std::size_t size, std::size_t word_size)
+{
+    if(size % word_size != 0)
+    {
+        throw Exception("Array size is not a multiple of the word size");
+    }
+
+    auto bytes = reinterpret_cast<char *>(data);
+    if(word_size == 1)
+    {
+        // Nothing to do.
+    }
+    else if(word_size == 2)
+    {
+        swap<uint16_t>(bytes, size);
+    }
+    else if(word_size == 4)
+    {
+        swap<uint32_t>(bytes, size);
+    }
+    else if(word_size == 8)
+    {
+        swap<uint64_t>(bytes, size);
+    }
+    else
+    {
+        throw Exception("Invalid word size");
+    }
+}
+
+void convert_byte_ordering(
+    void * data, std::size_t size, std::size_t word_size,
+    ByteOrdering ordering)
+{
+    if(ordering != byte_ordering)
+    {
+        swap_bytes(data, size, word_size);
+    }
+}
+
 }
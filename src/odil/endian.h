@@ -9,6 +9,8 @@
 #ifndef _05d00816_25d0_41d1_9768_afd39f0503da
 #define _05d00816_25d0_41d1_9768_afd39f0503da
 
+#include <cstddef>
+
 #include "odil/odil.h"
 
 #define ODIL_SWAP \
@@ -36,6 +38,22 @@ ByteOrdering ODIL_API get_endianness();
 
 extern ODIL_API ByteOrdering const byte_ordering;
 
+/**
+ * @brief Reverse in place the bytes of each word of an array.
+ *
+ * The size of the array is given in bytes, and must be a multiple of the
+ * word size (1, 2, 4 or 8). SIMD instructions are used when available.
+ */
+void ODIL_API swap_bytes(void * data, std::size_t size, std::size_t word_size);
+
+/**
+ * @brief Convert in place an array of words between the host byte ordering
+ * and the given byte ordering; nothing is done if they match.
+ */
+void ODIL_API convert_byte_ordering(
+    void * data, std::size_t size, std::size_t word_size,
+    ByteOrdering ordering);
+
 template<typename T>
 T host_to_big_endian(T const & value)
 {
@@ -21,7 +21,7 @@ namespace message
 
 Message
 ::Message(std::shared_ptr<DataSet> command_set, std::shared_ptr<DataSet> data_set)
-: _command_set(command_set)
+: _command_set(command_set), _data_set_streamed(false)
 {
     if(!this->_command_set->has(registry::CommandDataSetType))
     {
@@ -75,6 +75,7 @@ Message
 ::set_data_set(std::shared_ptr<DataSet> data_set)
 {
     this->_data_set = data_set;
+    this->_data_set_streamed = false;
     this->_command_set->as_int(registry::CommandDataSetType) = {
         this->_data_set?DataSetType::PRESENT:DataSetType::ABSENT };
 }
@@ -86,6 +87,20 @@ Message
     this->set_data_set(nullptr);
 }
 
+bool
+Message
+::is_data_set_streamed() const
+{
+    return this->_data_set_streamed;
+}
+
+void
+Message
+::set_data_set_streamed(bool streamed)
+{
+    this->_data_set_streamed = streamed;
+}
+
 }
 
 }
@@ -161,6 +161,15 @@ public:
 
     /// @brief Delete the data set in this message.
     void delete_data_set();
+
+    /**
+     * @brief Test whether the encoded data set was written to a stream
+     * instead of being decoded, in which case the data set is empty.
+     */
+    bool is_data_set_streamed() const;
+
+    /// @brief Set whether the encoded data set was written to a stream.
+    void set_data_set_streamed(bool streamed);
     
     ODIL_MESSAGE_MANDATORY_FIELD_INTEGER_MACRO(
         command_field, registry::CommandField)
@@ -171,6 +180,9 @@ protected:
     
     /// @brief Data set of the message.
     std::shared_ptr<DataSet> _data_set;
+
+    /// @brief Whether the encoded data set was written to a stream.
+    bool _data_set_streamed;
 };
 
 }
@@ -0,0 +1,312 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#include "odil/numeric_string.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "odil/logging.h"
+#include "odil/Value.h"
+
+namespace
+{
+
+/// @brief Exact powers of ten representable as double.
+double const powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+char const * skip_spaces(char const * begin, char const * end)
+{
+    while(begin != end && *begin == ' ')
+    {
+        ++begin;
+    }
+    return begin;
+}
+
+/// @brief Test whether only spaces remain in [begin, end).
+bool is_blank(char const * begin, char const * end)
+{
+    return skip_spaces(begin, end) == end;
+}
+
+/**
+ * @brief Parse an IS item with std::stoll, used when the fast path cannot
+ * handle the item.
+ */
+bool parse_slow(
+    char const * begin, char const * end, odil::Value::Integer & value)
+{
+    try
+    {
+        value = std::stoll(std::string(begin, end));
+    }
+    catch(std::invalid_argument const &)
+    {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parse a DS item with std::stold, used when the fast path cannot
+ * handle the item or is not exact.
+ */
+bool parse_slow(
+    char const * begin, char const * end, odil::Value::Real & value)
+{
+    try
+    {
+        value = static_cast<odil::Value::Real>(
+            std::stold(std::string(begin, end)));
+    }
+    catch(std::invalid_argument const &)
+    {
+        return false;
+    }
+    return true;
+}
+
+/// @brief Call the parser on each backslash-separated item of the value.
+template<typename TValues, typename TParser>
+void read_items(
+    char const * begin, char const * end, TValues & values,
+    char const * vr, TParser parser)
+{
+    values.resize(1+std::count(begin, end, '\\'));
+    auto it = begin;
+    for(auto & value: values)
+    {
+        auto const item_end = std::find(it, end, '\\');
+        if(!parser(it, item_end, value))
+        {
+            ODIL_LOG(error)
+                << "Cannot convert \"" << std::string(it, item_end)
+                << "\" to " << vr << ", setting to 0";
+            value = 0;
+        }
+        it = (item_end == end)?end:(item_end+1);
+    }
+}
+
+}
+
+namespace odil
+{
+
+bool read_is(char const * begin, char const * end, Value::Integer & value)
+{
+    auto it = skip_spaces(begin, end);
+
+    bool negative = false;
+    if(it != end && (*it == '+' || *it == '-'))
+    {
+        negative = (*it == '-');
+        ++it;
+    }
+
+    if(it == end || !is_digit(*it))
+    {
+        return parse_slow(begin, end, value);
+    }
+
+    uint64_t const limit =
+        uint64_t(std::numeric_limits<Value::Integer>::max())
+        + (negative?1:0);
+    uint64_t magnitude = 0;
+    while(it != end && is_digit(*it))
+    {
+        unsigned int const digit = *it-'0';
+        if(magnitude > (limit-digit)/10)
+        {
+            return parse_slow(begin, end, value);
+        }
+        magnitude = 10*magnitude+digit;
+        ++it;
+    }
+    if(!is_blank(it, end))
+    {
+        return parse_slow(begin, end, value);
+    }
+
+    value =
+        negative
+        ? Value::Integer(0-magnitude)
+        : Value::Integer(magnitude);
+    return true;
+}
+
+bool read_ds(char const * begin, char const * end, Value::Real & value)
+{
+    auto it = skip_spaces(begin, end);
+
+    bool negative = false;
+    if(it != end && (*it == '+' || *it == '-'))
+    {
+        negative = (*it == '-');
+        ++it;
+    }
+
+    // Keep up to 19 significant digits in the mantissa, which fits in 64 bits.
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool exact = true;
+    bool has_digits = false;
+
+    while(it != end && is_digit(*it))
+    {
+        has_digits = true;
+        if(digits < 19)
+        {
+            mantissa = 10*mantissa+(*it-'0');
+            digits += (mantissa != 0)?1:0;
+        }
+        else
+        {
+            exact = exact && (*it == '0');
+            ++exponent;
+        }
+        ++it;
+    }
+    if(it != end && *it == '.')
+    {
+        ++it;
+        while(it != end && is_digit(*it))
+        {
+            has_digits = true;
+            if(digits < 19)
+            {
+                mantissa = 10*mantissa+(*it-'0');
+                digits += (mantissa != 0)?1:0;
+                --exponent;
+            }
+            else
+            {
+                exact = exact && (*it == '0');
+            }
+            ++it;
+        }
+    }
+
+    if(!has_digits)
+    {
+        // e.g. "nan", "inf", or other spaces than ' '
+        return parse_slow(begin, end, value);
+    }
+
+    if(it != end && (*it == 'e' || *it == 'E'))
+    {
+        auto exponent_it = it+1;
+        bool negative_exponent = false;
+        if(exponent_it != end && (*exponent_it == '+' || *exponent_it == '-'))
+        {
+            negative_exponent = (*exponent_it == '-');
+            ++exponent_it;
+        }
+        if(exponent_it != end && is_digit(*exponent_it))
+        {
+            int explicit_exponent = 0;
+            while(exponent_it != end && is_digit(*exponent_it))
+            {
+                if(explicit_exponent < 100000)
+                {
+                    explicit_exponent = 10*explicit_exponent+(*exponent_it-'0');
+                }
+                ++exponent_it;
+            }
+            exponent +=
+                negative_exponent?-explicit_exponent:explicit_exponent;
+            it = exponent_it;
+        }
+    }
+
+    if(!is_blank(it, end))
+    {
+        // e.g. hexadecimal numbers or trailing characters
+        return parse_slow(begin, end, value);
+    }
+
+    if(mantissa == 0)
+    {
+        value = negative?-0.:0.;
+    }
+    else if(
+        exact && mantissa <= (uint64_t(1) << 53)
+        && exponent >= -22 && exponent <= 22)
+    {
+        // Both the mantissa and the power of ten are exact doubles: a single
+        // multiplication or division is correctly rounded.
+        double const magnitude =
+            (exponent < 0)
+            ? double(mantissa)/powers_of_ten[-exponent]
+            : double(mantissa)*powers_of_ten[exponent];
+        value = negative?-magnitude:magnitude;
+    }
+    else
+    {
+        return parse_slow(begin, end, value);
+    }
+
+    return true;
+}
+
+void read_is(char const * begin, char const * end, Value::Integers & values)
+{
+    read_items(
+        begin, end, values, "IS",
+        [](char const * b, char const * e, Value::Integer & v) {
+            return read_is(b, e, v); });
+}
+
+void read_ds(char const * begin, char const * end, Value::Reals & values)
+{
+    read_items(
+        begin, end, values, "DS",
+        [](char const * b, char const * e, Value::Real & v) {
+            return read_ds(b, e, v); });
+}
+
+std::size_t write_is(Value::Integer value, char * buffer)
+{
+    char digits[20];
+    char * digits_end = digits+sizeof(digits);
+    char * digits_begin = digits_end;
+
+    uint64_t magnitude = (value < 0)?(0-uint64_t(value)):uint64_t(value);
+    do
+    {
+        --digits_begin;
+        *digits_begin = '0'+(magnitude%10);
+        magnitude /= 10;
+    }
+    while(magnitude != 0);
+
+    auto it = buffer;
+    if(value < 0)
+    {
+        *it = '-';
+        ++it;
+    }
+    it = std::copy(digits_begin, digits_end, it);
+
+    return it-buffer;
+}
+
+}
@@ -0,0 +1,62 @@
+/*************************************************************************
+ * odil - Copyright (C) Universite de Strasbourg
+ * Distributed under the terms of the CeCILL-B license, as published by
+ * the CEA-CNRS-INRIA. Refer to the LICENSE file or to
+ * http://www.cecill.info/licences/Licence_CeCILL-B_V1-en.html
+ * for details.
+ ************************************************************************/
+
+#ifndef _9c3f5e1a_2b47_4d8e_a6f0_7e1d3c5b9a24
+#define _9c3f5e1a_2b47_4d8e_a6f0_7e1d3c5b9a24
+
+#include <cstddef>
+
+#include "odil/odil.h"
+#include "odil/Value.h"
+
+namespace odil
+{
+
+/**
+ * @brief Parse an IS item from [begin, end), with the same results as
+ * std::stoll.
+ *
+ * Return false if no integer could be parsed, throw std::out_of_range if it
+ * overflows.
+ */
+ODIL_API bool read_is(
+    char const * begin, char const * end, Value::Integer & value);
+
+/**
+ * @brief Parse a DS item from [begin, end), with the same results as
+ * std::stold.
+ *
+ * Return false if no number could be parsed, throw std::out_of_range if it
+ * overflows.
+ */
+ODIL_API bool read_ds(
+    char const * begin, char const * end, Value::Real & value);
+
+/**
+ * @brief Parse the backslash-separated items of an IS value, invalid items
+ * are logged and set to 0.
+ */
+ODIL_API void read_is(
+    char const * begin, char const * end, Value::Integers & values);
+
+/**
+ * @brief Parse the backslash-separated items of a DS value, invalid items
+ * are logged and set to 0.
+ */
+ODIL_API void read_ds(
+    char const * begin, char const * end, Value::Reals & values);
+
+/**
+ * @brief Write an integer as an IS to the buffer, which must hold at least 20
+ * characters. Return the number of characters written, no NUL is appended.
+ */
+ODIL_API std::size_t write_is(Value::Integer value, char * buffer);
+
+}
+
+#endif // _9c3f5e1a_2b47_4d8e_a6f0_7e1d3c5b9a24
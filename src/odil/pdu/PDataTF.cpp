@@ -9,11 +9,14 @@
 #include "odil/pdu/PDataTF.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <istream>
 #include <string>
 #include <vector>
 
+#include "odil/endian.h"
 #include "odil/Exception.h"
 #include "odil/pdu/Item.h"
 #include "odil/pdu/Object.h"
@@ -113,6 +116,48 @@ PDataTF::PresentationDataValueItem
     this->_item.as_unsigned_int_32("Item-length") = 2+fragment.size();
 }
 
+bool
+PDataTF::PresentationDataValueView
+::is_command() const
+{
+    return (this->control_header%2==1);
+}
+
+bool
+PDataTF::PresentationDataValueView
+::is_last_fragment() const
+{
+    return ((this->control_header>>1)%2==1);
+}
+
+void
+PDataTF
+::read_pdv_items(
+    char const * begin, char const * end,
+    std::vector<PresentationDataValueView> & pdv_items)
+{
+    pdv_items.clear();
+    while(begin != end)
+    {
+        // Item-length, Presentation-context-ID, Message Control Header
+        if(end-begin < 6)
+        {
+            throw Exception("Invalid Presentation Data Value Item");
+        }
+        uint32_t item_length;
+        std::memcpy(&item_length, begin, 4);
+        item_length = big_endian_to_host(item_length);
+        if(item_length < 2 || uint32_t(end-begin-4) < item_length)
+        {
+            throw Exception("Invalid Presentation Data Value Item length");
+        }
+
+        pdv_items.push_back({
+            uint8_t(begin[4]), uint8_t(begin[5]), begin+6, item_length-2});
+        begin += 4+item_length;
+    }
+}
+
 PDataTF
 ::PDataTF(std::vector<PresentationDataValueItem> const & pdv_items)
 {
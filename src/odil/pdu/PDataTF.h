@@ -9,6 +9,7 @@
 #ifndef _b3062f12_8a06_46a8_9dda_8a7edf96e4a6
 #define _b3062f12_8a06_46a8_9dda_8a7edf96e4a6
 
+#include <cstddef>
 #include <cstdint>
 #include <istream>
 #include <vector>
@@ -48,6 +49,29 @@ public:
         void set_fragment(std::string const & fragment);
     };
 
+    /**
+     * @brief Presentation Data Value Item of an encoded PDU, whose fragment
+     * references the buffer of the PDU.
+     */
+    struct ODIL_API PresentationDataValueView
+    {
+        uint8_t presentation_context_id;
+        uint8_t control_header;
+        char const * fragment;
+        std::size_t fragment_size;
+
+        bool is_command() const;
+        bool is_last_fragment() const;
+    };
+
+    /**
+     * @brief Parse the Presentation Data Value Items of an encoded PDU, from
+     * the end of the PDU-length field, without copying the fragments.
+     */
+    static void read_pdv_items(
+        char const * begin, char const * end,
+        std::vector<PresentationDataValueView> & pdv_items);
+
     /// @brief Constructor.
     PDataTF(std::vector<PresentationDataValueItem> const & pdv_items);
 
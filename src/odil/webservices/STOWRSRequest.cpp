@@ -556,7 +556,7 @@ STOWRSRequest
     for(auto & it: *data_set)
     {
         auto & tag = it.first;
-        auto & element = it.second;
+        auto const & element = it.second;
         if(element.is_binary())
         {
             // 1. generate uuid
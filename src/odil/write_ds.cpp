@@ -8,10 +8,13 @@
 
 #include "odil/write_ds.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 // Helper functions
 namespace 
@@ -114,12 +117,120 @@ int roundat(char * buffer, unsigned int i, int exponent, int & size)
     return 0;
 }
 
-}
-
-namespace odil
+/**
+ * @brief Write the shortest decimal representation of f, if it is a short,
+ * non-scientific, decimal number (e.g. most coordinates in mm).
+ * @return false if f is not such a number, in which case buffer is unchanged.
+ */
+bool write_short_decimal(double f, char * buffer, int size)
 {
+    static double const powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+        1e13, 1e14, 1e15};
+    static double const max_exact = 9007199254740992.; // 2^53
 
-void write_ds(double f, char * buffer, int size)
+    if(f == 0)
+    {
+        if(std::signbit(f))
+        {
+            return false;
+        }
+        strcpy(buffer, "0");
+        return true;
+    }
+
+    double const magnitude = std::fabs(f);
+    if(!(magnitude >= 1e-3 && magnitude < 1e15))
+    {
+        return false;
+    }
+
+    // Find the smallest number of decimals k such that round(|f|*10^k)/10^k
+    // is converted back to |f|: this is then the shortest representation.
+    uint64_t digits = 0;
+    int decimals = 0;
+    bool found = false;
+    for(; decimals < 16; ++decimals)
+    {
+        double const scaled = magnitude*powers_of_ten[decimals];
+        if(scaled >= max_exact)
+        {
+            break;
+        }
+        double const candidate = std::floor(scaled+0.5);
+        if(candidate/powers_of_ten[decimals] == magnitude)
+        {
+            digits = uint64_t(candidate);
+            found = true;
+            break;
+        }
+    }
+    if(!found)
+    {
+        return false;
+    }
+
+    char reversed[20];
+    int length = 0;
+    do
+    {
+        reversed[length] = '0'+(digits%10);
+        digits /= 10;
+        ++length;
+    }
+    while(digits != 0);
+
+    // Drop trailing zeros of the fractional part
+    int first = 0;
+    while(decimals > 0 && reversed[first] == '0')
+    {
+        ++first;
+        --decimals;
+    }
+
+    int const significant_length = length-first;
+    int const integer_length = std::max(0, significant_length-decimals);
+    int const leading_zeros = std::max(0, decimals-significant_length);
+    int const total_length =
+        (f<0?1:0) + integer_length + (decimals>0?1:0)
+        + leading_zeros + significant_length - integer_length;
+    if(total_length >= size)
+    {
+        return false;
+    }
+
+    char * it = buffer;
+    if(f < 0)
+    {
+        *it++ = '-';
+    }
+    int index = length-1;
+    for(; index >= length-integer_length; --index)
+    {
+        *it++ = reversed[index];
+    }
+    if(decimals > 0)
+    {
+        *it++ = '.';
+        for(int i=0; i<leading_zeros; ++i)
+        {
+            *it++ = '0';
+        }
+        for(; index >= first; --index)
+        {
+            *it++ = reversed[index];
+        }
+    }
+    *it = '\0';
+
+    return true;
+}
+
+/**
+ * @brief Write f with size-1 characters at most, using the full precision;
+ * numbers less than 1 may use one more character.
+ */
+void write_long_decimal(double f, char * buffer, int size)
 {
     // Negative number: add initial '-' to buffer and process as positive number
     if(f < 0)
@@ -215,3 +326,39 @@ void write_ds(double f, char * buffer, int size)
 }
 
 }
+
+namespace odil
+{
+
+void write_ds(double f, char * buffer, int size)
+{
+    if(write_short_decimal(f, buffer, size))
+    {
+        return;
+    }
+
+    // The long form of numbers less than 1 may use one character more than
+    // requested: write it in a larger buffer and drop its last digits until
+    // it fits.
+    char local[64];
+    std::vector<char> allocated;
+    char * temporary = local;
+    if(size+8 > int(sizeof(local)))
+    {
+        allocated.resize(size+8);
+        temporary = allocated.data();
+    }
+
+    for(int reduced=size; reduced > 0; --reduced)
+    {
+        write_long_decimal(f, temporary, reduced);
+        if(int(strlen(temporary)) < size)
+        {
+            break;
+        }
+    }
+    strncpy(buffer, temporary, size-1);
+    buffer[size-1] = '\0';
+}
+
+}
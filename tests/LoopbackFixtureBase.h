@@ -0,0 +1,136 @@
+#ifndef _6f0d3c52_8a41_4be2_9d17_2c5e83a4f1b9
+#define _6f0d3c52_8a41_4be2_9d17_2c5e83a4f1b9
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "odil/Association.h"
+#include "odil/AssociationParameters.h"
+#include "odil/EchoSCP.h"
+#include "odil/registry.h"
+#include "odil/SCPDispatcher.h"
+#include "odil/SCPServer.h"
+#include "odil/StoreSCP.h"
+#include "odil/message/CEchoRequest.h"
+#include "odil/message/CStoreRequest.h"
+#include "odil/message/Message.h"
+#include "odil/message/Response.h"
+
+/**
+ * @brief Base class for fixtures requiring a local server, which answers
+ * C-ECHO and C-STORE requests.
+ */
+class LoopbackFixtureBase
+{
+public:
+    typedef
+        odil::AssociationParameters::PresentationContext PresentationContext;
+
+    std::atomic<int> echoes;
+    std::mutex mutex;
+    std::set<std::string> stored;
+    odil::SCPServer server;
+
+    /// @brief Create the server, start must be called once it is configured.
+    LoopbackFixtureBase(unsigned short port)
+    : echoes(0), server(
+        boost::asio::ip::tcp::v4(), port,
+        [this](odil::Association & association)
+        {
+            auto dispatcher =
+                std::make_shared<odil::SCPDispatcher>(association);
+            dispatcher->set_scp(
+                odil::message::Message::Command::C_ECHO_RQ,
+                std::make_shared<odil::EchoSCP>(
+                    association,
+                    [this](std::shared_ptr<odil::message::CEchoRequest const>)
+                    {
+                        ++this->echoes;
+                        return odil::message::Response::Success;
+                    }));
+            dispatcher->set_scp(
+                odil::message::Message::Command::C_STORE_RQ,
+                std::make_shared<odil::StoreSCP>(
+                    association,
+                    [this](std::shared_ptr<odil::message::CStoreRequest> request)
+                    {
+                        std::lock_guard<std::mutex> lock(this->mutex);
+                        this->stored.insert(
+                            request->get_affected_sop_instance_uid());
+                        return odil::message::Response::Success;
+                    }));
+            return dispatcher;
+        })
+    {
+        this->server.set_tcp_timeout(boost::posix_time::seconds(5));
+    }
+
+    ~LoopbackFixtureBase()
+    {
+        if(this->_thread.joinable())
+        {
+            this->stop();
+        }
+    }
+
+    /// @brief Run the server in its own thread, return once it listens.
+    void start()
+    {
+        this->_thread = std::thread([this]() { this->server.run(); });
+        this->server.wait_listening();
+    }
+
+    /// @brief Stop the server and wait for its thread.
+    void stop()
+    {
+        this->server.stop();
+        this->_thread.join();
+    }
+
+    /**
+     * @brief Return a non-associated association with the server, proposing
+     * Verification by default.
+     */
+    odil::Association get_association(
+        std::string const & calling_ae_title="LOCAL",
+        std::string const & called_ae_title="REMOTE",
+        std::vector<PresentationContext> const & contexts={
+            {
+                1, odil::registry::Verification,
+                { odil::registry::ImplicitVRLittleEndian },
+                PresentationContext::Role::SCU
+            }
+        }) const
+    {
+        odil::Association association;
+        association.set_peer_host("127.0.0.1");
+        association.set_peer_port(this->server.get_port());
+        association.update_parameters()
+            .set_calling_ae_title(calling_ae_title)
+            .set_called_ae_title(called_ae_title)
+            .set_presentation_contexts(contexts);
+        return association;
+    }
+
+    /// @brief Return an association with the server, proposing Verification.
+    std::shared_ptr<odil::Association>
+    associate(std::string const & calling_ae_title) const
+    {
+        auto association = std::make_shared<odil::Association>(
+            this->get_association(calling_ae_title));
+        association->associate();
+        return association;
+    }
+
+private:
+    std::thread _thread;
+};
+
+#endif // _6f0d3c52_8a41_4be2_9d17_2c5e83a4f1b9
@@ -1,11 +1,26 @@
 #define BOOST_TEST_MODULE Association
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
+#include <exception>
+#include <memory>
 #include <ostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
 
 #include "odil/Association.h"
+#include "odil/DataSet.h"
+#include "odil/EchoSCP.h"
 #include "odil/Exception.h"
 #include "odil/registry.h"
+#include "odil/message/CEchoRequest.h"
+#include "odil/message/CEchoResponse.h"
+#include "odil/message/CStoreRequest.h"
+#include "odil/message/Response.h"
 
 #include "../PeerFixtureBase.h"
 
@@ -115,3 +130,171 @@ BOOST_AUTO_TEST_CASE(Abort)
     odil::Association association;
     BOOST_CHECK_THROW(association.abort(2, 4), odil::Exception);
 }
+
+BOOST_AUTO_TEST_CASE(Asynchronous)
+{
+    int echoes = 0;
+    std::thread server([&echoes]() {
+        odil::Association association;
+        association.set_tcp_timeout(boost::posix_time::seconds(5));
+        association.receive_association(boost::asio::ip::tcp::v4(), 11116);
+        odil::EchoSCP scp(
+            association,
+            [&echoes](std::shared_ptr<odil::message::CEchoRequest const>)
+            {
+                ++echoes;
+                return odil::message::Response::Success;
+            });
+        try
+        {
+            while(true)
+            {
+                scp.receive_and_process();
+            }
+        }
+        catch(odil::AssociationReleased const &)
+        {
+            // Expected
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    boost::asio::io_service service;
+    odil::Association association(service);
+    association.set_peer_host("127.0.0.1");
+    association.set_peer_port(11116);
+    association.update_parameters()
+        .set_calling_ae_title("LOCAL")
+        .set_called_ae_title("REMOTE")
+        .set_presentation_contexts({
+            {
+                1, odil::registry::Verification,
+                { odil::registry::ImplicitVRLittleEndian },
+                odil::AssociationParameters::PresentationContext::Role::SCU
+            }
+        });
+
+    std::vector<std::string> events;
+    auto const check = [&events](std::exception_ptr error) {
+        if(error)
+        {
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch(std::exception const & e)
+            {
+                events.push_back(std::string("error: ")+e.what());
+            }
+        }
+        return !error;
+    };
+
+    association.async_associate([&](std::exception_ptr error) {
+        if(!check(error)) { return; }
+        events.push_back("associated");
+
+        auto const request = std::make_shared<odil::message::CEchoRequest>(
+            association.next_message_id(), odil::registry::Verification);
+        association.async_send_message(
+            request, odil::registry::Verification,
+            [&](std::exception_ptr error) {
+                if(check(error)) { events.push_back("sent"); } });
+        association.async_receive_message(
+            [&](
+                std::shared_ptr<odil::message::Message> message,
+                std::exception_ptr error)
+            {
+                if(!check(error)) { return; }
+                odil::message::CEchoResponse const response(message);
+                events.push_back(
+                    "response "+std::to_string(response.get_status()));
+                association.async_release([&](std::exception_ptr error) {
+                    if(check(error)) { events.push_back("released"); } });
+            });
+    });
+
+    // Several threads may run the associations of an io_service.
+    std::vector<std::thread> threads;
+    for(int i=0; i<2; ++i)
+    {
+        threads.emplace_back([&service]() { service.run(); });
+    }
+    for(auto & thread: threads)
+    {
+        thread.join();
+    }
+    server.join();
+
+    BOOST_REQUIRE_EQUAL(echoes, 1);
+    BOOST_REQUIRE_EQUAL(events.size(), 4);
+    BOOST_REQUIRE_EQUAL(events[0], "associated");
+    // The completions of the write and of the read are not ordered when
+    // several threads run the io_service.
+    BOOST_REQUIRE(
+        std::set<std::string>(events.begin()+1, events.begin()+3)
+        == std::set<std::string>({"sent", "response 0"}));
+    BOOST_REQUIRE_EQUAL(events[3], "released");
+    BOOST_REQUIRE(!association.is_associated());
+}
+
+BOOST_AUTO_TEST_CASE(AsynchronousBlocking)
+{
+    boost::asio::io_service service;
+    odil::Association association(service);
+    association.set_peer_host("127.0.0.1");
+    BOOST_REQUIRE(association.get_transport().is_asynchronous());
+    BOOST_CHECK_THROW(association.associate(), odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(SendError)
+{
+    std::thread server([]() {
+        odil::Association association;
+        association.set_tcp_timeout(boost::posix_time::seconds(5));
+        association.receive_association(boost::asio::ip::tcp::v4(), 11133);
+        association.abort(0, 0);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    odil::Association association;
+    association.set_tcp_timeout(boost::posix_time::seconds(5));
+    association.set_peer_host("127.0.0.1");
+    association.set_peer_port(11133);
+    association.update_parameters()
+        .set_calling_ae_title("LOCAL")
+        .set_called_ae_title("REMOTE")
+        .set_presentation_contexts({
+            {
+                1, odil::registry::RawDataStorage,
+                { odil::registry::ImplicitVRLittleEndian },
+                odil::AssociationParameters::PresentationContext::Role::SCU
+            }
+        });
+    association.associate();
+    server.join();
+
+    // A large text value is written through the stream, and sent by its
+    // consumer while it is encoded.
+    auto data_set = std::make_shared<odil::DataSet>();
+    data_set->add(odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set->add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set->add(
+        odil::registry::TextValue, {std::string(32*1024*1024, 'x')});
+    auto const request = std::make_shared<odil::message::CStoreRequest>(
+        association.next_message_id(), odil::registry::RawDataStorage,
+        "1.2.3.4", odil::message::Message::Priority::MEDIUM, data_set);
+
+    // The error of the transport is reported, not a generic stream error.
+    std::string error;
+    try
+    {
+        association.send_message(request, odil::registry::RawDataStorage);
+    }
+    catch(odil::Exception const & e)
+    {
+        error = e.what();
+    }
+    BOOST_REQUIRE_NE(error, "");
+    BOOST_REQUIRE_NE(error, "Could not write to stream");
+}
@@ -0,0 +1,181 @@
+#define BOOST_TEST_MODULE AssociationPool
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "odil/Association.h"
+#include "odil/AssociationAcceptor.h"
+#include "odil/AssociationParameters.h"
+#include "odil/AssociationPool.h"
+#include "odil/EchoSCU.h"
+#include "odil/Exception.h"
+
+#include "../LoopbackFixtureBase.h"
+
+struct Fixture: public LoopbackFixtureBase
+{
+    std::atomic<int> associations;
+
+    Fixture(unsigned short port)
+    : LoopbackFixtureBase(port), associations(0)
+    {
+        // Counted during the negotiation, before the client is answered.
+        this->server.set_association_acceptor(
+            [this](odil::AssociationParameters const & request)
+            {
+                ++this->associations;
+                return odil::default_association_acceptor(request);
+            });
+        this->server.set_workers_count(8);
+        this->start();
+    }
+};
+
+BOOST_AUTO_TEST_CASE(Constructor)
+{
+    odil::AssociationPool const pool;
+    BOOST_REQUIRE_EQUAL(pool.get_maximum_associations_per_peer(), 4);
+    BOOST_REQUIRE(
+        pool.get_maximum_idle_time() == boost::posix_time::seconds(60));
+    BOOST_REQUIRE(
+        pool.get_liveness_check_interval() == boost::posix_time::seconds(5));
+    BOOST_REQUIRE(pool.get_acquire_timeout().is_pos_infinity());
+    BOOST_REQUIRE_EQUAL(pool.get_associations_count("127.0.0.1", 11127), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Reuse)
+{
+    Fixture fixture(11127);
+    odil::AssociationPool pool;
+
+    odil::Association * first = nullptr;
+    {
+        auto lease = pool.acquire(fixture.get_association("LOCAL", "REMOTE"));
+        BOOST_REQUIRE(lease->is_associated());
+        odil::EchoSCU(*lease).echo();
+        first = &lease.get_association();
+    }
+    BOOST_REQUIRE_EQUAL(pool.get_idle_associations_count("127.0.0.1", 11127), 1);
+
+    {
+        auto lease = pool.acquire(fixture.get_association("LOCAL", "REMOTE"));
+        BOOST_REQUIRE_EQUAL(&lease.get_association(), first);
+        odil::EchoSCU(*lease).echo();
+    }
+
+    {
+        // Other parameters: other association.
+        auto lease = pool.acquire(fixture.get_association("LOCAL", "OTHER"));
+        BOOST_REQUIRE(&lease.get_association() != first);
+    }
+
+    BOOST_REQUIRE_EQUAL(pool.get_associations_count("127.0.0.1", 11127), 2);
+    BOOST_REQUIRE_EQUAL(fixture.associations, 2);
+    BOOST_REQUIRE_EQUAL(fixture.echoes, 2);
+
+    pool.clear();
+    BOOST_REQUIRE_EQUAL(pool.get_associations_count("127.0.0.1", 11127), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Liveness)
+{
+    Fixture fixture(11128);
+    odil::AssociationPool pool;
+    pool.set_liveness_check_interval(boost::posix_time::seconds(0));
+
+    {
+        auto lease = pool.acquire(fixture.get_association("LOCAL", "REMOTE"));
+    }
+    {
+        // Checked with a C-ECHO, and reused.
+        auto lease = pool.acquire(fixture.get_association("LOCAL", "REMOTE"));
+        BOOST_REQUIRE_EQUAL(fixture.echoes, 1);
+        BOOST_REQUIRE_EQUAL(fixture.associations, 1);
+
+        // Break the connection behind the back of the association.
+        lease->get_transport().close();
+    }
+    {
+        auto lease = pool.acquire(fixture.get_association("LOCAL", "REMOTE"));
+        BOOST_REQUIRE(lease->is_associated());
+        BOOST_REQUIRE_EQUAL(fixture.associations, 2);
+        odil::EchoSCU(*lease).echo();
+    }
+    BOOST_REQUIRE_EQUAL(pool.get_associations_count("127.0.0.1", 11128), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Eviction)
+{
+    Fixture fixture(11129);
+    odil::AssociationPool pool;
+
+    {
+        auto lease = pool.acquire(fixture.get_association("LOCAL", "REMOTE"));
+        lease.discard();
+        BOOST_REQUIRE_THROW(lease.get_association(), odil::Exception);
+    }
+    BOOST_REQUIRE_EQUAL(pool.get_associations_count("127.0.0.1", 11129), 0);
+
+    {
+        auto lease = pool.acquire(fixture.get_association("LOCAL", "REMOTE"));
+    }
+    BOOST_REQUIRE_EQUAL(pool.get_idle_associations_count("127.0.0.1", 11129), 1);
+
+    pool.set_maximum_idle_time(boost::posix_time::seconds(0));
+    pool.evict_idle();
+    BOOST_REQUIRE_EQUAL(pool.get_associations_count("127.0.0.1", 11129), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Limit)
+{
+    Fixture fixture(11130);
+    odil::AssociationPool pool;
+    pool.set_maximum_associations_per_peer(1);
+    pool.set_acquire_timeout(boost::posix_time::milliseconds(100));
+
+    auto lease = pool.acquire(fixture.get_association("LOCAL", "REMOTE"));
+    BOOST_REQUIRE_THROW(
+        pool.acquire(fixture.get_association("LOCAL", "REMOTE")), odil::Exception);
+
+    // An idle association with other parameters makes room.
+    lease = odil::AssociationPool::Lease();
+    auto other = pool.acquire(fixture.get_association("LOCAL", "OTHER"));
+    BOOST_REQUIRE_EQUAL(pool.get_associations_count("127.0.0.1", 11130), 1);
+    BOOST_REQUIRE_EQUAL(fixture.associations, 2);
+}
+
+BOOST_AUTO_TEST_CASE(Threads)
+{
+    Fixture fixture(11131);
+    odil::AssociationPool pool;
+    pool.set_maximum_associations_per_peer(2);
+
+    std::vector<std::thread> clients;
+    for(int i=0; i<8; ++i)
+    {
+        clients.emplace_back(
+            [&]()
+            {
+                for(int j=0; j<10; ++j)
+                {
+                    auto lease = pool.acquire(fixture.get_association("LOCAL", "REMOTE"));
+                    odil::EchoSCU(*lease).echo();
+                }
+            });
+    }
+    for(auto & client: clients)
+    {
+        client.join();
+    }
+
+    BOOST_REQUIRE_EQUAL(fixture.echoes, 80);
+    BOOST_REQUIRE(fixture.associations <= 2);
+    BOOST_REQUIRE_EQUAL(
+        pool.get_idle_associations_count("127.0.0.1", 11131),
+        fixture.associations);
+}
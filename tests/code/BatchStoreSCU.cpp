@@ -0,0 +1,273 @@
+#define BOOST_TEST_MODULE BatchStoreSCU
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "odil/Association.h"
+#include "odil/AssociationAcceptor.h"
+#include "odil/AssociationParameters.h"
+#include "odil/BatchStoreSCU.h"
+#include "odil/DataSet.h"
+#include "odil/registry.h"
+#include "odil/Writer.h"
+
+#include "../LoopbackFixtureBase.h"
+
+struct Fixture: public LoopbackFixtureBase
+{
+    odil::Association association;
+
+    Fixture(unsigned short port)
+    : LoopbackFixtureBase(port), association(this->get_association())
+    {
+        this->start();
+    }
+};
+
+std::vector<std::shared_ptr<odil::DataSet>> get_data_sets(std::size_t count)
+{
+    std::vector<std::shared_ptr<odil::DataSet>> data_sets;
+    for(std::size_t i=0; i<count; ++i)
+    {
+        auto data_set = std::make_shared<odil::DataSet>();
+        data_set->add(
+            odil::registry::SOPClassUID,
+            {
+                (i%2 == 0)
+                ? odil::registry::RawDataStorage
+                : odil::registry::MRImageStorage });
+        data_set->add(
+            odil::registry::SOPInstanceUID, {"1.2.3."+std::to_string(i)});
+        data_set->add(odil::registry::PatientName, {"Doe^John"});
+        data_sets.push_back(data_set);
+    }
+    return data_sets;
+}
+
+BOOST_AUTO_TEST_CASE(Constructor)
+{
+    odil::Association association;
+    odil::BatchStoreSCU const scu(association);
+    BOOST_REQUIRE_EQUAL(scu.get_associations_count(), 4);
+    BOOST_REQUIRE_EQUAL(scu.get_loaders_count(), 2);
+    BOOST_REQUIRE_EQUAL(scu.get_prefetch_size(), 16);
+}
+
+BOOST_AUTO_TEST_CASE(DataSets)
+{
+    Fixture fixture(11121);
+
+    odil::BatchStoreSCU scu(fixture.association);
+    scu.set_associations_count(3);
+
+    auto const data_sets = get_data_sets(20);
+    std::set<std::size_t> indices;
+    auto const statistics = scu.store(
+        data_sets,
+        [&](odil::BatchStoreSCU::Result const & result)
+        {
+            BOOST_REQUIRE(result.is_success());
+            BOOST_REQUIRE_EQUAL(
+                result.sop_instance_uid, "1.2.3."+std::to_string(result.index));
+            indices.insert(result.index);
+        });
+
+    BOOST_REQUIRE_EQUAL(indices.size(), 20);
+    BOOST_REQUIRE_EQUAL(fixture.stored.size(), 20);
+    BOOST_REQUIRE_EQUAL(statistics.instances, 20);
+    BOOST_REQUIRE_EQUAL(statistics.failures, 0);
+    BOOST_REQUIRE_EQUAL(statistics.bytes, 0);
+    BOOST_REQUIRE(statistics.get_instances_per_second() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(Files)
+{
+    Fixture fixture(11122);
+
+    odil::BatchStoreSCU scu(fixture.association);
+    scu.set_associations_count(2);
+    scu.set_prefetch_size(1);
+
+    std::vector<std::string> paths;
+    for(auto const & data_set: get_data_sets(6))
+    {
+        auto const path =
+            "BatchStoreSCU_"+std::to_string(paths.size())+".dcm";
+        std::ofstream stream(path, std::ios::binary);
+        odil::Writer::write_file(data_set, stream);
+        paths.push_back(path);
+    }
+    paths.push_back("BatchStoreSCU_missing.dcm");
+
+    std::size_t failures = 0;
+    auto const statistics = scu.store(
+        paths,
+        [&](odil::BatchStoreSCU::Result const & result)
+        {
+            if(!result.is_success())
+            {
+                BOOST_REQUIRE_EQUAL(result.index, 6);
+                ++failures;
+            }
+        });
+
+    for(auto const & path: paths)
+    {
+        std::remove(path.c_str());
+    }
+
+    BOOST_REQUIRE_EQUAL(failures, 1);
+    BOOST_REQUIRE_EQUAL(fixture.stored.size(), 6);
+    BOOST_REQUIRE_EQUAL(statistics.instances, 7);
+    BOOST_REQUIRE_EQUAL(statistics.failures, 1);
+    BOOST_REQUIRE(statistics.bytes > 0);
+}
+
+BOOST_AUTO_TEST_CASE(Pipelined)
+{
+    // The peer accepts several outstanding requests, but rejects MR.
+    LoopbackFixtureBase fixture(11143);
+    fixture.server.set_association_acceptor(
+        [](odil::AssociationParameters const & request)
+        {
+            auto parameters = odil::default_association_acceptor(request);
+            auto presentation_contexts = parameters.get_presentation_contexts();
+            for(auto & presentation_context: presentation_contexts)
+            {
+                if(
+                    presentation_context.abstract_syntax
+                    == odil::registry::MRImageStorage)
+                {
+                    presentation_context.result =
+                        odil::AssociationParameters::PresentationContext
+                            ::Result::AbstractSyntaxNotSupported;
+                }
+            }
+            parameters
+                .set_presentation_contexts(presentation_contexts)
+                .set_maximum_number_operations_invoked(4);
+            return parameters;
+        });
+    fixture.start();
+
+    auto association = fixture.get_association();
+    association.update_parameters().set_maximum_number_operations_invoked(4);
+    odil::BatchStoreSCU scu(association);
+    scu.set_associations_count(1);
+
+    std::vector<std::string> paths;
+    std::size_t raw_data_bytes = 0;
+    for(auto const & data_set: get_data_sets(12))
+    {
+        auto const path =
+            "BatchStoreSCU_pipelined_"+std::to_string(paths.size())+".dcm";
+        {
+            std::ofstream stream(path, std::ios::binary);
+            odil::Writer::write_file(data_set, stream);
+        }
+        if(paths.size()%2 == 0)
+        {
+            raw_data_bytes += boost::filesystem::file_size(path);
+        }
+        paths.push_back(path);
+    }
+
+    std::set<std::size_t> failed;
+    auto const statistics = scu.store(
+        paths,
+        [&](odil::BatchStoreSCU::Result const & result)
+        {
+            if(!result.is_success())
+            {
+                failed.insert(result.index);
+            }
+        });
+
+    for(auto const & path: paths)
+    {
+        std::remove(path.c_str());
+    }
+
+    BOOST_REQUIRE_EQUAL(fixture.stored.size(), 6);
+    BOOST_REQUIRE(failed == std::set<std::size_t>({1, 3, 5, 7, 9, 11}));
+    BOOST_REQUIRE_EQUAL(statistics.failures, 6);
+    // Only the stored files account for the transferred bytes.
+    BOOST_REQUIRE_EQUAL(statistics.bytes, raw_data_bytes);
+}
+
+BOOST_AUTO_TEST_CASE(MixedTransferSyntaxes)
+{
+    Fixture fixture(11138);
+
+    odil::BatchStoreSCU scu(fixture.association);
+    scu.set_associations_count(1);
+
+    // Same SOP class, native and two encapsulated transfer syntaxes: each
+    // encapsulated syntax has its own presentation context.
+    std::vector<std::string> const transfer_syntaxes{
+        odil::registry::ExplicitVRLittleEndian,
+        odil::registry::JPEGBaselineProcess1,
+        odil::registry::ImplicitVRLittleEndian,
+        odil::registry::JPEGLSLossless };
+    std::vector<std::string> paths;
+    for(auto const & data_set: get_data_sets(8))
+    {
+        data_set->as_string(odil::registry::SOPClassUID) = {
+            odil::registry::RawDataStorage };
+        auto const path =
+            "BatchStoreSCU_mixed_"+std::to_string(paths.size())+".dcm";
+        std::ofstream stream(path, std::ios::binary);
+        odil::Writer::write_file(
+            data_set, stream, {},
+            transfer_syntaxes[paths.size()%transfer_syntaxes.size()]);
+        paths.push_back(path);
+    }
+
+    std::size_t failures = 0;
+    auto const statistics = scu.store(
+        paths,
+        [&](odil::BatchStoreSCU::Result const & result)
+        {
+            if(!result.is_success())
+            {
+                ++failures;
+            }
+        });
+
+    for(auto const & path: paths)
+    {
+        std::remove(path.c_str());
+    }
+
+    BOOST_REQUIRE_EQUAL(failures, 0);
+    BOOST_REQUIRE_EQUAL(fixture.stored.size(), 8);
+    BOOST_REQUIRE_EQUAL(statistics.failures, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ManySOPClasses)
+{
+    Fixture fixture(11139);
+
+    odil::BatchStoreSCU scu(fixture.association);
+    scu.set_associations_count(2);
+
+    // More SOP classes than presentation contexts in an association.
+    auto const data_sets = get_data_sets(200);
+    for(std::size_t i=0; i<data_sets.size(); ++i)
+    {
+        data_sets[i]->as_string(odil::registry::SOPClassUID) = {
+            "1.2.3.4.5."+std::to_string(i) };
+    }
+
+    auto const statistics = scu.store(data_sets);
+
+    BOOST_REQUIRE_EQUAL(fixture.stored.size(), 200);
+    BOOST_REQUIRE_EQUAL(statistics.failures, 0);
+}
@@ -1,6 +1,11 @@
 #define BOOST_TEST_MODULE DataSet
 #include <boost/test/unit_test.hpp>
 
+#include <vector>
+
+#include <boost/container/pmr/global_resource.hpp>
+#include <boost/container/pmr/monotonic_buffer_resource.hpp>
+
 #include "odil/DataSet.h"
 #include "odil/Exception.h"
 #include "odil/Tag.h"
@@ -450,3 +455,84 @@ BOOST_AUTO_TEST_CASE(Clear)
     BOOST_CHECK(data_set.empty("PatientID"));
     BOOST_CHECK_THROW(data_set.clear("PatietName"), odil::Exception);
 }
+
+BOOST_AUTO_TEST_CASE(Iteration)
+{
+    odil::DataSet data_set;
+    data_set.add("PatientName", {"Doe^John"});
+    data_set.add("Modality", {"MR"});
+    data_set.add("PatientID", {"DJ1234"});
+    data_set.add("SOPClassUID", {odil::registry::MRImageStorage});
+    data_set.add("PatientName", {"Doe^Jane"});
+
+    std::vector<odil::Tag> tags;
+    for(auto const & item: data_set)
+    {
+        tags.push_back(item.first);
+    }
+    BOOST_CHECK(
+        tags == std::vector<odil::Tag>({
+            odil::registry::SOPClassUID, odil::registry::Modality,
+            odil::registry::PatientName, odil::registry::PatientID}));
+    BOOST_CHECK(
+        data_set.as_string("PatientName")
+            == odil::Value::Strings({"Doe^Jane"}));
+
+    data_set.remove("Modality");
+    BOOST_CHECK_EQUAL(data_set.size(), 3);
+    BOOST_CHECK(!data_set.has("Modality"));
+    BOOST_CHECK(data_set.has("SOPClassUID"));
+    BOOST_CHECK(data_set.has("PatientID"));
+}
+
+BOOST_AUTO_TEST_CASE(OutOfOrder)
+{
+    odil::DataSet data_set;
+    for(unsigned int i=10; i>0; --i)
+    {
+        data_set.add(odil::Tag(0x0011, i), {int(i)}, odil::VR::SL);
+    }
+    // Replace an element which is already sorted, and one which is not.
+    data_set.add(odil::Tag(0x0011, 10), {100}, odil::VR::SL);
+    BOOST_CHECK_EQUAL(data_set.as_int(odil::Tag(0x0011, 10), 0), 100);
+    data_set.add(odil::Tag(0x0011, 1), {101}, odil::VR::SL);
+    data_set.add(odil::Tag(0x0011, 5), {105}, odil::VR::SL);
+    data_set.add(odil::Tag(0x0011, 5), {205}, odil::VR::SL);
+
+    // Copies and moved-from data sets keep the elements added out of order.
+    odil::DataSet const copy(data_set);
+    odil::DataSet moved(std::move(data_set));
+    data_set.add(odil::Tag(0x0011, 2), {2}, odil::VR::SL);
+    data_set.add(odil::Tag(0x0011, 1), {1}, odil::VR::SL);
+    BOOST_CHECK_EQUAL(data_set.size(), 2);
+    BOOST_CHECK_EQUAL(data_set.begin()->first, odil::Tag(0x0011, 1));
+
+    for(auto const * other: std::vector<odil::DataSet const *>{&copy, &moved})
+    {
+        BOOST_CHECK_EQUAL(other->size(), 10);
+        unsigned int element = 1;
+        for(auto const & item: *other)
+        {
+            BOOST_CHECK_EQUAL(item.first, odil::Tag(0x0011, element));
+            ++element;
+        }
+        BOOST_CHECK_EQUAL(other->as_int(odil::Tag(0x0011, 1), 0), 101);
+        BOOST_CHECK_EQUAL(other->as_int(odil::Tag(0x0011, 5), 0), 205);
+        BOOST_CHECK_EQUAL(other->as_int(odil::Tag(0x0011, 10), 0), 100);
+    }
+    BOOST_CHECK(copy == moved);
+}
+
+BOOST_AUTO_TEST_CASE(MemoryResource)
+{
+    boost::container::pmr::monotonic_buffer_resource resource;
+    odil::DataSet data_set("", &resource);
+    BOOST_CHECK(data_set.get_memory_resource() == &resource);
+    data_set.add("PatientID", {"DJ1234"});
+
+    odil::DataSet const copy(data_set);
+    BOOST_CHECK(copy == data_set);
+    BOOST_CHECK(
+        copy.get_memory_resource()
+            == boost::container::pmr::get_default_resource());
+}
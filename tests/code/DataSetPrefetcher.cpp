@@ -0,0 +1,139 @@
+#define BOOST_TEST_MODULE DataSetPrefetcher
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/DataSetPrefetcher.h"
+#include "odil/SCP.h"
+#include "odil/message/Request.h"
+#include "odil/message/Response.h"
+
+class Generator: public odil::SCP::DataSetGenerator
+{
+public:
+    Generator(int count, int failure=-1)
+    : _count(count), _failure(failure), _index(0)
+    {
+        // Nothing else.
+    }
+
+    virtual ~Generator()
+    {
+        // Nothing to do.
+    }
+
+    virtual void initialize(std::shared_ptr<odil::message::Request const>)
+    {
+        this->_index = 0;
+    }
+
+    virtual bool done() const
+    {
+        return (this->_index == this->_count);
+    }
+
+    virtual std::shared_ptr<odil::DataSet> get() const
+    {
+        if(this->_index == this->_failure)
+        {
+            throw odil::SCP::Exception(
+                "Cannot read", odil::message::Response::ProcessingFailure);
+        }
+        auto data_set = std::make_shared<odil::DataSet>();
+        data_set->add("SOPInstanceUID", {"1.2.3."+std::to_string(this->_index)});
+        return data_set;
+    }
+
+    virtual void next()
+    {
+        ++this->_index;
+    }
+
+private:
+    int _count;
+    int _failure;
+    int _index;
+};
+
+std::vector<std::string> consume(odil::DataSetPrefetcher & prefetcher)
+{
+    std::vector<std::string> uids;
+    while(auto const data_set = prefetcher.get())
+    {
+        uids.push_back(data_set->as_string("SOPInstanceUID", 0));
+    }
+    return uids;
+}
+
+BOOST_AUTO_TEST_CASE(Synchronous)
+{
+    odil::DataSetPrefetcher prefetcher(std::make_shared<Generator>(3), 0);
+    auto const uids = consume(prefetcher);
+    BOOST_REQUIRE(
+        uids == std::vector<std::string>({"1.2.3.0", "1.2.3.1", "1.2.3.2"}));
+    BOOST_REQUIRE(!prefetcher.get());
+}
+
+BOOST_AUTO_TEST_CASE(Background)
+{
+    odil::DataSetPrefetcher prefetcher(std::make_shared<Generator>(10), 2);
+    auto const uids = consume(prefetcher);
+    BOOST_REQUIRE_EQUAL(uids.size(), 10);
+    for(std::size_t i=0; i<uids.size(); ++i)
+    {
+        BOOST_REQUIRE_EQUAL(uids[i], "1.2.3."+std::to_string(i));
+    }
+    BOOST_REQUIRE(!prefetcher.get());
+}
+
+BOOST_AUTO_TEST_CASE(Failure)
+{
+    for(std::size_t size: {0, 4})
+    {
+        odil::DataSetPrefetcher prefetcher(std::make_shared<Generator>(5, 2), size);
+        BOOST_REQUIRE(prefetcher.get());
+        BOOST_REQUIRE(prefetcher.get());
+        BOOST_REQUIRE_THROW(prefetcher.get(), odil::SCP::Exception);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Consumers)
+{
+    odil::DataSetPrefetcher prefetcher(std::make_shared<Generator>(100), 4);
+
+    std::mutex mutex;
+    std::multiset<std::string> uids;
+    std::vector<std::thread> consumers;
+    for(int i=0; i<4; ++i)
+    {
+        consumers.emplace_back(
+            [&]()
+            {
+                for(auto const & uid: consume(prefetcher))
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    uids.insert(uid);
+                }
+            });
+    }
+    for(auto & consumer: consumers)
+    {
+        consumer.join();
+    }
+
+    BOOST_REQUIRE_EQUAL(uids.size(), 100);
+    BOOST_REQUIRE_EQUAL(std::set<std::string>(uids.begin(), uids.end()).size(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(Stop)
+{
+    // Destroying the prefetcher while it waits for room must not block.
+    odil::DataSetPrefetcher prefetcher(std::make_shared<Generator>(100), 1);
+    BOOST_REQUIRE(prefetcher.get());
+}
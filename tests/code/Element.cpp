@@ -1,8 +1,13 @@
 #define BOOST_TEST_MODULE Element
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "odil/DataSet.h"
 #include "odil/Element.h"
@@ -291,3 +296,89 @@ BOOST_AUTO_TEST_CASE(Binary)
         &odil::Element::is_binary,
         &odil::Element::as_binary, &odil::Element::as_binary);
 }
+
+BOOST_AUTO_TEST_CASE(EncodedValue)
+{
+    int calls = 0;
+    auto encoded_value = std::make_shared<odil::Element::EncodedValue>();
+    auto const data = std::make_shared<std::string>("1\\2");
+    encoded_value->buffer = std::shared_ptr<char const>(data, data->data());
+    encoded_value->offset = 0;
+    encoded_value->length = data->size();
+    encoded_value->undefined_length = false;
+    encoded_value->byte_ordering = odil::ByteOrdering::LittleEndian;
+    encoded_value->decoder =
+        std::make_shared<odil::Element::EncodedValue::Decoder>(
+            [&calls](odil::VR, odil::Element::EncodedValue const &)
+            {
+                ++calls;
+                return odil::Value(odil::Value::Integers({1, 2}));
+            });
+
+    odil::Element element(encoded_value, odil::VR::IS);
+    BOOST_REQUIRE(element.is_int());
+    BOOST_REQUIRE_EQUAL(calls, 0);
+
+    auto const & const_element = element;
+    BOOST_REQUIRE(const_element.as_int() == odil::Value::Integers({1, 2}));
+    BOOST_REQUIRE_EQUAL(calls, 1);
+    BOOST_REQUIRE(const_element.get_encoded_value() == encoded_value);
+
+    element.as_int().push_back(3);
+    BOOST_REQUIRE_EQUAL(calls, 1);
+    BOOST_REQUIRE(!element.get_encoded_value());
+    BOOST_REQUIRE(element.as_int() == odil::Value::Integers({1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(EncodedValueConcurrent)
+{
+    std::atomic<int> calls(0);
+    auto const data = std::make_shared<std::string>("1\\2");
+    auto encoded_value = std::make_shared<odil::Element::EncodedValue>();
+    encoded_value->buffer = std::shared_ptr<char const>(data, data->data());
+    encoded_value->offset = 0;
+    encoded_value->length = data->size();
+    encoded_value->undefined_length = false;
+    encoded_value->byte_ordering = odil::ByteOrdering::LittleEndian;
+    encoded_value->decoder =
+        std::make_shared<odil::Element::EncodedValue::Decoder>(
+            [&calls](odil::VR, odil::Element::EncodedValue const &)
+            {
+                ++calls;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                return odil::Value(odil::Value::Integers({1, 2}));
+            });
+
+    odil::Element const element(encoded_value, odil::VR::IS);
+    // Copies share the decoded value
+    odil::Element const copy(element);
+
+    std::atomic<int> matches(0);
+    std::vector<std::thread> threads;
+    for(int i=0; i<8; ++i)
+    {
+        threads.emplace_back(
+            [&, i]()
+            {
+                auto const & value = ((i%2==0)?element:copy).as_int();
+                if(value == odil::Value::Integers({1, 2}))
+                {
+                    ++matches;
+                }
+            });
+    }
+    for(auto & thread: threads)
+    {
+        thread.join();
+    }
+
+    BOOST_REQUIRE_EQUAL(calls, 1);
+    BOOST_REQUIRE_EQUAL(matches, 8);
+
+    // Modifying a copy does not modify the other ones
+    odil::Element other(copy);
+    other.as_int().push_back(3);
+    BOOST_REQUIRE(other.as_int() == odil::Value::Integers({1, 2, 3}));
+    BOOST_REQUIRE(element.as_int() == odil::Value::Integers({1, 2}));
+    BOOST_REQUIRE(copy.get_encoded_value() == encoded_value);
+}
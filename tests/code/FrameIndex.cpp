@@ -0,0 +1,148 @@
+#define BOOST_TEST_MODULE FrameIndex
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/Exception.h"
+#include "odil/FrameIndex.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/Value.h"
+#include "odil/Writer.h"
+
+typedef odil::Value::Binary::value_type Fragment;
+
+Fragment fragment(std::size_t size, uint8_t value)
+{
+    return Fragment(size, value);
+}
+
+Fragment offset_table(std::vector<uint32_t> const & offsets)
+{
+    Fragment table;
+    for(auto const offset: offsets)
+    {
+        for(int i=0; i<4; ++i)
+        {
+            table.push_back((offset >> (8*i)) & 0xff);
+        }
+    }
+    return table;
+}
+
+/// @brief Write a file and return the index of its pixel data.
+odil::FrameIndex get_index(
+    odil::Value::Binary const & pixel_data, int frames_count,
+    std::stringstream & stream,
+    Fragment const & extended_offset_table = {})
+{
+    auto data_set = std::make_shared<odil::DataSet>();
+    data_set->add(odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set->add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set->add(odil::registry::NumberOfFrames, odil::Value::Integers{frames_count});
+    if(!extended_offset_table.empty())
+    {
+        data_set->add(
+            odil::registry::ExtendedOffsetTable,
+            {extended_offset_table}, odil::VR::OV);
+    }
+    data_set->add(odil::registry::PixelData, pixel_data, odil::VR::OB);
+
+    odil::Writer::write_file(
+        data_set, stream, {}, odil::registry::JPEGBaseline8Bit);
+
+    auto const header_and_data_set = odil::Reader::read_file(
+        stream, false,
+        [](odil::Tag const & tag) { return tag == odil::registry::PixelData; });
+    return odil::FrameIndex(
+        stream, odil::registry::JPEGBaseline8Bit,
+        *header_and_data_set.second);
+}
+
+BOOST_AUTO_TEST_CASE(BasicOffsetTable)
+{
+    // Frame 1 is split in two fragments
+    std::stringstream stream;
+    auto const index = get_index(
+        {
+            offset_table({0, 18, 44}),
+            fragment(10, 1), fragment(4, 2), fragment(6, 3), fragment(8, 4)
+        },
+        3, stream);
+
+    BOOST_REQUIRE_EQUAL(index.size(), 3);
+    BOOST_REQUIRE(index.read_frame(stream, 2) == fragment(8, 4));
+    BOOST_REQUIRE(index.read_frame(stream, 0) == fragment(10, 1));
+
+    auto expected = fragment(4, 2);
+    auto const second = fragment(6, 3);
+    expected.insert(expected.end(), second.begin(), second.end());
+    BOOST_REQUIRE(index.read_frame(stream, 1) == expected);
+
+    auto const fragments = index.get_fragments(stream, 1);
+    BOOST_REQUIRE_EQUAL(fragments.size(), 2);
+    BOOST_REQUIRE_EQUAL(fragments[0].length, 4);
+    BOOST_REQUIRE_EQUAL(fragments[1].length, 6);
+    BOOST_REQUIRE(
+        fragments[1].position-fragments[0].position == std::streamoff(12));
+    BOOST_REQUIRE(fragments[0].position-index.get_position(1) == 8);
+}
+
+BOOST_AUTO_TEST_CASE(ExtendedOffsetTable)
+{
+    // Offsets in host byte order, as in a data set read from a file
+    uint64_t const offsets[] = { 0, 18 };
+    Fragment table(16);
+    std::memcpy(&table[0], offsets, 16);
+
+    std::stringstream stream;
+    auto const index = get_index(
+        {{}, fragment(10, 1), fragment(6, 2)}, 2, stream, table);
+
+    BOOST_REQUIRE_EQUAL(index.size(), 2);
+    BOOST_REQUIRE(index.read_frame(stream, 1) == fragment(6, 2));
+    BOOST_REQUIRE(index.read_frame(stream, 0) == fragment(10, 1));
+}
+
+BOOST_AUTO_TEST_CASE(NoOffsetTableMultiFrame)
+{
+    std::stringstream stream;
+    auto const index = get_index(
+        {{}, fragment(10, 1), fragment(6, 2), fragment(4, 3)}, 3, stream);
+
+    BOOST_REQUIRE_EQUAL(index.size(), 3);
+    BOOST_REQUIRE(index.read_frame(stream, 1) == fragment(6, 2));
+    BOOST_REQUIRE(index.read_frame(stream, 2) == fragment(4, 3));
+}
+
+BOOST_AUTO_TEST_CASE(NoOffsetTableSingleFrame)
+{
+    std::stringstream stream;
+    auto const index = get_index(
+        {{}, fragment(10, 1), fragment(6, 1)}, 1, stream);
+
+    BOOST_REQUIRE_EQUAL(index.size(), 1);
+    BOOST_REQUIRE(index.read_frame(stream, 0) == fragment(16, 1));
+}
+
+BOOST_AUTO_TEST_CASE(NoOffsetTableAmbiguous)
+{
+    std::stringstream stream;
+    BOOST_REQUIRE_THROW(
+        get_index(
+            {{}, fragment(10, 1), fragment(6, 2), fragment(4, 3)}, 2, stream),
+        odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(NoSuchFrame)
+{
+    std::stringstream stream;
+    auto const index = get_index({{}, fragment(10, 1)}, 1, stream);
+    BOOST_REQUIRE_THROW(index.read_frame(stream, 1), odil::Exception);
+}
@@ -1,9 +1,13 @@
 #define BOOST_TEST_MODULE MoveSCP
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -14,11 +18,18 @@
 #include "odil/AssociationParameters.h"
 #include "odil/DataSet.h"
 #include "odil/MoveSCP.h"
+#include "odil/MoveSCU.h"
 #include "odil/Exception.h"
 #include "odil/SCP.h"
+#include "odil/SCPDispatcher.h"
+#include "odil/SCPServer.h"
+#include "odil/StoreSCP.h"
 #include "odil/uid.h"
 #include "odil/Reader.h"
 #include "odil/registry.h"
+#include "odil/message/CMoveRequest.h"
+#include "odil/message/CMoveResponse.h"
+#include "odil/message/CStoreRequest.h"
 #include "odil/message/Response.h"
 
 struct Status
@@ -231,3 +242,391 @@ BOOST_AUTO_TEST_CASE(Release)
     BOOST_REQUIRE_EQUAL(status.responses[1]->as_string("PatientName", 0), "Doe^John");
     BOOST_REQUIRE_EQUAL(status.responses[1]->as_string("PatientID", 0), "5678");
 }
+
+class FanOutGenerator: public odil::MoveSCP::DataSetGenerator
+{
+public:
+    FanOutGenerator(unsigned int count, unsigned short port)
+    : _count(count), _port(port), _index(0)
+    {
+        // Nothing else.
+    }
+
+    virtual ~FanOutGenerator()
+    {
+        // Nothing to do.
+    }
+
+    virtual void initialize(std::shared_ptr<odil::message::Request const>)
+    {
+        this->_index = 0;
+    }
+
+    virtual bool done() const
+    {
+        return (this->_index == this->_count);
+    }
+
+    virtual std::shared_ptr<odil::DataSet> get() const
+    {
+        auto data_set = std::make_shared<odil::DataSet>();
+        data_set->add("SOPClassUID", {odil::registry::RawDataStorage});
+        data_set->add("SOPInstanceUID", {"1.2.3."+std::to_string(this->_index)});
+        data_set->add("PatientName", {"Doe^John"});
+        return data_set;
+    }
+
+    virtual void next()
+    {
+        ++this->_index;
+    }
+
+    virtual unsigned int count() const
+    {
+        return this->_count;
+    }
+
+    virtual odil::Association get_association(
+        std::shared_ptr<odil::message::CMoveRequest const> request) const
+    {
+        odil::Association move_association;
+        move_association.set_peer_host("127.0.0.1");
+        move_association.set_peer_port(this->_port);
+        move_association.update_parameters()
+            .set_calling_ae_title("REMOTE")
+            .set_called_ae_title(request->get_move_destination())
+            .set_presentation_contexts({{
+                1, odil::registry::RawDataStorage,
+                { odil::registry::ImplicitVRLittleEndian },
+                odil::AssociationParameters::PresentationContext::Role::SCU
+            }});
+        return move_association;
+    }
+
+private:
+    unsigned int _count;
+    unsigned short _port;
+    unsigned int _index;
+};
+
+BOOST_AUTO_TEST_CASE(SubAssociations)
+{
+    std::string server_status;
+    std::thread server([&]() {
+        try
+        {
+            odil::Association association;
+            association.set_tcp_timeout(boost::posix_time::seconds(5));
+            association.receive_association(boost::asio::ip::tcp::v4(), 11125);
+
+            odil::MoveSCP scp(
+                association, std::make_shared<FanOutGenerator>(12, 11126));
+            scp.set_prefetch_size(4);
+            scp.set_sub_associations_count(3);
+            scp.set_pending_responses_interval(boost::posix_time::hours(1));
+            scp(association.receive_message());
+
+            association.receive_message();
+        }
+        catch(odil::AssociationReleased const &)
+        {
+            server_status = "release";
+        }
+        catch(odil::Exception const & e)
+        {
+            server_status = e.what();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    odil::Association association;
+    association.set_peer_host("127.0.0.1");
+    association.set_peer_port(11125);
+    association.update_parameters()
+        .set_calling_ae_title("LOCAL")
+        .set_called_ae_title("REMOTE")
+        .set_presentation_contexts({{
+            1, odil::registry::PatientRootQueryRetrieveInformationModelMove,
+            { odil::registry::ImplicitVRLittleEndian },
+            odil::AssociationParameters::PresentationContext::Role::SCU
+        }});
+    association.associate();
+
+    odil::MoveSCU scu(association);
+    scu.set_move_destination("LOCAL");
+    scu.set_incoming_port(11126);
+    scu.set_affected_sop_class(
+        odil::registry::PatientRootQueryRetrieveInformationModelMove);
+
+    auto query = std::make_shared<odil::DataSet>();
+    query->add("QueryRetrieveLevel", {"PATIENT"});
+    query->add("PatientName", {"Doe^John"});
+
+    std::set<std::string> stored;
+    std::vector<std::shared_ptr<odil::message::CMoveResponse>> responses;
+    scu.move(
+        query,
+        [&](std::shared_ptr<odil::DataSet> data_set)
+        {
+            stored.insert(data_set->as_string("SOPInstanceUID", 0));
+        },
+        [&](std::shared_ptr<odil::message::CMoveResponse> response)
+        {
+            responses.push_back(response);
+        });
+    association.release();
+
+    server.join();
+
+    BOOST_REQUIRE_EQUAL(server_status, "release");
+    BOOST_REQUIRE_EQUAL(stored.size(), 12);
+
+    // Throttled: a single Pending response, then the final one.
+    BOOST_REQUIRE_EQUAL(responses.size(), 2);
+    BOOST_REQUIRE(responses[0]->is_pending());
+    auto const & final_response = responses[1];
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_status(), odil::message::Response::Success);
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_number_of_remaining_sub_operations(), 0);
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_number_of_completed_sub_operations(), 12);
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_number_of_failed_sub_operations(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SubAssociationAborted)
+{
+    // Store destination: the first association is aborted by its peer when
+    // it receives its first data set.
+    std::mutex mutex;
+    std::set<std::string> stored;
+    std::atomic<int> associations(0);
+    odil::SCPServer destination(
+        boost::asio::ip::tcp::v4(), 11136,
+        [&](odil::Association & association)
+        {
+            bool const abort = (associations++ == 0);
+            auto dispatcher =
+                std::make_shared<odil::SCPDispatcher>(association);
+            dispatcher->set_scp(
+                odil::message::Message::Command::C_STORE_RQ,
+                std::make_shared<odil::StoreSCP>(
+                    association,
+                    [&, abort](
+                        std::shared_ptr<odil::message::CStoreRequest> request)
+                    {
+                        if(abort)
+                        {
+                            association.abort(2, 0);
+                        }
+                        else
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            stored.insert(
+                                request->get_affected_sop_instance_uid());
+                        }
+                        return odil::message::Response::Success;
+                    }));
+            return dispatcher;
+        });
+    destination.set_tcp_timeout(boost::posix_time::seconds(5));
+    std::thread destination_thread([&]() { destination.run(); });
+    destination.wait_listening();
+
+    std::string server_status;
+    std::thread server([&]() {
+        try
+        {
+            odil::Association association;
+            association.set_tcp_timeout(boost::posix_time::seconds(5));
+            association.receive_association(boost::asio::ip::tcp::v4(), 11137);
+
+            odil::MoveSCP scp(
+                association, std::make_shared<FanOutGenerator>(12, 11136));
+            scp.set_prefetch_size(4);
+            scp.set_sub_associations_count(2);
+            scp.set_pending_responses_interval(boost::posix_time::hours(1));
+            scp(association.receive_message());
+
+            association.receive_message();
+        }
+        catch(odil::AssociationReleased const &)
+        {
+            server_status = "release";
+        }
+        catch(odil::Exception const & e)
+        {
+            server_status = e.what();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    odil::Association association;
+    association.set_peer_host("127.0.0.1");
+    association.set_peer_port(11137);
+    association.update_parameters()
+        .set_calling_ae_title("LOCAL")
+        .set_called_ae_title("REMOTE")
+        .set_presentation_contexts({{
+            1, odil::registry::PatientRootQueryRetrieveInformationModelMove,
+            { odil::registry::ImplicitVRLittleEndian },
+            odil::AssociationParameters::PresentationContext::Role::SCU
+        }});
+    association.associate();
+
+    odil::MoveSCU scu(association);
+    scu.set_move_destination("LOCAL");
+    scu.set_affected_sop_class(
+        odil::registry::PatientRootQueryRetrieveInformationModelMove);
+
+    auto query = std::make_shared<odil::DataSet>();
+    query->add("QueryRetrieveLevel", {"PATIENT"});
+    query->add("PatientName", {"Doe^John"});
+
+    std::vector<std::shared_ptr<odil::message::CMoveResponse>> responses;
+    scu.move(
+        query,
+        [&](std::shared_ptr<odil::message::CMoveResponse> response)
+        {
+            responses.push_back(response);
+        });
+    association.release();
+
+    server.join();
+    destination.stop();
+    destination_thread.join();
+
+    BOOST_REQUIRE_EQUAL(server_status, "release");
+    BOOST_REQUIRE_EQUAL(associations, 2);
+
+    // The data set of the aborted association is stored by the other one.
+    BOOST_REQUIRE_EQUAL(stored.size(), 12);
+    BOOST_REQUIRE(!responses.empty());
+    auto const & final_response = responses.back();
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_status(), odil::message::Response::Success);
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_number_of_remaining_sub_operations(), 0);
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_number_of_completed_sub_operations(), 12);
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_number_of_failed_sub_operations(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(OnlyAssociationAborted)
+{
+    // Store destination: the only association is aborted by its peer when
+    // it receives its third data set.
+    std::mutex mutex;
+    std::set<std::string> stored;
+    odil::SCPServer destination(
+        boost::asio::ip::tcp::v4(), 11140,
+        [&](odil::Association & association)
+        {
+            auto dispatcher =
+                std::make_shared<odil::SCPDispatcher>(association);
+            dispatcher->set_scp(
+                odil::message::Message::Command::C_STORE_RQ,
+                std::make_shared<odil::StoreSCP>(
+                    association,
+                    [&](std::shared_ptr<odil::message::CStoreRequest> request)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if(stored.size() == 2)
+                        {
+                            association.abort(2, 0);
+                        }
+                        else
+                        {
+                            stored.insert(
+                                request->get_affected_sop_instance_uid());
+                        }
+                        return odil::message::Response::Success;
+                    }));
+            return dispatcher;
+        });
+    destination.set_tcp_timeout(boost::posix_time::seconds(5));
+    std::thread destination_thread([&]() { destination.run(); });
+    destination.wait_listening();
+
+    std::string server_status;
+    std::thread server([&]() {
+        try
+        {
+            odil::Association association;
+            association.set_tcp_timeout(boost::posix_time::seconds(5));
+            association.receive_association(boost::asio::ip::tcp::v4(), 11141);
+
+            odil::MoveSCP scp(
+                association, std::make_shared<FanOutGenerator>(12, 11140));
+            scp.set_prefetch_size(4);
+            scp.set_sub_associations_count(1);
+            scp.set_pending_responses_interval(boost::posix_time::hours(1));
+            scp(association.receive_message());
+
+            association.receive_message();
+        }
+        catch(odil::AssociationReleased const &)
+        {
+            server_status = "release";
+        }
+        catch(odil::Exception const & e)
+        {
+            server_status = e.what();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    odil::Association association;
+    association.set_peer_host("127.0.0.1");
+    association.set_peer_port(11141);
+    association.update_parameters()
+        .set_calling_ae_title("LOCAL")
+        .set_called_ae_title("REMOTE")
+        .set_presentation_contexts({{
+            1, odil::registry::PatientRootQueryRetrieveInformationModelMove,
+            { odil::registry::ImplicitVRLittleEndian },
+            odil::AssociationParameters::PresentationContext::Role::SCU
+        }});
+    association.associate();
+
+    odil::MoveSCU scu(association);
+    scu.set_move_destination("LOCAL");
+    scu.set_affected_sop_class(
+        odil::registry::PatientRootQueryRetrieveInformationModelMove);
+
+    auto query = std::make_shared<odil::DataSet>();
+    query->add("QueryRetrieveLevel", {"PATIENT"});
+    query->add("PatientName", {"Doe^John"});
+
+    std::vector<std::shared_ptr<odil::message::CMoveResponse>> responses;
+    scu.move(
+        query,
+        [&](std::shared_ptr<odil::message::CMoveResponse> response)
+        {
+            responses.push_back(response);
+        });
+    association.release();
+
+    server.join();
+    destination.stop();
+    destination_thread.join();
+
+    BOOST_REQUIRE_EQUAL(server_status, "release");
+    BOOST_REQUIRE_EQUAL(stored.size(), 2);
+
+    // The data sets which were not sent are counted as failed.
+    BOOST_REQUIRE(!responses.empty());
+    auto const & final_response = responses.back();
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_status(),
+        odil::message::CMoveResponse::
+            SubOperationsCompleteOneOrMoreFailuresOrWarnings);
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_number_of_remaining_sub_operations(), 0);
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_number_of_completed_sub_operations(), 2);
+    BOOST_REQUIRE_EQUAL(
+        final_response->get_number_of_failed_sub_operations(), 10);
+}
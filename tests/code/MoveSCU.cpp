@@ -1,9 +1,23 @@
 #define BOOST_TEST_MODULE MoveSCU
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "odil/Association.h"
 #include "odil/DataSet.h"
+#include "odil/Exception.h"
 #include "odil/MoveSCU.h"
 #include "odil/registry.h"
+#include "odil/StoreSCU.h"
+#include "odil/message/CMoveRequest.h"
+#include "odil/message/CMoveResponse.h"
+#include "odil/message/Response.h"
 
 #include "../PeerFixtureBase.h"
 
@@ -115,3 +129,132 @@ BOOST_FIXTURE_TEST_CASE(MoveOnlyStoreCallback, Fixture)
     BOOST_CHECK(Fixture::store_callback_called);
     BOOST_CHECK(!Fixture::move_callback_called);
 }
+
+BOOST_AUTO_TEST_CASE(ConcurrentStoreAssociations)
+{
+    std::string server_status;
+    std::thread server([&]() {
+        try
+        {
+            odil::Association association;
+            association.set_tcp_timeout(boost::posix_time::seconds(5));
+            association.receive_association(boost::asio::ip::tcp::v4(), 11123);
+            auto const request = std::make_shared<odil::message::CMoveRequest>(
+                association.receive_message());
+
+            // Two store associations, used alternately.
+            std::vector<std::shared_ptr<odil::Association>> stores;
+            for(int i=0; i<2; ++i)
+            {
+                auto store = std::make_shared<odil::Association>();
+                store->set_peer_host("127.0.0.1");
+                store->set_peer_port(11124);
+                store->update_parameters()
+                    .set_calling_ae_title("REMOTE")
+                    .set_called_ae_title(request->get_move_destination())
+                    .set_presentation_contexts({{
+                        1, odil::registry::RawDataStorage,
+                        { odil::registry::ImplicitVRLittleEndian },
+                        odil::AssociationParameters::PresentationContext::Role::SCU
+                    }});
+                store->associate();
+                stores.push_back(store);
+            }
+
+            for(int i=0; i<6; ++i)
+            {
+                auto data_set = std::make_shared<odil::DataSet>();
+                data_set->add(
+                    odil::registry::SOPClassUID,
+                    {odil::registry::RawDataStorage});
+                data_set->add(
+                    odil::registry::SOPInstanceUID,
+                    {"1.2.3."+std::to_string(i)});
+
+                odil::StoreSCU scu(*stores[i%2]);
+                scu.set_affected_sop_class(odil::registry::RawDataStorage);
+                scu.store(data_set);
+
+                association.send_message(
+                    std::make_shared<odil::message::CMoveResponse>(
+                        request->get_message_id(),
+                        odil::message::Response::Pending),
+                    request->get_affected_sop_class_uid());
+            }
+
+            for(auto & store: stores)
+            {
+                store->release();
+            }
+            association.send_message(
+                std::make_shared<odil::message::CMoveResponse>(
+                    request->get_message_id(),
+                    odil::message::Response::Success),
+                request->get_affected_sop_class_uid());
+
+            association.receive_message();
+        }
+        catch(odil::AssociationReleased const &)
+        {
+            server_status = "release";
+        }
+        catch(odil::Exception const & e)
+        {
+            server_status = e.what();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    odil::Association association;
+    association.set_peer_host("127.0.0.1");
+    association.set_peer_port(11123);
+    association.update_parameters()
+        .set_calling_ae_title("LOCAL")
+        .set_called_ae_title("REMOTE")
+        .set_presentation_contexts({
+            {
+                1, odil::registry::PatientRootQueryRetrieveInformationModelMove,
+                { odil::registry::ImplicitVRLittleEndian },
+                odil::AssociationParameters::PresentationContext::Role::SCU
+            },
+            {
+                3, odil::registry::RawDataStorage,
+                { odil::registry::ImplicitVRLittleEndian },
+                odil::AssociationParameters::PresentationContext::Role::SCP
+            }
+        });
+    association.associate();
+
+    odil::MoveSCU scu(association);
+    scu.set_move_destination("LOCAL");
+    scu.set_incoming_port(11124);
+    scu.set_affected_sop_class(
+        odil::registry::PatientRootQueryRetrieveInformationModelMove);
+
+    auto query = std::make_shared<odil::DataSet>();
+    query->add("QueryRetrieveLevel", {"PATIENT"});
+    query->add("PatientName", {"Doe^John"});
+
+    std::vector<std::string> stored;
+    int responses = 0;
+    auto const begin = std::chrono::steady_clock::now();
+    scu.move(
+        query,
+        [&](std::shared_ptr<odil::DataSet> data_set)
+        {
+            stored.push_back(data_set->as_string("SOPInstanceUID", 0));
+        },
+        [&](std::shared_ptr<odil::message::CMoveResponse>)
+        {
+            ++responses;
+        });
+    auto const duration = std::chrono::steady_clock::now()-begin;
+    association.release();
+
+    server.join();
+
+    BOOST_REQUIRE_EQUAL(server_status, "release");
+    BOOST_REQUIRE_EQUAL(stored.size(), 6);
+    BOOST_REQUIRE_EQUAL(responses, 7);
+    BOOST_REQUIRE(duration < std::chrono::seconds(1));
+}
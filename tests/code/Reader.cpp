@@ -1,9 +1,15 @@
 #define BOOST_TEST_MODULE Reader
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <fstream>
 #include <sstream>
 #include <tuple>
 
+#include <boost/container/pmr/global_resource.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
+#include <boost/filesystem.hpp>
+
 #include <dcmtk/config/osconfig.h>
 #include <dcmtk/dcmdata/dctk.h>
 #include <dcmtk/dcmdata/dcostrmb.h>
@@ -12,7 +18,9 @@
 #include "odil/Element.h"
 #include "odil/registry.h"
 #include "odil/Reader.h"
+#include "odil/StringStream.h"
 #include "odil/VR.h"
+#include "odil/Writer.h"
 #include "odil/dcmtk/conversion.h"
 
 #include "odil/json_converter.h"
@@ -400,3 +408,466 @@ BOOST_AUTO_TEST_CASE(File)
 
     do_file_test(odil_data_set);
 }
+
+BOOST_AUTO_TEST_CASE(FilePath)
+{
+    auto data_set = std::make_shared<odil::DataSet>();
+    data_set->add(
+        odil::registry::SOPClassUID,
+        {odil::registry::RawDataStorage}, odil::VR::UI);
+    data_set->add(odil::registry::SOPInstanceUID, {"1.2.3.4"}, odil::VR::UI);
+    data_set->add(
+        odil::registry::PixelData,
+        {{0x01, 0x02, 0x03, 0x04, 0x05, 0x06}}, odil::VR::OW);
+
+    auto const path = boost::filesystem::temp_directory_path()
+        / boost::filesystem::unique_path();
+    {
+        std::ofstream stream(path.string(), std::ios::out | std::ios::binary);
+        odil::Writer::write_file(data_set, stream);
+    }
+
+    std::shared_ptr<odil::DataSet> meta_information, other_data_set;
+    std::tie(meta_information, other_data_set) =
+        odil::Reader::read_file(path.string());
+
+    // By default, the values are owned by the data set: it may be written
+    // back to the same file.
+    BOOST_REQUIRE(
+        !(*other_data_set)[odil::registry::PixelData].get_encoded_value());
+    {
+        std::ofstream stream(path.string(), std::ios::out | std::ios::binary);
+        odil::Writer::write_file(other_data_set, stream);
+    }
+    BOOST_REQUIRE(*other_data_set == *data_set);
+
+    std::tie(meta_information, other_data_set) = odil::Reader::read_file(
+        path.string(), false, [](odil::Tag const &) { return false; }, false,
+        {}, nullptr, true);
+
+    // The binary values are views into the mapping, not the other ones.
+    BOOST_REQUIRE(
+        (*other_data_set)[odil::registry::PixelData].get_encoded_value());
+    BOOST_REQUIRE(
+        !(*other_data_set)[odil::registry::SOPInstanceUID]
+            .get_encoded_value());
+
+    BOOST_REQUIRE(*other_data_set == *data_set);
+    BOOST_REQUIRE(
+        meta_information->as_string(odil::registry::TransferSyntaxUID)
+        == odil::Value::Strings({odil::registry::ExplicitVRLittleEndian}));
+
+    // The views are written without being decoded.
+    std::ostringstream copy;
+    odil::Writer(copy, odil::registry::ExplicitVRLittleEndian)
+        .write_data_set(other_data_set);
+    BOOST_REQUIRE(
+        (*other_data_set)[odil::registry::PixelData].get_encoded_value());
+
+    // Release the mapping before removing the file.
+    other_data_set.reset();
+    boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(FilePathMissing)
+{
+    auto const path = boost::filesystem::temp_directory_path()
+        / boost::filesystem::unique_path();
+    BOOST_REQUIRE_THROW(
+        odil::Reader::read_file(path.string()), odil::Exception);
+    BOOST_REQUIRE_THROW(
+        odil::Reader::read_file(
+            path.string(), false, [](odil::Tag const &) { return false; },
+            false, {}, nullptr, true),
+        odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(LazyDecoding)
+{
+    auto item = std::make_shared<odil::DataSet>();
+    item->add(odil::registry::CodeValue, {"value"});
+    item->add(odil::registry::CodeMeaning, {"meaning"});
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::Rows, {512});
+    data_set.add(odil::registry::PixelSpacing, {1.5, 2.5});
+    data_set.add(odil::registry::ConceptNameCodeSequence, {item});
+    data_set.add(
+        odil::registry::PixelData, {{0x01, 0x02, 0x03, 0x04}}, odil::VR::OW);
+
+    typedef std::pair<std::string, odil::Writer::ItemEncoding> Encoding;
+    for(auto const & encoding: {
+        Encoding(
+            odil::registry::ImplicitVRLittleEndian,
+            odil::Writer::ItemEncoding::ExplicitLength),
+        Encoding(
+            odil::registry::ExplicitVRLittleEndian,
+            odil::Writer::ItemEncoding::ExplicitLength),
+        Encoding(
+            odil::registry::ExplicitVRLittleEndian,
+            odil::Writer::ItemEncoding::UndefinedLength),
+        Encoding(
+            odil::registry::ExplicitVRBigEndian,
+            odil::Writer::ItemEncoding::UndefinedLength)})
+    {
+        auto const & transfer_syntax = encoding.first;
+        auto const & item_encoding = encoding.second;
+
+        std::ostringstream output;
+        odil::Writer(output, transfer_syntax, item_encoding).write_data_set(
+            std::make_shared<odil::DataSet>(data_set));
+        auto const data = output.str();
+
+        std::istringstream input(data);
+        odil::Reader const reader(input, transfer_syntax, false, true);
+        auto const other = reader.read_data_set();
+
+        // Encoded values are copied as is
+        std::ostringstream copy;
+        odil::Writer(copy, transfer_syntax, item_encoding).write_data_set(
+            other);
+        BOOST_REQUIRE(copy.str() == data);
+        BOOST_REQUIRE(
+            (*other)[odil::registry::PixelData].get_encoded_value());
+
+        BOOST_REQUIRE(*other == data_set);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(LazyDecodingBuffer)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(
+        odil::registry::PixelData, {{0x01, 0x02, 0x03, 0x04}}, odil::VR::OW);
+
+    std::ostringstream output;
+    odil::Writer(output, odil::registry::ExplicitVRLittleEndian)
+        .write_data_set(std::make_shared<odil::DataSet>(data_set));
+    auto const data = std::make_shared<std::string>(output.str());
+
+    odil::IStringStream input(data->data(), data->size());
+    odil::Reader reader(
+        input, odil::registry::ExplicitVRLittleEndian, false, true);
+    reader.buffer = std::shared_ptr<char const>(data, data->data());
+    auto const other = reader.read_data_set();
+
+    // The encoded values reference the buffer
+    auto const & encoded_value =
+        (*other)[odil::registry::PixelData].get_encoded_value();
+    BOOST_REQUIRE(encoded_value);
+    BOOST_REQUIRE(encoded_value->buffer == reader.buffer);
+    BOOST_REQUIRE_EQUAL(encoded_value->offset, data->size()-4);
+    BOOST_REQUIRE_EQUAL(encoded_value->length, 4);
+
+    BOOST_REQUIRE(*other == data_set);
+}
+
+/// @brief Stream buffer which does not support seeking.
+class SequentialBuffer: public std::streambuf
+{
+public:
+    SequentialBuffer(std::string const & data)
+    : _data(data)
+    {
+        char * begin = &this->_data[0];
+        this->setg(begin, begin, begin+this->_data.size());
+    }
+private:
+    std::string _data;
+};
+
+BOOST_AUTO_TEST_CASE(NestedSequences)
+{
+    auto item = std::make_shared<odil::DataSet>();
+    item->add(odil::registry::CodeValue, {"value"});
+    for(int i=0; i<4; ++i)
+    {
+        auto parent = std::make_shared<odil::DataSet>();
+        parent->add(odil::registry::ReferencedSOPInstanceUID, {"1.2.3"});
+        parent->add(odil::registry::ContentSequence, {item, item});
+        item = parent;
+    }
+    odil::DataSet data_set;
+    data_set.add(odil::registry::ContentSequence, {item});
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+
+    std::ostringstream output;
+    odil::Writer(output, odil::registry::ExplicitVRLittleEndian).write_data_set(
+        std::make_shared<odil::DataSet>(data_set));
+    auto const data = output.str();
+
+    std::istringstream seekable_stream(data);
+    odil::Reader const seekable_reader(
+        seekable_stream, odil::registry::ExplicitVRLittleEndian);
+    BOOST_REQUIRE(*seekable_reader.read_data_set() == data_set);
+
+    SequentialBuffer buffer(data);
+    std::istream sequential_stream(&buffer);
+    odil::Reader const sequential_reader(
+        sequential_stream, odil::registry::ExplicitVRLittleEndian);
+    BOOST_REQUIRE(*sequential_reader.read_data_set() == data_set);
+}
+
+BOOST_AUTO_TEST_CASE(ItemLengthMismatch)
+{
+    auto item = std::make_shared<odil::DataSet>();
+    item->add(odil::registry::CodeValue, {"value"});
+    odil::DataSet data_set;
+    data_set.add(odil::registry::ConceptNameCodeSequence, {item});
+
+    std::ostringstream output;
+    odil::Writer(output, odil::registry::ExplicitVRLittleEndian).write_data_set(
+        std::make_shared<odil::DataSet>(data_set));
+    auto data = output.str();
+    // Item length, after tag, VR, reserved bytes, sequence length and item
+    // tag: shorten it so that it ends within the Code Value element.
+    data[16] -= 2;
+
+    std::istringstream stream(data);
+    odil::Reader const reader(stream, odil::registry::ExplicitVRLittleEndian);
+    BOOST_REQUIRE_THROW(reader.read_data_set(), odil::Exception);
+}
+
+/// @brief Memory resource counting its allocations.
+class CountingResource: public odil::DataSet::MemoryResource
+{
+public:
+    std::size_t allocations=0;
+protected:
+    void * do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++this->allocations;
+        return boost::container::pmr::new_delete_resource()->allocate(
+            bytes, alignment);
+    }
+
+    void do_deallocate(
+        void * p, std::size_t bytes, std::size_t alignment) override
+    {
+        boost::container::pmr::new_delete_resource()->deallocate(
+            p, bytes, alignment);
+    }
+
+    bool do_is_equal(
+        boost::container::pmr::memory_resource const & other
+    ) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(MemoryResource)
+{
+    auto item = std::make_shared<odil::DataSet>();
+    item->add(odil::registry::CodeValue, {"value"});
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::ConceptNameCodeSequence, {item});
+
+    std::ostringstream output;
+    odil::Writer(output, odil::registry::ExplicitVRLittleEndian).write_data_set(
+        std::make_shared<odil::DataSet>(data_set));
+
+    CountingResource resource;
+    std::istringstream input(output.str());
+    odil::Reader const reader(
+        input, odil::registry::ExplicitVRLittleEndian, false, false,
+        &resource);
+    auto const other = reader.read_data_set();
+
+    BOOST_REQUIRE(*other == data_set);
+    BOOST_REQUIRE(other->get_memory_resource() == &resource);
+    auto const & other_item =
+        other->as_data_set(odil::registry::ConceptNameCodeSequence, 0);
+    BOOST_REQUIRE(other_item->get_memory_resource() == &resource);
+    // Data set, item, and their elements
+    BOOST_REQUIRE(resource.allocations >= 4);
+}
+
+BOOST_AUTO_TEST_CASE(FileMemoryResource)
+{
+    auto data_set = std::make_shared<odil::DataSet>();
+    data_set->add(
+        odil::registry::SOPClassUID,
+        {odil::registry::RawDataStorage}, odil::VR::UI);
+    data_set->add(odil::registry::SOPInstanceUID, {"1.2.3.4"}, odil::VR::UI);
+
+    auto const path = boost::filesystem::temp_directory_path()
+        / boost::filesystem::unique_path();
+    {
+        std::ofstream stream(path.string(), std::ios::out | std::ios::binary);
+        odil::Writer::write_file(data_set, stream);
+    }
+
+    CountingResource resource;
+    {
+        std::ifstream stream(path.string(), std::ios::in | std::ios::binary);
+        auto const header_and_data_set = odil::Reader::read_file(
+            stream, false, [](odil::Tag const &) { return false; }, false, {},
+            &resource);
+        BOOST_REQUIRE(
+            header_and_data_set.first->get_memory_resource() == &resource);
+        BOOST_REQUIRE(
+            header_and_data_set.second->get_memory_resource() == &resource);
+        BOOST_REQUIRE(*header_and_data_set.second == *data_set);
+    }
+    {
+        auto const header_and_data_set = odil::Reader::read_file(
+            path.string(), false, [](odil::Tag const &) { return false; },
+            false, {}, &resource);
+        BOOST_REQUIRE(
+            header_and_data_set.first->get_memory_resource() == &resource);
+        BOOST_REQUIRE(
+            header_and_data_set.second->get_memory_resource() == &resource);
+        BOOST_REQUIRE(*header_and_data_set.second == *data_set);
+    }
+    boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(Filter)
+{
+    auto item = std::make_shared<odil::DataSet>();
+    item->add(odil::registry::CodeValue, {"value"});
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::ConceptNameCodeSequence, {item});
+    data_set.add(
+        odil::registry::PixelData,
+        {{}, {0x01, 0x02, 0x03, 0x04}, {0x05, 0x06}}, odil::VR::OB);
+    data_set.add(
+        odil::registry::DataSetTrailingPadding, {{0x00, 0x00}}, odil::VR::OB);
+
+    odil::DataSet expected;
+    expected.add(odil::registry::PatientName, {"Doe^John"});
+    expected.add(
+        odil::registry::DataSetTrailingPadding, {{0x00, 0x00}}, odil::VR::OB);
+
+    auto const filter = [](odil::Tag const & tag) {
+        return (
+            tag != odil::registry::ConceptNameCodeSequence
+            && tag != odil::registry::PixelData);
+    };
+
+    for(auto const & transfer_syntax: {
+        odil::registry::ImplicitVRLittleEndian,
+        odil::registry::ExplicitVRLittleEndian})
+    {
+        std::ostringstream output;
+        odil::Writer(
+                output, transfer_syntax,
+                odil::Writer::ItemEncoding::UndefinedLength)
+            .write_data_set(std::make_shared<odil::DataSet>(data_set));
+        auto const data = output.str();
+
+        std::istringstream seekable_stream(data);
+        odil::Reader const seekable_reader(seekable_stream, transfer_syntax);
+        auto const other = seekable_reader.read_data_set(
+            [](odil::Tag const &) { return false; }, filter);
+        BOOST_REQUIRE(*other == expected);
+
+        SequentialBuffer buffer(data);
+        std::istream sequential_stream(&buffer);
+        odil::Reader const sequential_reader(
+            sequential_stream, transfer_syntax);
+        auto const sequential_other = sequential_reader.read_data_set(
+            [](odil::Tag const &) { return false; }, filter);
+        BOOST_REQUIRE(*sequential_other == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FilterTruncated)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(
+        odil::registry::PixelData, {{0x01, 0x02, 0x03, 0x04}}, odil::VR::OB);
+
+    std::ostringstream output;
+    odil::Writer(output, odil::registry::ExplicitVRLittleEndian)
+        .write_data_set(std::make_shared<odil::DataSet>(data_set));
+    auto data = output.str();
+    data.resize(data.size()-2);
+
+    std::istringstream stream(data);
+    odil::Reader const reader(stream, odil::registry::ExplicitVRLittleEndian);
+    BOOST_REQUIRE_THROW(
+        reader.read_data_set(
+            [](odil::Tag const &) { return false; },
+            [](odil::Tag const & tag) {
+                return tag != odil::registry::PixelData; }),
+        odil::Exception);
+}
+
+/// @brief Stream buffer exposing a few bytes at a time.
+class ChunkedBuffer: public std::streambuf
+{
+public:
+    ChunkedBuffer(std::string const & data, std::size_t chunk_size)
+    : _data(data), _chunk_size(chunk_size), _position(0)
+    {
+        // Nothing else.
+    }
+protected:
+    int_type underflow() override
+    {
+        if(this->_position == this->_data.size())
+        {
+            return traits_type::eof();
+        }
+        char * begin = &this->_data[this->_position];
+        auto const size = std::min(
+            this->_chunk_size, this->_data.size()-this->_position);
+        this->setg(begin, begin, begin+size);
+        this->_position += size;
+        return traits_type::to_int_type(*begin);
+    }
+private:
+    std::string _data;
+    std::size_t _chunk_size;
+    std::size_t _position;
+};
+
+BOOST_AUTO_TEST_CASE(Read)
+{
+    std::string const data("0123456789");
+    ChunkedBuffer buffer(data, 3);
+    std::istream stream(&buffer);
+
+    std::string value(2, '\0');
+    odil::Reader::read(stream, &value[0], value.size());
+    BOOST_REQUIRE_EQUAL(value, "01");
+
+    // Across chunks
+    value.resize(5);
+    odil::Reader::read(stream, &value[0], value.size());
+    BOOST_REQUIRE_EQUAL(value, "23456");
+
+    odil::Reader::ignore(stream, 2);
+    value.resize(1);
+    odil::Reader::read(stream, &value[0], value.size());
+    BOOST_REQUIRE_EQUAL(value, "9");
+
+    BOOST_REQUIRE_THROW(
+        odil::Reader::read(stream, &value[0], value.size()), odil::Exception);
+    BOOST_REQUIRE(stream.eof());
+    BOOST_REQUIRE(stream.fail());
+}
+
+BOOST_AUTO_TEST_CASE(ChunkedStream)
+{
+    odil::DataSet data_set;
+    data_set.add(odil::registry::PatientName, {"Doe^John"});
+    data_set.add(odil::registry::Rows, {256});
+    data_set.add(
+        odil::registry::PixelData, {{0x01, 0x02, 0x03, 0x04}}, odil::VR::OB);
+
+    std::ostringstream output;
+    odil::Writer(output, odil::registry::ExplicitVRLittleEndian)
+        .write_data_set(std::make_shared<odil::DataSet>(data_set));
+
+    ChunkedBuffer buffer(output.str(), 3);
+    std::istream stream(&buffer);
+    odil::Reader const reader(stream, odil::registry::ExplicitVRLittleEndian);
+    BOOST_REQUIRE(*reader.read_data_set() == data_set);
+}
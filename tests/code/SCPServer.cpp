@@ -0,0 +1,205 @@
+#define BOOST_TEST_MODULE SCPServer
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "odil/Association.h"
+#include "odil/AssociationAcceptor.h"
+#include "odil/EchoSCU.h"
+#include "odil/SCPDispatcher.h"
+#include "odil/SCPServer.h"
+
+#include "../LoopbackFixtureBase.h"
+
+BOOST_AUTO_TEST_CASE(Constructor)
+{
+    odil::SCPServer server(
+        boost::asio::ip::tcp::v4(), 11117,
+        [](odil::Association & association)
+        {
+            return std::make_shared<odil::SCPDispatcher>(association);
+        });
+    BOOST_REQUIRE_EQUAL(server.get_port(), 11117);
+    BOOST_REQUIRE_EQUAL(server.get_workers_count(), 4);
+    BOOST_REQUIRE_EQUAL(server.get_queue_size(), 16);
+    BOOST_REQUIRE_EQUAL(server.get_maximum_associations(), 0);
+    BOOST_REQUIRE_EQUAL(server.get_maximum_associations_per_ae(), 0);
+    BOOST_REQUIRE(server.get_tcp_timeout().is_pos_infinity());
+    BOOST_REQUIRE(
+        server.get_negotiation_timeout() == boost::posix_time::seconds(30));
+    BOOST_REQUIRE_EQUAL(server.get_associations_count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Serve)
+{
+    LoopbackFixtureBase fixture(11117);
+    fixture.start();
+
+    std::vector<std::thread> clients;
+    for(int i=0; i<4; ++i)
+    {
+        clients.emplace_back(
+            [&fixture, i]()
+            {
+                auto association = fixture.associate("LOCAL"+std::to_string(i));
+                odil::EchoSCU scu(*association);
+                scu.echo();
+                scu.echo();
+                association->release();
+            });
+    }
+    for(auto & client: clients)
+    {
+        client.join();
+    }
+
+    fixture.stop();
+
+    BOOST_REQUIRE_EQUAL(fixture.echoes, 8);
+    BOOST_REQUIRE_EQUAL(fixture.server.get_associations_count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(WaitListening)
+{
+    // The port is chosen by the system and known once the server listens.
+    LoopbackFixtureBase fixture(0);
+    fixture.start();
+    BOOST_REQUIRE(fixture.server.get_port() != 0);
+
+    auto association = fixture.associate("LOCAL");
+    odil::EchoSCU(*association).echo();
+    association->release();
+
+    fixture.stop();
+
+    BOOST_REQUIRE_EQUAL(fixture.echoes, 1);
+}
+
+BOOST_AUTO_TEST_CASE(PortInUse)
+{
+    boost::asio::io_service service;
+    boost::asio::ip::tcp::acceptor acceptor(
+        service,
+        boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), 0));
+    auto const port = acceptor.local_endpoint().port();
+
+    odil::SCPServer server(
+        boost::asio::ip::tcp::v4(), port,
+        [](odil::Association & association)
+        {
+            return std::make_shared<odil::SCPDispatcher>(association);
+        });
+
+    bool run_failed = false;
+    std::thread thread(
+        [&server, &run_failed]()
+        {
+            try
+            {
+                server.run();
+            }
+            catch(boost::system::system_error const &)
+            {
+                run_failed = true;
+            }
+        });
+
+    BOOST_REQUIRE_THROW(server.wait_listening(), boost::system::system_error);
+    thread.join();
+    BOOST_REQUIRE(run_failed);
+}
+
+BOOST_AUTO_TEST_CASE(LimitPerAE)
+{
+    LoopbackFixtureBase fixture(11118);
+    fixture.server.set_maximum_associations_per_ae(1);
+    fixture.start();
+
+    auto first = fixture.associate("LOCAL");
+    auto other = fixture.associate("OTHER");
+
+    bool rejected = false;
+    try
+    {
+        fixture.associate("LOCAL");
+    }
+    catch(odil::AssociationRejected const & e)
+    {
+        rejected = true;
+        BOOST_REQUIRE_EQUAL(e.get_result(), odil::Association::RejectedTransient);
+        BOOST_REQUIRE_EQUAL(e.get_reason(), odil::Association::LocalLimitExceeded);
+    }
+    BOOST_REQUIRE(rejected);
+
+    odil::EchoSCU(*first).echo();
+    first->release();
+    other->release();
+
+    fixture.stop();
+
+    BOOST_REQUIRE_EQUAL(fixture.echoes, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Congestion)
+{
+    LoopbackFixtureBase fixture(11119);
+    fixture.server.set_workers_count(1);
+    fixture.server.set_queue_size(1);
+    fixture.start();
+
+    auto served = fixture.associate("LOCAL1");
+    auto queued = fixture.associate("LOCAL2");
+
+    bool rejected = false;
+    try
+    {
+        fixture.associate("LOCAL3");
+    }
+    catch(odil::AssociationRejected const & e)
+    {
+        rejected = true;
+        BOOST_REQUIRE_EQUAL(e.get_reason(), odil::Association::TemporaryCongestion);
+    }
+    BOOST_REQUIRE(rejected);
+
+    served->release();
+    odil::EchoSCU(*queued).echo();
+    queued->release();
+
+    fixture.stop();
+
+    BOOST_REQUIRE_EQUAL(fixture.echoes, 1);
+}
+
+BOOST_AUTO_TEST_CASE(SilentPeer)
+{
+    LoopbackFixtureBase fixture(11135);
+    fixture.server.set_negotiation_timeout(boost::posix_time::seconds(1));
+    fixture.start();
+
+    boost::asio::io_service service;
+    boost::asio::ip::tcp::socket silent(service);
+    silent.connect({
+        boost::asio::ip::address_v4::loopback(), fixture.server.get_port()});
+
+    // A peer which does not send its request does not delay the others.
+    auto association = fixture.associate("LOCAL");
+    odil::EchoSCU(*association).echo();
+    association->release();
+
+    // It is disconnected after the negotiation timeout.
+    char data;
+    boost::system::error_code error;
+    silent.read_some(boost::asio::buffer(&data, 1), error);
+    BOOST_REQUIRE(error);
+
+    fixture.stop();
+
+    BOOST_REQUIRE_EQUAL(fixture.echoes, 1);
+    BOOST_REQUIRE_EQUAL(fixture.server.get_associations_count(), 0);
+}
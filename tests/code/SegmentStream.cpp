@@ -0,0 +1,134 @@
+#define BOOST_TEST_MODULE SegmentStream
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "odil/DataSet.h"
+#include "odil/registry.h"
+#include "odil/SegmentStream.h"
+#include "odil/Value.h"
+#include "odil/Writer.h"
+
+std::string join(std::vector<odil::SegmentStream::Segment> const & segments)
+{
+    std::string result;
+    for(auto const & segment: segments)
+    {
+        result.append(segment.data, segment.size);
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(Empty)
+{
+    odil::SegmentStream stream;
+    BOOST_REQUIRE_EQUAL(stream.size(), 0);
+    BOOST_REQUIRE(stream.get_segments().empty());
+}
+
+BOOST_AUTO_TEST_CASE(Write)
+{
+    std::string const data(10000, 'x');
+
+    odil::SegmentStream stream;
+    stream << "abc";
+    stream.write(data.data(), data.size());
+    BOOST_REQUIRE_EQUAL(stream.size(), 3+data.size());
+
+    auto const & segments = stream.get_segments();
+    BOOST_REQUIRE_EQUAL(segments.size(), 1);
+    BOOST_REQUIRE_EQUAL(join(segments), "abc"+data);
+}
+
+BOOST_AUTO_TEST_CASE(Reference)
+{
+    std::string const data(10000, 'x');
+
+    odil::SegmentStream stream;
+    stream << "abc";
+    stream.write_reference(data.data(), data.size());
+    stream << "def";
+    BOOST_REQUIRE_EQUAL(stream.size(), 6+data.size());
+
+    auto const & segments = stream.get_segments();
+    BOOST_REQUIRE_EQUAL(segments.size(), 3);
+    BOOST_REQUIRE(segments[1].data == data.data());
+    BOOST_REQUIRE_EQUAL(segments[1].size, data.size());
+    BOOST_REQUIRE_EQUAL(join(segments), "abc"+data+"def");
+}
+
+BOOST_AUTO_TEST_CASE(Writer)
+{
+    auto data_set = std::make_shared<odil::DataSet>();
+    data_set->add(odil::registry::PatientName, {"Doe^John"});
+    data_set->add(
+        odil::registry::PixelData,
+        {odil::Value::Binary::value_type(65536, 0x2a)}, odil::VR::OB);
+
+    std::ostringstream expected;
+    odil::Writer(expected, odil::registry::ExplicitVRLittleEndian)
+        .write_data_set(data_set);
+
+    odil::SegmentStream stream;
+    odil::Writer(stream, odil::registry::ExplicitVRLittleEndian)
+        .write_data_set(data_set);
+
+    auto const & segments = stream.get_segments();
+    BOOST_REQUIRE_EQUAL(join(segments), expected.str());
+
+    // Pixel data is referenced, not copied
+    auto const & pixel_data = data_set->as_binary(odil::registry::PixelData)[0];
+    BOOST_REQUIRE_EQUAL(segments.size(), 2);
+    BOOST_REQUIRE(
+        segments[1].data == reinterpret_cast<char const*>(pixel_data.data()));
+}
+
+BOOST_AUTO_TEST_CASE(Consumer)
+{
+    std::string data(20000, '\0');
+    for(std::size_t i=0; i<data.size(); ++i)
+    {
+        data[i] = 'a'+i%26;
+    }
+    std::string const reference(10000, 'x');
+
+    // Consume whole blocks of 1000 bytes, keep the rest.
+    std::string consumed;
+    std::size_t calls = 0;
+    odil::SegmentStream stream(
+        5000,
+        [&](std::vector<odil::SegmentStream::Segment> const & segments)
+        {
+            ++calls;
+            auto const content = join(segments);
+            auto const size = 1000*(content.size()/1000);
+            consumed += content.substr(0, size);
+            return size;
+        });
+    stream.write(data.data(), data.size());
+    stream.write_reference(reference.data(), reference.size());
+    stream << "abc";
+
+    BOOST_REQUIRE(calls > 0);
+    BOOST_REQUIRE_EQUAL(consumed.size()+stream.size(), 30003);
+    BOOST_REQUIRE_EQUAL(
+        consumed+join(stream.get_segments()), data+reference+"abc");
+}
+
+BOOST_AUTO_TEST_CASE(ConsumerException)
+{
+    odil::SegmentStream stream(
+        100,
+        [](std::vector<odil::SegmentStream::Segment> const &) -> std::size_t
+        {
+            throw std::runtime_error("consumer");
+        });
+
+    // The error of the consumer is not swallowed by std::ostream::write.
+    std::string const data(10000, 'x');
+    BOOST_REQUIRE_THROW(
+        stream.write(data.data(), data.size()), std::runtime_error);
+}
@@ -0,0 +1,389 @@
+#define BOOST_TEST_MODULE StoreSCP
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "odil/Association.h"
+#include "odil/AssociationAcceptor.h"
+#include "odil/AssociationParameters.h"
+#include "odil/DataSet.h"
+#include "odil/Exception.h"
+#include "odil/Reader.h"
+#include "odil/registry.h"
+#include "odil/StoreSCP.h"
+#include "odil/StoreSCU.h"
+#include "odil/message/CStoreRequest.h"
+#include "odil/message/CStoreResponse.h"
+#include "odil/message/Response.h"
+
+std::shared_ptr<odil::DataSet> get_data_set()
+{
+    auto data_set = std::make_shared<odil::DataSet>();
+    data_set->add(odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+    data_set->add(odil::registry::SOPInstanceUID, {"1.2.3.4"});
+    data_set->add(odil::registry::PatientName, {"Doe^John"});
+    odil::Value::Binary::value_type pixels(100000);
+    for(std::size_t i=0; i<pixels.size(); ++i)
+    {
+        pixels[i] = i%251;
+    }
+    data_set->add(odil::registry::PixelData, {pixels}, odil::VR::OB);
+    return data_set;
+}
+
+BOOST_AUTO_TEST_CASE(Callback)
+{
+    odil::Association association;
+    odil::StoreSCP scp(association);
+
+    bool called = false;
+    auto const callback =
+        [&called](std::shared_ptr<odil::message::CStoreRequest const>)
+        {
+            called = true;
+            return odil::message::Response::Success;
+        };
+
+    scp.set_callback(callback);
+    scp.get_callback()(std::make_shared<odil::message::CStoreRequest>(
+        1, odil::registry::RawDataStorage, "1.2.3.4", 0, get_data_set()));
+    BOOST_REQUIRE_EQUAL(called, true);
+}
+
+BOOST_AUTO_TEST_CASE(DataSetSink)
+{
+    auto const data_set = get_data_set();
+
+    std::ostringstream stream;
+    std::string transfer_syntax;
+    std::string sop_instance_uid;
+    std::string server_status;
+
+    std::thread server([&]() {
+        odil::Association association;
+        association.set_tcp_timeout(boost::posix_time::seconds(1));
+        try
+        {
+            association.receive_association(boost::asio::ip::tcp::v4(), 11115);
+
+            odil::StoreSCP scp(
+                association,
+                [&](std::shared_ptr<odil::message::CStoreRequest> request)
+                {
+                    sop_instance_uid = request->get_data_set()->as_string(
+                        odil::registry::SOPInstanceUID, 0);
+                    return odil::message::Response::Success;
+                });
+            scp.set_data_set_sink(
+                [&](
+                    std::shared_ptr<odil::DataSet const>,
+                    std::string const & ts) -> std::ostream *
+                {
+                    transfer_syntax = ts;
+                    return &stream;
+                });
+
+            scp.receive_and_process();
+            association.receive_message();
+        }
+        catch(odil::AssociationReleased const &)
+        {
+            server_status = "release";
+        }
+        catch(odil::Exception const & e)
+        {
+            server_status = e.what();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    odil::Association association;
+    association.set_peer_host("127.0.0.1");
+    association.set_peer_port(11115);
+    association.update_parameters()
+        .set_calling_ae_title("LOCAL")
+        .set_called_ae_title("REMOTE")
+        .set_presentation_contexts({
+            {
+                1, odil::registry::RawDataStorage,
+                { odil::registry::ExplicitVRLittleEndian },
+                odil::AssociationParameters::PresentationContext::Role::SCU
+            }
+        })
+        .set_maximum_length(4096);
+    association.associate();
+
+    odil::StoreSCU scu(association);
+    scu.set_affected_sop_class(data_set);
+    scu.store(data_set);
+    association.release();
+
+    server.join();
+
+    BOOST_REQUIRE_EQUAL(server_status, "release");
+    BOOST_REQUIRE_EQUAL(sop_instance_uid, "1.2.3.4");
+    BOOST_REQUIRE_EQUAL(
+        transfer_syntax, odil::registry::ExplicitVRLittleEndian);
+
+    std::istringstream input(stream.str());
+    auto const received = odil::Reader(input, transfer_syntax).read_data_set();
+    BOOST_REQUIRE(*received == *data_set);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyDataSet)
+{
+    // A decoded empty data set is not mistaken for a data set written to a
+    // sink: no UIDs are added to it, and the request is rejected.
+    bool called = false;
+    std::string server_status;
+
+    std::thread server([&]() {
+        odil::Association association;
+        association.set_tcp_timeout(boost::posix_time::seconds(1));
+        try
+        {
+            association.receive_association(boost::asio::ip::tcp::v4(), 11134);
+
+            odil::StoreSCP scp(
+                association,
+                [&](std::shared_ptr<odil::message::CStoreRequest>)
+                {
+                    called = true;
+                    return odil::message::Response::Success;
+                });
+            scp.set_data_set_sink(
+                [](std::shared_ptr<odil::DataSet const>, std::string const &)
+                -> std::ostream *
+                {
+                    return nullptr;
+                });
+
+            scp.receive_and_process();
+        }
+        catch(odil::Exception const & e)
+        {
+            server_status = e.what();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    odil::Association association;
+    association.set_peer_host("127.0.0.1");
+    association.set_peer_port(11134);
+    association.update_parameters()
+        .set_calling_ae_title("LOCAL")
+        .set_called_ae_title("REMOTE")
+        .set_presentation_contexts({
+            {
+                1, odil::registry::RawDataStorage,
+                { odil::registry::ExplicitVRLittleEndian },
+                odil::AssociationParameters::PresentationContext::Role::SCU
+            }
+        });
+    association.associate();
+
+    auto const request = std::make_shared<odil::message::CStoreRequest>(
+        association.next_message_id(), odil::registry::RawDataStorage,
+        "1.2.3.4", odil::message::Message::Priority::MEDIUM, get_data_set());
+    request->set_data_set(std::make_shared<odil::DataSet>());
+    association.send_message(request, odil::registry::RawDataStorage);
+
+    server.join();
+    association.abort(0, 0);
+
+    BOOST_REQUIRE_EQUAL(server_status, "Data set is required");
+    BOOST_REQUIRE(!called);
+}
+
+struct PipelineStatus
+{
+    std::size_t maximum_outstanding_requests;
+    std::string server_status;
+    std::size_t stored;
+    std::vector<odil::Value::Integer> responses;
+    int maximum_running;
+};
+
+/// @brief Store 12 data sets through an acceptor answering the given window.
+PipelineStatus store_pipelined(
+    unsigned short port, uint16_t invoked, uint16_t performed)
+{
+    boost::asio::io_service service;
+    boost::asio::ip::tcp::acceptor acceptor(
+        service, {boost::asio::ip::tcp::v4(), port});
+
+    std::mutex mutex;
+    std::vector<std::string> stored;
+    std::atomic<int> running(0);
+    int maximum_running = 0;
+    std::string server_status;
+
+    odil::Association server(service);
+    odil::StoreSCP scp(
+        server,
+        [&](std::shared_ptr<odil::message::CStoreRequest> request)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                maximum_running = std::max(maximum_running, ++running);
+            }
+            // Odd requests are slower: their responses are sent later.
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(
+                    (request->get_message_id()%2 == 1) ? 50 : 5));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --running;
+                stored.push_back(request->get_affected_sop_instance_uid());
+            }
+            return odil::message::Response::Success;
+        });
+
+    server.get_transport().async_receive(
+        acceptor,
+        [&](boost::system::error_code const & error)
+        {
+            if(error)
+            {
+                server_status = error.message();
+                return;
+            }
+            server.async_receive_association(
+                [&](odil::AssociationParameters const & request)
+                {
+                    auto parameters = odil::default_association_acceptor(
+                        request);
+                    parameters
+                        .set_maximum_number_operations_invoked(invoked)
+                        .set_maximum_number_operations_performed(performed);
+                    return parameters;
+                },
+                [&](std::exception_ptr error)
+                {
+                    if(error)
+                    {
+                        server_status = "association";
+                        return;
+                    }
+                    scp.async_serve([&](std::exception_ptr error) {
+                        try
+                        {
+                            std::rethrow_exception(error);
+                        }
+                        catch(odil::AssociationReleased const &)
+                        {
+                            server_status = "release";
+                        }
+                        catch(std::exception const & e)
+                        {
+                            server_status = e.what();
+                        }
+                    });
+                });
+        });
+
+    std::vector<std::thread> threads;
+    for(int i=0; i<4; ++i)
+    {
+        threads.emplace_back([&]() { service.run(); });
+    }
+
+    odil::Association association;
+    association.set_peer_host("127.0.0.1");
+    association.set_peer_port(port);
+    association.update_parameters()
+        .set_calling_ae_title("LOCAL")
+        .set_called_ae_title("REMOTE")
+        .set_presentation_contexts({
+            {
+                1, odil::registry::RawDataStorage,
+                { odil::registry::ExplicitVRLittleEndian },
+                odil::AssociationParameters::PresentationContext::Role::SCU
+            }
+        })
+        .set_maximum_number_operations_invoked(8);
+    association.associate();
+
+    std::vector<std::shared_ptr<odil::DataSet>> data_sets;
+    for(int i=0; i<12; ++i)
+    {
+        auto data_set = std::make_shared<odil::DataSet>();
+        data_set->add(
+            odil::registry::SOPClassUID, {odil::registry::RawDataStorage});
+        data_set->add(
+            odil::registry::SOPInstanceUID, {"1.2.3."+std::to_string(i)});
+        data_sets.push_back(data_set);
+    }
+
+    odil::StoreSCU scu(association);
+    PipelineStatus status;
+    status.maximum_outstanding_requests =
+        scu.get_maximum_outstanding_requests();
+
+    // Checked on the main thread: the callback is run by StoreSCU::store.
+    std::vector<odil::Value::Integer> statuses;
+    scu.store(
+        data_sets,
+        [&](std::shared_ptr<odil::message::CStoreResponse const> response)
+        {
+            statuses.push_back(response->get_status());
+            status.responses.push_back(
+                response->get_message_id_being_responded_to());
+        });
+    association.release();
+
+    for(auto & thread: threads)
+    {
+        thread.join();
+    }
+
+    for(auto const & value: statuses)
+    {
+        BOOST_REQUIRE_EQUAL(value, odil::message::Response::Success);
+    }
+
+    status.server_status = server_status;
+    status.stored = stored.size();
+    status.maximum_running = maximum_running;
+    return status;
+}
+
+BOOST_AUTO_TEST_CASE(Pipelined)
+{
+    // The requestor may invoke 4 operations, the acceptor may only invoke 1.
+    auto const status = store_pipelined(11120, 4, 1);
+
+    BOOST_REQUIRE_EQUAL(status.maximum_outstanding_requests, 4);
+    BOOST_REQUIRE_EQUAL(status.server_status, "release");
+    BOOST_REQUIRE_EQUAL(status.stored, 12);
+    BOOST_REQUIRE_EQUAL(status.responses.size(), 12);
+    BOOST_REQUIRE(status.maximum_running > 1 && status.maximum_running <= 4);
+    BOOST_REQUIRE(
+        !std::is_sorted(status.responses.begin(), status.responses.end()));
+}
+
+BOOST_AUTO_TEST_CASE(NotPipelined)
+{
+    // The acceptor may invoke 4 operations, but the requestor only 1.
+    auto const status = store_pipelined(11132, 1, 4);
+
+    BOOST_REQUIRE_EQUAL(status.maximum_outstanding_requests, 1);
+    BOOST_REQUIRE_EQUAL(status.server_status, "release");
+    BOOST_REQUIRE_EQUAL(status.stored, 12);
+    BOOST_REQUIRE_EQUAL(status.maximum_running, 1);
+    BOOST_REQUIRE(
+        std::is_sorted(status.responses.begin(), status.responses.end()));
+}
@@ -29,3 +29,16 @@ BOOST_AUTO_TEST_CASE(as_vr_wrong)
     std::string const string("XX");
     BOOST_CHECK_THROW(odil::as_vr(string), odil::Exception);
 }
+
+BOOST_AUTO_TEST_CASE(as_vr_characters)
+{
+    BOOST_CHECK(odil::as_vr('A', 'T') == odil::VR::AT);
+    BOOST_CHECK(odil::as_vr('U', 'T') == odil::VR::UT);
+}
+
+BOOST_AUTO_TEST_CASE(as_vr_characters_wrong)
+{
+    BOOST_CHECK_THROW(odil::as_vr('X', 'X'), odil::Exception);
+    BOOST_CHECK_THROW(odil::as_vr('a', 't'), odil::Exception);
+    BOOST_CHECK_THROW(odil::as_vr('\0', '\0'), odil::Exception);
+}
@@ -201,3 +201,68 @@ BOOST_AUTO_TEST_CASE(Binary)
         odil::Value::Type::Binary,
         &odil::Value::as_binary, &odil::Value::as_binary);
 }
+
+BOOST_AUTO_TEST_CASE(CopyAndAssignment)
+{
+    auto data_set = std::make_shared<odil::DataSet>();
+    data_set->add("PatientID", {"DJ1234"});
+
+    std::vector<odil::Value> const values{
+        odil::Value({1234, 5678}), odil::Value({12.34, 56.78}),
+        odil::Value({"foo", "bar"}), odil::Value({data_set}),
+        odil::Value({{0x1, 0x2}, {0x3}})};
+
+    for(auto const & source: values)
+    {
+        odil::Value const copy(source);
+        BOOST_CHECK(copy == source);
+
+        odil::Value temporary(source);
+        odil::Value const moved(std::move(temporary));
+        BOOST_CHECK(moved == source);
+
+        for(auto const & destination: values)
+        {
+            odil::Value assigned(destination);
+            assigned = source;
+            BOOST_CHECK(assigned == source);
+
+            odil::Value move_assigned(destination);
+            odil::Value other(source);
+            move_assigned = std::move(other);
+            BOOST_CHECK(move_assigned == source);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SharedDataSets)
+{
+    auto data_set = std::make_shared<odil::DataSet>();
+    odil::Value const value({data_set});
+    odil::Value const copy(value);
+    BOOST_CHECK(&value.as_data_sets() == &copy.as_data_sets());
+}
+
+BOOST_AUTO_TEST_CASE(SharedBinary)
+{
+    odil::Value const value({{0x1, 0x2}, {0x3}});
+    odil::Value copy(value);
+    BOOST_CHECK(
+        &value.as_binary() == &static_cast<odil::Value const &>(copy).as_binary());
+
+    // Copy on write
+    copy.as_binary()[0][0] = 0x4;
+    BOOST_CHECK(&value.as_binary() != &copy.as_binary());
+    BOOST_CHECK(value.as_binary() == odil::Value::Binary({{0x1, 0x2}, {0x3}}));
+    BOOST_CHECK(copy.as_binary() == odil::Value::Binary({{0x4, 0x2}, {0x3}}));
+
+    odil::Value other(value);
+    other.clear();
+    BOOST_CHECK(other.empty());
+    BOOST_CHECK_EQUAL(value.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(Footprint)
+{
+    BOOST_CHECK(sizeof(odil::Value) <= 2*sizeof(odil::Value::Integers));
+}
@@ -1,14 +1,19 @@
 #define BOOST_TEST_MODULE Writer
 #include <boost/test/unit_test.hpp>
 
+#include <memory>
 #include <sstream>
+#include <vector>
 
 #include <dcmtk/config/osconfig.h>
 #include <dcmtk/dcmdata/dctk.h>
 #include <dcmtk/dcmdata/dcistrmb.h>
 
+#include "odil/DataSet.h"
 #include "odil/endian.h"
+#include "odil/Exception.h"
 #include "odil/Element.h"
+#include "odil/Reader.h"
 #include "odil/registry.h"
 #include "odil/Writer.h"
 #include "odil/VR.h"
@@ -368,3 +373,134 @@ BOOST_AUTO_TEST_CASE(File)
 
     do_file_test(odil_data_set);
 }
+
+BOOST_AUTO_TEST_CASE(NestedSequences)
+{
+    auto item = std::make_shared<odil::DataSet>();
+    item->add(odil::registry::CodeValue, {"value"});
+    item->add(odil::registry::ContourData, {1.5, -2.25, 3.});
+    for(int i=0; i<5; ++i)
+    {
+        auto parent = std::make_shared<odil::DataSet>();
+        parent->add(odil::registry::ReferencedSOPInstanceUID, {"1.2.3"});
+        parent->add(odil::registry::ContentSequence, {item, item});
+        item = parent;
+    }
+    auto data_set = std::make_shared<odil::DataSet>();
+    data_set->add(odil::registry::ContentSequence, {item});
+    data_set->add(odil::registry::PatientName, {"Doe^John"});
+
+    for(auto const use_group_length: {false, true})
+    {
+        std::ostringstream stream;
+        odil::Writer(
+                stream, odil::registry::ExplicitVRLittleEndian,
+                odil::Writer::ItemEncoding::ExplicitLength, use_group_length)
+            .write_data_set(data_set);
+        auto const data = stream.str();
+        BOOST_REQUIRE_EQUAL(
+            data.size(),
+            odil::Writer::size(
+                *data_set, true, odil::Writer::ItemEncoding::ExplicitLength,
+                use_group_length));
+
+        std::istringstream input(data);
+        odil::Reader const reader(
+            input, odil::registry::ExplicitVRLittleEndian);
+        BOOST_REQUIRE(*reader.read_data_set() == *data_set);
+    }
+}
+
+/// @brief Producer of the given frames.
+odil::Writer::FrameProducer frame_producer(
+    std::vector<odil::Value::Binary::value_type> const & frames)
+{
+    auto index = std::make_shared<std::size_t>(0);
+    return [frames, index](odil::Value::Binary::value_type & frame) {
+        if(*index == frames.size())
+        {
+            return false;
+        }
+        frame = frames[*index];
+        ++*index;
+        return true;
+    };
+}
+
+BOOST_AUTO_TEST_CASE(StreamedPixelDataBasicOffsetTable)
+{
+    std::vector<odil::Value::Binary::value_type> const frames{
+        {0x01, 0x02, 0x03, 0x04}, {0x05, 0x06, 0x07}, {0x08, 0x09}};
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::JPEGBaseline8Bit);
+    writer.write_encapsulated_pixel_data(frame_producer(frames), 3);
+
+    odil::Reader const reader(stream, odil::registry::JPEGBaseline8Bit);
+    auto const data_set = reader.read_data_set();
+    BOOST_REQUIRE_EQUAL(data_set->size(), 1);
+    auto const & fragments = data_set->as_binary(odil::registry::PixelData);
+    BOOST_REQUIRE(
+        fragments == odil::Value::Binary({
+            {0, 0, 0, 0, 12, 0, 0, 0, 24, 0, 0, 0},
+            {0x01, 0x02, 0x03, 0x04}, {0x05, 0x06, 0x07, 0x00},
+            {0x08, 0x09}}));
+}
+
+BOOST_AUTO_TEST_CASE(StreamedPixelDataExtendedOffsetTable)
+{
+    std::vector<odil::Value::Binary::value_type> const frames{
+        {0x01, 0x02, 0x03, 0x04}, {0x05, 0x06}};
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::JPEGBaseline8Bit);
+    writer.write_encapsulated_pixel_data(
+        frame_producer(frames), 2, odil::Writer::OffsetTable::Extended);
+
+    odil::Reader const reader(stream, odil::registry::JPEGBaseline8Bit);
+    auto const data_set = reader.read_data_set();
+    BOOST_REQUIRE_EQUAL(data_set->size(), 3);
+    BOOST_REQUIRE(
+        data_set->as_binary(odil::registry::ExtendedOffsetTable)
+        == odil::Value::Binary({
+            {0, 0, 0, 0, 0, 0, 0, 0, 12, 0, 0, 0, 0, 0, 0, 0}}));
+    BOOST_REQUIRE(
+        data_set->as_binary(odil::registry::ExtendedOffsetTableLengths)
+        == odil::Value::Binary({
+            {4, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0}}));
+    BOOST_REQUIRE(
+        data_set->as_binary(odil::registry::PixelData)
+        == odil::Value::Binary({{}, frames[0], frames[1]}));
+}
+
+BOOST_AUTO_TEST_CASE(StreamedPixelDataNoOffsetTable)
+{
+    std::vector<odil::Value::Binary::value_type> const frames{
+        {0x01, 0x02}, {0x03, 0x04}};
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::JPEGBaseline8Bit);
+    writer.write_encapsulated_pixel_data(
+        frame_producer(frames), 0, odil::Writer::OffsetTable::None);
+
+    odil::Reader const reader(stream, odil::registry::JPEGBaseline8Bit);
+    auto const data_set = reader.read_data_set();
+    BOOST_REQUIRE(
+        data_set->as_binary(odil::registry::PixelData)
+        == odil::Value::Binary({{}, frames[0], frames[1]}));
+}
+
+BOOST_AUTO_TEST_CASE(StreamedPixelDataFramesCount)
+{
+    std::vector<odil::Value::Binary::value_type> const frames{
+        {0x01, 0x02}, {0x03, 0x04}};
+
+    std::stringstream stream;
+    odil::Writer const writer(stream, odil::registry::JPEGBaseline8Bit);
+    BOOST_REQUIRE_THROW(
+        writer.write_encapsulated_pixel_data(frame_producer(frames), 3),
+        odil::Exception);
+    BOOST_REQUIRE_THROW(
+        writer.write_encapsulated_pixel_data(frame_producer(frames), 1),
+        odil::Exception);
+}
@@ -1,6 +1,10 @@
 #define BOOST_TEST_MODULE StateMachine
 #include <boost/test/unit_test.hpp>
 
+#include <string>
+
+#include <boost/asio.hpp>
+
 #include "odil/Exception.h"
 #include "odil/dul/EventData.h"
 #include "odil/dul/StateMachine.h"
@@ -20,3 +24,25 @@ BOOST_AUTO_TEST_CASE(WrongTransition)
         state_machine.transition(odil::dul::StateMachine::Event::None, data),
         odil::Exception);
 }
+
+BOOST_AUTO_TEST_CASE(EmptyPDU)
+{
+    odil::dul::StateMachine state_machine;
+    auto & service = state_machine.get_transport().get_service();
+    boost::asio::ip::tcp::acceptor acceptor(
+        service, {boost::asio::ip::tcp::v4(), 0});
+    boost::asio::ip::tcp::socket peer(service);
+    acceptor.async_accept(peer, [](boost::system::error_code const &) {});
+    state_machine.get_transport().connect(
+        {
+            boost::asio::ip::address_v4::loopback(),
+            acceptor.local_endpoint().port()});
+
+    // A-RELEASE-RQ with no body: the PDU is invalid, its buffer is not
+    // accessed past its header.
+    std::string const pdu{0x05, 0x00, 0x00, 0x00, 0x00, 0x00};
+    boost::asio::write(peer, boost::asio::buffer(pdu));
+
+    odil::dul::EventData data;
+    BOOST_REQUIRE_THROW(state_machine.receive_pdu(data), odil::Exception);
+}
@@ -1,7 +1,14 @@
 #define BOOST_TEST_MODULE Transport
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
 #include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <boost/asio.hpp>
 
 #include "odil/Exception.h"
@@ -42,3 +49,132 @@ BOOST_AUTO_TEST_CASE(NotConnected)
     BOOST_REQUIRE_THROW(transport.write("..."), odil::Exception);
     BOOST_REQUIRE_THROW(transport.read(1), odil::Exception);
 }
+
+BOOST_AUTO_TEST_CASE(AsynchronousWriteFromThreads)
+{
+    boost::asio::io_service service;
+    boost::asio::ip::tcp::acceptor acceptor(
+        service, {boost::asio::ip::tcp::v4(), 0});
+
+    odil::dul::Transport transport(service);
+    bool connected = false;
+    transport.async_connect(
+        {
+            boost::asio::ip::address_v4::loopback(),
+            acceptor.local_endpoint().port()},
+        [&](boost::system::error_code const & error) {
+            connected = !error; });
+
+    boost::asio::ip::tcp::socket peer(service);
+    acceptor.accept(peer);
+    service.run();
+    service.reset();
+    BOOST_REQUIRE(connected);
+
+    BOOST_REQUIRE_THROW(transport.write("..."), odil::Exception);
+
+    // Keep the io_service running while the writers are not in a handler.
+    auto work = std::make_shared<boost::asio::io_service::work>(service);
+    std::vector<std::thread> runners;
+    for(int i=0; i<2; ++i)
+    {
+        runners.emplace_back([&]() { service.run(); });
+    }
+
+    std::vector<std::string> const data{
+        std::string(64, 'a'), std::string(64, 'b'),
+        std::string(64, 'c'), std::string(64, 'd')};
+    std::atomic<int> errors(0);
+    std::vector<std::thread> writers;
+    for(int i=0; i<4; ++i)
+    {
+        writers.emplace_back(
+            [&, i]()
+            {
+                for(int j=0; j<100; ++j)
+                {
+                    transport.async_write(
+                        { boost::asio::buffer(data[i]) },
+                        [&](boost::system::error_code const & error) {
+                            if(error) { ++errors; } });
+                }
+            });
+    }
+    for(auto & writer: writers)
+    {
+        writer.join();
+    }
+
+    std::string received(4*100*64, '\0');
+    boost::asio::read(peer, boost::asio::buffer(&received[0], received.size()));
+
+    work.reset();
+    transport.close();
+    for(auto & runner: runners)
+    {
+        runner.join();
+    }
+
+    BOOST_REQUIRE_EQUAL(errors, 0);
+
+    // Each write is received in one piece.
+    std::map<char, int> counts;
+    for(std::size_t i=0; i<received.size(); i+=64)
+    {
+        BOOST_REQUIRE(received.substr(i, 64) == std::string(64, received[i]));
+        ++counts[received[i]];
+    }
+    BOOST_REQUIRE_EQUAL(counts.size(), 4);
+    for(auto const & item: counts)
+    {
+        BOOST_REQUIRE_EQUAL(item.second, 100);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(AsynchronousWriteTimeoutDuringRead)
+{
+    boost::asio::io_service service;
+    boost::asio::ip::tcp::acceptor acceptor(
+        service, {boost::asio::ip::tcp::v4(), 0});
+
+    odil::dul::Transport transport(service);
+    transport.async_connect(
+        {
+            boost::asio::ip::address_v4::loopback(),
+            acceptor.local_endpoint().port()},
+        [](boost::system::error_code const &) {});
+
+    // The peer neither reads nor writes.
+    boost::asio::ip::tcp::socket peer(service);
+    acceptor.accept(peer);
+    service.run();
+    service.reset();
+
+    // The write, which fills the buffers of both sockets, times out before
+    // the read.
+    std::string const data(64*1024*1024, 'a');
+    boost::system::error_code write_error;
+    transport.set_timeout(boost::posix_time::milliseconds(200));
+    transport.async_write(
+        { boost::asio::buffer(data) },
+        [&](boost::system::error_code const & error) { write_error = error; });
+    // Start the write, and its timer, from the strand.
+    service.poll();
+    service.reset();
+
+    char buffer[16];
+    boost::system::error_code read_error;
+    transport.set_timeout(boost::posix_time::seconds(10));
+    transport.async_read(
+        buffer, sizeof(buffer),
+        [&](boost::system::error_code const & error) { read_error = error; });
+
+    auto const begin = std::chrono::steady_clock::now();
+    service.run();
+    auto const duration = std::chrono::steady_clock::now()-begin;
+
+    BOOST_REQUIRE(write_error == boost::asio::error::timed_out);
+    BOOST_REQUIRE(read_error == boost::asio::error::timed_out);
+    BOOST_REQUIRE(duration < std::chrono::seconds(5));
+    BOOST_REQUIRE(!transport.is_open());
+}
@@ -1,8 +1,12 @@
 #define BOOST_TEST_MODULE endian
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
+
 #include "odil/endian.h"
+#include "odil/Exception.h"
 
 BOOST_AUTO_TEST_CASE(ToLittleEndian16)
 {
@@ -87,3 +91,64 @@ BOOST_AUTO_TEST_CASE(FromBigEndian32)
         expected
     );
 }
+
+template<typename T>
+void test_swap_bytes()
+{
+    // Use enough words to go through both the vectorized and the scalar code.
+    std::vector<T> words(37);
+    std::vector<T> expected(words.size());
+    for(std::size_t i=0; i<words.size(); ++i)
+    {
+        words[i] = T(0x0102030405060708ull * (i+1));
+        expected[i] = words[i];
+        auto bytes = reinterpret_cast<uint8_t *>(&expected[i]);
+        std::reverse(bytes, bytes+sizeof(T));
+    }
+
+    odil::swap_bytes(&words[0], words.size()*sizeof(T), sizeof(T));
+    BOOST_REQUIRE(words == expected);
+}
+
+BOOST_AUTO_TEST_CASE(SwapBytes16)
+{
+    test_swap_bytes<uint16_t>();
+}
+
+BOOST_AUTO_TEST_CASE(SwapBytes32)
+{
+    test_swap_bytes<uint32_t>();
+}
+
+BOOST_AUTO_TEST_CASE(SwapBytes64)
+{
+    test_swap_bytes<uint64_t>();
+}
+
+BOOST_AUTO_TEST_CASE(SwapBytesInvalidSize)
+{
+    std::vector<uint8_t> data(5);
+    BOOST_REQUIRE_THROW(
+        odil::swap_bytes(&data[0], data.size(), 2), odil::Exception);
+    BOOST_REQUIRE_THROW(
+        odil::swap_bytes(&data[0], data.size(), 5), odil::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(ConvertByteOrdering)
+{
+    std::vector<uint16_t> data(20, 0x1234);
+    odil::convert_byte_ordering(
+        &data[0], 2*data.size(), 2, odil::ByteOrdering::BigEndian);
+    for(auto const & item: data)
+    {
+        BOOST_REQUIRE_EQUAL(item, odil::host_to_big_endian<uint16_t>(0x1234));
+    }
+
+    // Host byte ordering: no-op
+    odil::convert_byte_ordering(
+        &data[0], 2*data.size(), 2, odil::byte_ordering);
+    for(auto const & item: data)
+    {
+        BOOST_REQUIRE_EQUAL(item, odil::host_to_big_endian<uint16_t>(0x1234));
+    }
+}
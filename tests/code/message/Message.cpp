@@ -61,3 +61,18 @@ BOOST_AUTO_TEST_CASE(DeleteDataSet)
 
     BOOST_CHECK(!message.has_data_set());
 }
+
+BOOST_AUTO_TEST_CASE(DataSetStreamed)
+{
+    auto command_set = std::make_shared<odil::DataSet>();
+    auto data_set = std::make_shared<odil::DataSet>();
+
+    odil::message::Message message(command_set, data_set);
+    BOOST_CHECK(!message.is_data_set_streamed());
+
+    message.set_data_set_streamed(true);
+    BOOST_CHECK(message.is_data_set_streamed());
+
+    message.set_data_set(std::make_shared<odil::DataSet>());
+    BOOST_CHECK(!message.is_data_set_streamed());
+}
@@ -0,0 +1,155 @@
+#define BOOST_TEST_MODULE numeric_string
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "odil/numeric_string.h"
+#include "odil/Value.h"
+#include "odil/write_ds.h"
+
+odil::Value::Integer parse_is(std::string const & string)
+{
+    odil::Value::Integer value = 0;
+    BOOST_REQUIRE(
+        odil::read_is(string.data(), string.data()+string.size(), value));
+    return value;
+}
+
+odil::Value::Real parse_ds(std::string const & string)
+{
+    odil::Value::Real value = 0;
+    BOOST_REQUIRE(
+        odil::read_ds(string.data(), string.data()+string.size(), value));
+    return value;
+}
+
+BOOST_AUTO_TEST_CASE(ReadIS)
+{
+    BOOST_REQUIRE_EQUAL(parse_is("0"), 0);
+    BOOST_REQUIRE_EQUAL(parse_is("1234"), 1234);
+    BOOST_REQUIRE_EQUAL(parse_is(" +12 "), 12);
+    BOOST_REQUIRE_EQUAL(parse_is("-12"), -12);
+    BOOST_REQUIRE_EQUAL(
+        parse_is("9223372036854775807"), 9223372036854775807LL);
+    BOOST_REQUIRE_EQUAL(
+        parse_is("-9223372036854775808"), -9223372036854775807LL-1);
+}
+
+BOOST_AUTO_TEST_CASE(ReadISInvalid)
+{
+    for(std::string const string: {"", " ", "-", "abc"})
+    {
+        odil::Value::Integer value = 0;
+        BOOST_REQUIRE(
+            !odil::read_is(string.data(), string.data()+string.size(), value));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ReadISAsStoll)
+{
+    for(std::string const string: {"\t12", "12abc", "0x1A", " -7 "})
+    {
+        BOOST_REQUIRE_EQUAL(parse_is(string), std::stoll(string));
+    }
+
+    std::string const string("9223372036854775808");
+    odil::Value::Integer value = 0;
+    BOOST_REQUIRE_THROW(
+        odil::read_is(string.data(), string.data()+string.size(), value),
+        std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(ReadDS)
+{
+    BOOST_REQUIRE_EQUAL(parse_ds("0"), 0.);
+    BOOST_REQUIRE_EQUAL(parse_ds("12.5"), 12.5);
+    BOOST_REQUIRE_EQUAL(parse_ds(" -4.56 "), -4.56);
+    BOOST_REQUIRE_EQUAL(parse_ds("+.5"), 0.5);
+    BOOST_REQUIRE_EQUAL(parse_ds("1."), 1.);
+    BOOST_REQUIRE_EQUAL(parse_ds("1e3"), 1000.);
+    BOOST_REQUIRE_EQUAL(parse_ds("-2.5E-2"), -0.025);
+    BOOST_REQUIRE_EQUAL(parse_ds("24.5282145946261"), 24.5282145946261);
+    // Not handled by the fast path
+    BOOST_REQUIRE_EQUAL(parse_ds("1e-300"), 1e-300);
+    BOOST_REQUIRE_EQUAL(
+        parse_ds("0.12345678901234567890123"), 0.12345678901234567890123);
+    // Incomplete exponent
+    BOOST_REQUIRE_EQUAL(parse_ds("3e"), 3.);
+}
+
+BOOST_AUTO_TEST_CASE(ReadDSAsStold)
+{
+    BOOST_REQUIRE(std::isnan(parse_ds("nan")));
+    BOOST_REQUIRE(std::isinf(parse_ds("inf")));
+    BOOST_REQUIRE_LT(parse_ds("-Infinity"), 0);
+    BOOST_REQUIRE_EQUAL(parse_ds("0x1p3"), 8.);
+    BOOST_REQUIRE_EQUAL(parse_ds("\t1.5"), 1.5);
+    BOOST_REQUIRE_EQUAL(parse_ds("2.5mm"), 2.5);
+}
+
+BOOST_AUTO_TEST_CASE(ReadDSInvalid)
+{
+    for(std::string const string: {"", " ", "-", ".", "abc", "e5"})
+    {
+        odil::Value::Real value = 0;
+        BOOST_REQUIRE(
+            !odil::read_ds(string.data(), string.data()+string.size(), value));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ReadItems)
+{
+    std::string const is("1\\-2\\ 3 \\x\\");
+    odil::Value::Integers integers;
+    odil::read_is(is.data(), is.data()+is.size(), integers);
+    BOOST_REQUIRE(integers == odil::Value::Integers({1, -2, 3, 0, 0}));
+
+    std::string const ds("1.5\\-.25\\1e2 ");
+    odil::Value::Reals reals;
+    odil::read_ds(ds.data(), ds.data()+ds.size(), reals);
+    BOOST_REQUIRE(reals == odil::Value::Reals({1.5, -0.25, 100.}));
+}
+
+BOOST_AUTO_TEST_CASE(WriteIS)
+{
+    for(odil::Value::Integer const value: {
+        odil::Value::Integer(0), odil::Value::Integer(7),
+        odil::Value::Integer(-42), odil::Value::Integer(123456789012LL),
+        odil::Value::Integer(-9223372036854775807LL-1)})
+    {
+        char buffer[20];
+        auto const size = odil::write_is(value, buffer);
+        BOOST_REQUIRE_EQUAL(
+            std::string(buffer, size), std::to_string(value));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(WriteDS)
+{
+    std::pair<double, std::string> const values[] = {
+        {0., "0"}, {12.5, "12.5"}, {-4.56, "-4.56"}, {0.5, ".5"},
+        {-0.025, "-.025"}, {1200., "1200"}, {536.7, "536.7"},
+        {24.5282145946261, "24.5282145946261"}, {1e-4, "1e-4"},
+        {1e20, "1e20"}, {1./3., ".333333333333333"},
+        {-2./3., "-.66666666666666"}
+    };
+    for(auto const & item: values)
+    {
+        char buffer[18];
+        odil::write_ds(item.first, buffer, 17);
+        BOOST_REQUIRE_EQUAL(std::string(buffer), item.second);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(WriteDSRoundTrip)
+{
+    for(double const value: {
+        1./3., -2./3., 930.21481, 71217.319953097394, 1e-3, 999.999})
+    {
+        char buffer[18];
+        odil::write_ds(value, buffer, 17);
+        BOOST_REQUIRE_CLOSE(parse_ds(buffer), value, 1e-12);
+    }
+}
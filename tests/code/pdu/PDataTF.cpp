@@ -72,3 +72,36 @@ BOOST_AUTO_TEST_CASE(WrongPresentationContextID)
             2, pdv_items[0].get_control_header(), pdv_items[0].get_fragment()),
         odil::Exception);
 }
+
+BOOST_AUTO_TEST_CASE(ReadPDVItems)
+{
+    std::vector<odil::pdu::PDataTF::PresentationDataValueView> views;
+    odil::pdu::PDataTF::read_pdv_items(
+        &data[6], &data[0]+data.size(), views);
+
+    BOOST_REQUIRE_EQUAL(views.size(), pdv_items.size());
+    for(std::size_t i=0; i<views.size(); ++i)
+    {
+        auto const & view = views[i];
+        auto const & item = pdv_items[i];
+        BOOST_REQUIRE_EQUAL(
+            view.presentation_context_id, item.get_presentation_context_id());
+        BOOST_REQUIRE_EQUAL(view.control_header, item.get_control_header());
+        BOOST_REQUIRE_EQUAL(view.is_command(), item.is_command());
+        BOOST_REQUIRE_EQUAL(view.is_last_fragment(), item.is_last_fragment());
+        BOOST_REQUIRE_EQUAL(
+            std::string(view.fragment, view.fragment_size),
+            item.get_fragment());
+    }
+    // Fragments reference the buffer
+    BOOST_REQUIRE(views[0].fragment == &data[12]);
+}
+
+BOOST_AUTO_TEST_CASE(ReadPDVItemsTruncated)
+{
+    std::vector<odil::pdu::PDataTF::PresentationDataValueView> views;
+    BOOST_REQUIRE_THROW(
+        odil::pdu::PDataTF::read_pdv_items(
+            &data[6], &data[0]+data.size()-1, views),
+        odil::Exception);
+}
@@ -4,6 +4,7 @@
 #include <sstream>
 
 #include "odil/Exception.h"
+#include "odil/pdu/AsynchronousOperationsWindow.h"
 #include "odil/pdu/ImplementationClassUID.h"
 #include "odil/pdu/ImplementationVersionName.h"
 #include "odil/pdu/MaximumLength.h"
@@ -48,6 +49,25 @@ BOOST_AUTO_TEST_CASE(ConstructorStreamImplementationClassUID)
         item.get_sub_items<odil::pdu::ImplementationClassUID>().size(), 1);
 }
 
+BOOST_AUTO_TEST_CASE(ConstructorStreamAsynchronousOperationsWindow)
+{
+    std::string const data(
+        "\x50\x00\x00\x08"
+        "\x53\x00\x00\x04"
+        "\x00\x08\x00\x04",
+        12
+    );
+    std::istringstream stream(data);
+
+    odil::pdu::UserInformation const item(stream);
+    auto const sub_items =
+        item.get_sub_items<odil::pdu::AsynchronousOperationsWindow>();
+    BOOST_REQUIRE_EQUAL(sub_items.size(), 1);
+    BOOST_REQUIRE_EQUAL(sub_items[0].get_maximum_number_operations_invoked(), 8);
+    BOOST_REQUIRE_EQUAL(
+        sub_items[0].get_maximum_number_operations_performed(), 4);
+}
+
 BOOST_AUTO_TEST_CASE(ConstructorStreamRoleSelection)
 {
     std::string const data(
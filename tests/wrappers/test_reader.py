@@ -112,6 +112,26 @@ class TestReader(unittest.TestCase):
         self.assertEqual(len(data_set), 1)
         self.assertSequenceEqual(data_set.as_string("PatientName"), [b"Foo^Bar"])
     
+    def test_read_file_path_memory_mapped(self):
+        data = (
+            128*b"\x00"+b"DICM"+
+            b"\x02\x00\x10\x00" b"UI" b"\x14\x00" b"1.2.840.10008.1.2.1\x00"
+            b"\x10\x00\x10\x00" b"PN" b"\x08\x00" b"Foo^Bar "
+        )
+        
+        fd, path = tempfile.mkstemp()
+        os.write(fd, data)
+        os.close(fd)
+        
+        try:
+            header, data_set = odil.Reader.read_file(path, memory_mapped=True)
+            self.assertEqual(len(data_set), 1)
+            self.assertSequenceEqual(
+                data_set.as_string("PatientName"), [b"Foo^Bar"])
+            del header, data_set
+        finally:
+            os.remove(path)
+    
     def test_open_context(self):
         data = (
             128*b"\x00"+b"DICM"+
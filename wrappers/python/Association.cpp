@@ -73,7 +73,11 @@ void wrap_Association(pybind11::module & m)
         //.def("reject", &Association::reject)
         .def("release", &Association::release)
         .def("abort", &Association::abort)
-        .def("receive_message", &Association::receive_message)
+        .def(
+            "receive_message",
+            static_cast<
+                    std::shared_ptr<message::Message>(Association::*)()
+                >(&Association::receive_message))
         .def("next_message_id", &Association::next_message_id)
         .def("send_message", &Association::send_message)
     ;
@@ -84,12 +84,21 @@ void wrap_DataSet(pybind11::module & m)
                 return self;
             }),
             "transfer_syntax"_a="")
-        .def("add", (void (DataSet::*)(Tag const &, Element const &)) &DataSet::add)
+        .def(
+            "add", (void (DataSet::*)(Tag const &, Element const &)) &DataSet::add,
+            "Add an element, replacing an existing one with the same tag. The "
+            "elements, keys, values and items previously returned by the data "
+            "set are invalidated and must not be used afterwards.")
         .def(
             "add", (void (DataSet::*)(Tag const &, VR)) &DataSet::add,
-            "tag"_a, "vr"_a=VR::UNKNOWN)
-        .def("add", add_python_object, "self"_a, "tag"_a, "vr"_a=VR::UNKNOWN)
-        .def("remove", &DataSet::remove)
+            "tag"_a, "vr"_a=VR::UNKNOWN, "Add an empty element, cf. above.")
+        .def(
+            "add", add_python_object, "self"_a, "tag"_a, "vr"_a=VR::UNKNOWN,
+            "Add an element from a sequence, cf. above.")
+        .def(
+            "remove", &DataSet::remove,
+            "Remove an element. As with add, the elements, keys, values and "
+            "items previously returned by the data set are invalidated.")
         .def("has", &DataSet::has)
         .def("empty", (bool (DataSet::*)() const) &DataSet::empty)
         .def("size", (std::size_t (DataSet::*)() const) &DataSet::size)
@@ -115,7 +124,12 @@ void wrap_DataSet(pybind11::module & m)
         .def("is_binary", &DataSet::is_binary)
         .def(
             "as_binary", (Value::Binary & (DataSet::*)(Tag const &)) &DataSet::as_binary,
-            return_value_policy::reference_internal)
+            return_value_policy::reference_internal,
+            "Return the binary items, which may be modified in place.\n\n"
+            "The binary items are shared between copies and duplicated when "
+            "this function is called on a copy: the returned object must not "
+            "be modified after the data set has been copied, since the "
+            "modification would also affect the copy.")
         .def(self == self)
         .def(self != self)
         .def("clear", (void (DataSet::*)()) &DataSet::clear)
@@ -126,18 +140,21 @@ void wrap_DataSet(pybind11::module & m)
         .def(
             "__getitem__",
             (Element & (DataSet::*)(Tag const &)) &DataSet::operator[],
-            return_value_policy::reference_internal)
+            return_value_policy::reference_internal,
+            "Return the element, valid until an element is added or removed.")
         .def(
             "__setitem__",
             [](DataSet & self, Tag const & t, Element const & e) { self[t] = e; })
-        .def("__delitem__", &DataSet::remove)
+        .def("__delitem__", &DataSet::remove, "Remove an element, cf. remove.")
         .def(
             "__iter__",
             [](DataSet const & self)
             {
                 return make_key_iterator(self.begin(), self.end());
             },
-            keep_alive<0, 1>())
+            keep_alive<0, 1>(),
+            "Iterate over the tags. The data set must not be modified by add "
+            "or remove during the iteration.")
         .def(
             "__contains__", 
             [](DataSet const & self, Tag const & t) { return self.has(t); })
@@ -160,7 +177,8 @@ void wrap_DataSet(pybind11::module & m)
             {
                 return make_key_iterator(self.begin(), self.end());
             },
-            keep_alive<0, 1>())
+            keep_alive<0, 1>(),
+            "Return an iterator over the tags, cf. __iter__.")
         .def(
             "values",
             [](DataSet const & self)
@@ -175,17 +193,25 @@ void wrap_DataSet(pybind11::module & m)
                 // }
                 // return tags;
             },
-            keep_alive<0, 1>())
+            keep_alive<0, 1>(),
+            "Return an iterator over the elements, which are invalidated, as "
+            "is the iterator, when an element is added or removed.")
         .def(
             "items",
             [](DataSet const & self) 
             { 
                 return make_iterator(self.begin(), self.end()); 
             },
-            keep_alive<0, 1>())
+            keep_alive<0, 1>(),
+            "Return an iterator over the (tag, element) pairs, cf. values.")
         .def(
             "update",
             [](DataSet & self, DataSet const & other) {
+                // Adding to the data set would invalidate the iteration.
+                if(&self == &other)
+                {
+                    return;
+                }
                 for(auto && item: other) 
                 {
                     if(self.has(item.first)) 
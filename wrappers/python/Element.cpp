@@ -61,7 +61,12 @@ void wrap_Element(pybind11::module & m)
         .def("is_binary", &Element::is_binary)
         .def(
             "as_binary", (Value::Binary & (Element::*)()) &Element::as_binary,
-            return_value_policy::reference_internal)
+            return_value_policy::reference_internal,
+            "Return the binary items, which may be modified in place.\n\n"
+            "The binary items are shared between copies and duplicated when "
+            "this function is called on a copy: the returned object must not "
+            "be modified after the element has been copied, since the "
+            "modification would also affect the copy.")
         .def(self == self)
         .def(self != self)
         .def("__len__", &Element::size)
@@ -9,8 +9,6 @@
 #ifndef _99998287_59bb_4f7c_aadc_fe5ecb87f8c2
 #define _99998287_59bb_4f7c_aadc_fe5ecb87f8c2
 
-#include <fstream>
-
 #include <pybind11/pybind11.h>
 #include <pybind11/functional.h>
 
@@ -31,15 +29,20 @@ void wrap_Reader(pybind11::module & m)
 
     class_<Reader>(m, "Reader")
         .def(
-            init<odil::wrappers::python::iostream &, std::string const &, bool>(),
-            "stream"_a, "transfer_syntax"_a, "keep_group_length"_a=false)
+            init<
+                odil::wrappers::python::iostream &, std::string const &,
+                bool, bool>(),
+            "stream"_a, "transfer_syntax"_a, "keep_group_length"_a=false,
+            "lazy_decoding"_a=false)
         .def_readwrite("transfer_syntax", &Reader::transfer_syntax)
         .def_readwrite("byte_ordering", &Reader::byte_ordering)
         .def_readwrite("explicit_vr", &Reader::explicit_vr)
         .def_readwrite("keep_group_length", &Reader::keep_group_length)
+        .def_readwrite("lazy_decoding", &Reader::lazy_decoding)
         .def(
             "read_data_set", &Reader::read_data_set,
-            "halt_condition"_a=default_halt_condition)
+            "halt_condition"_a=default_halt_condition,
+            "filter"_a=std::function<bool(Tag const &)>())
         .def("read_tag", &Reader::read_tag)
         .def("read_length", &Reader::read_length)
         .def(
@@ -50,30 +53,40 @@ void wrap_Reader(pybind11::module & m)
             [](
                 odil::wrappers::python::iostream & stream,
                 bool keep_group_length,
-                std::function<bool(Tag const &)> halt_condition)
+                std::function<bool(Tag const &)> halt_condition,
+                bool lazy_decoding,
+                std::function<bool(Tag const &)> filter)
             {
                 return Reader::read_file(
-                    stream, keep_group_length, halt_condition);
+                    stream, keep_group_length, halt_condition, lazy_decoding,
+                    filter);
             },
             "stream"_a, "keep_group_length"_a=false,
-            "halt_condition"_a=default_halt_condition)
+            "halt_condition"_a=default_halt_condition, "lazy_decoding"_a=false,
+            "filter"_a=std::function<bool(Tag const &)>())
         .def_static(
             "read_file",
             [](
                 std::string const & file_name,
                 bool keep_group_length,
-                std::function<bool(Tag const &)> halt_condition)
+                std::function<bool(Tag const &)> halt_condition,
+                bool lazy_decoding,
+                std::function<bool(Tag const &)> filter,
+                bool memory_mapped)
             {
-                std::ifstream stream(file_name);
-                if(!stream)
-                {
-                    throw Exception("Could not open stream");
-                }
                 return Reader::read_file(
-                    stream, keep_group_length, halt_condition);
+                    file_name, keep_group_length, halt_condition,
+                    lazy_decoding, filter, nullptr, memory_mapped);
             },
             "file_name"_a, "keep_group_length"_a=false,
-            "halt_condition"_a=default_halt_condition)
+            "halt_condition"_a=default_halt_condition, "lazy_decoding"_a=false,
+            "filter"_a=std::function<bool(Tag const &)>(),
+            "memory_mapped"_a=false,
+            "Return the meta-data header and data set stored in the file.\n\n"
+            "If memory_mapped is True, the binary and long text values are "
+            "views into a memory mapping of the file, which stays open as "
+            "long as one of them is alive: the file must not be modified in "
+            "the meantime, including writing the data set back to it.")
     ;
 }
 
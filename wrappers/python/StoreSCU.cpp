@@ -39,7 +39,7 @@ void wrap_StoreSCU(pybind11::module & m)
                 &StoreSCU::set_affected_sop_class)
         )
         .def(
-            "store", &odil::StoreSCU::store,
+            "store", static_cast<StoreFunction>(&odil::StoreSCU::store),
             "dataset"_a, "move_originator_ae_title"_a="",
             "move_originator_message_id"_a=-1)
     ;
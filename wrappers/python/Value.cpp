@@ -133,7 +133,12 @@ void wrap_Value(pybind11::module & m)
             return_value_policy::reference_internal)
         .def(
             "as_binary", (Value::Binary & (Value::*)()) &Value::as_binary,
-            return_value_policy::reference_internal)
+            return_value_policy::reference_internal,
+            "Return the binary items, which may be modified in place.\n\n"
+            "The binary items are shared between copies and duplicated when "
+            "this function is called on a copy: the returned object must not "
+            "be modified after the value has been copied, since the "
+            "modification would also affect the copy.")
         .def(self == self)
         .def(self != self)
         .def("clear", &Value::clear)